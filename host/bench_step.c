@@ -0,0 +1,357 @@
+// Includes
+#include <stdio.h>          // printf, fopen
+#include <stdlib.h>         // strtol, qsort
+#include <string.h>         // strcmp, strtok
+#include "host_util.h"
+#include "snowflake_kernels.h"
+#include "snowflake_model_i.h"
+#include "snowflake_presets.h"
+
+// ===================================================================
+// Host step-throughput benchmark
+//
+// Times the three phases of the step (classify, diffuse, update) for
+// every registered kernel, preset and lattice size, and prints one record
+// per combination as CSV or JSON. Each repetition starts from the seed,
+// runs untimed warmup steps and then the timed steps; the median
+// repetition is reported.
+//
+// A CSV written with --out can be passed back with --baseline to flag
+// regressions; the exit code is 2 if any combination got slower than
+// the threshold.
+// ===================================================================
+
+#define MAX_SIZES 16
+#define MAX_REPS 64
+#define AUTO_CELL_UPDATES 4000000L // Timed cell updates per repetition when --steps is not given
+
+typedef enum {
+    PHASE_CLASSIFY,
+    PHASE_DIFFUSE,
+    PHASE_UPDATE,
+    PHASE_COUNT
+} BenchPhase;
+
+// ===================================================================
+// Benchmark configuration and results
+// ===================================================================
+typedef struct {
+    int sizes[MAX_SIZES];
+    int size_count;
+    const char* kernels;  // Comma separated names, NULL for all
+    const char* presets;  // Comma separated names, NULL for all
+    int warmup;           // Untimed steps per repetition, -1 = same as steps
+    int steps;            // Timed steps per repetition, 0 = auto
+    int reps;
+    bool json;
+    const char* out_path;
+    const char* baseline_path;
+    double threshold;     // Allowed slowdown against the baseline, percent
+} BenchConfig;
+
+typedef struct {
+    const char* kernel;
+    const char* preset;
+    int size;
+    int warmup;
+    int steps;
+    int reps;
+    double phase_ns[PHASE_COUNT]; // Per step, median repetition
+    double step_ns;               // Per step, median repetition
+    double min_step_ns;           // Per step, fastest repetition
+    int frozen;                   // Frozen cells after the last repetition
+} BenchResult;
+
+static int compare_double(const void* a, const void* b) {
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+// ===================================================================
+// Function: Run one kernel / preset / size combination
+// ===================================================================
+static bool bench_run(
+    const BenchConfig* config,
+    const SnowflakeKernel* kernel,
+    const SnowflakePreset* preset,
+    int size,
+    BenchResult* result) {
+    SnowflakeModel* model = snowflake_model_alloc(size, &preset->params);
+    if(!model) return false;
+    
+    long cells = (long)size * size;
+    int steps = config->steps > 0 ? config->steps : (int)(AUTO_CELL_UPDATES / cells);
+    if(steps < 1) steps = 1;
+    int warmup = config->warmup >= 0 ? config->warmup : steps;
+    
+    double totals[MAX_REPS];
+    double phases[PHASE_COUNT][MAX_REPS];
+    
+    for(int rep = 0; rep < config->reps; rep++) {
+        snowflake_model_reset(model);
+        for(int i = 0; i < warmup; i++) {
+            kernel->classify(model);
+            kernel->diffuse(model);
+            kernel->update(model);
+        }
+        
+        int64_t phase_sum[PHASE_COUNT] = {0};
+        for(int i = 0; i < steps; i++) {
+            int64_t t0 = now_ns();
+            kernel->classify(model);
+            int64_t t1 = now_ns();
+            kernel->diffuse(model);
+            int64_t t2 = now_ns();
+            kernel->update(model);
+            int64_t t3 = now_ns();
+            phase_sum[PHASE_CLASSIFY] += t1 - t0;
+            phase_sum[PHASE_DIFFUSE] += t2 - t1;
+            phase_sum[PHASE_UPDATE] += t3 - t2;
+        }
+        
+        totals[rep] = 0;
+        for(int p = 0; p < PHASE_COUNT; p++) {
+            phases[p][rep] = (double)phase_sum[p] / steps;
+            totals[rep] += phases[p][rep];
+        }
+    }
+    
+    result->kernel = kernel->name;
+    result->preset = preset->name;
+    result->size = size;
+    result->warmup = warmup;
+    result->steps = steps;
+    result->reps = config->reps;
+    result->frozen = snowflake_model_get_stats(model)->frozen_total;
+    
+    // Each phase and the total are medians on their own
+    for(int p = 0; p < PHASE_COUNT; p++) {
+        qsort(phases[p], config->reps, sizeof(double), compare_double);
+        result->phase_ns[p] = phases[p][config->reps / 2];
+    }
+    qsort(totals, config->reps, sizeof(double), compare_double);
+    result->step_ns = totals[config->reps / 2];
+    result->min_step_ns = totals[0];
+    
+    snowflake_model_free(model);
+    return true;
+}
+
+// ===================================================================
+// Output
+// ===================================================================
+static const char* csv_header =
+    "kernel,preset,size,warmup,steps,reps,classify_ns,diffuse_ns,update_ns,"
+    "step_ns,min_step_ns,steps_per_sec,ns_per_cell,frozen\n";
+
+static void write_csv(FILE* out, const BenchResult* r) {
+    double cells = (double)r->size * r->size;
+    fprintf(out, "%s,%s,%d,%d,%d,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.3f,%.4f,%d\n",
+            r->kernel, r->preset, r->size, r->warmup, r->steps, r->reps,
+            r->phase_ns[PHASE_CLASSIFY], r->phase_ns[PHASE_DIFFUSE], r->phase_ns[PHASE_UPDATE],
+            r->step_ns, r->min_step_ns, 1e9 / r->step_ns, r->step_ns / cells, r->frozen);
+}
+
+static void write_json(FILE* out, const BenchResult* r, bool first) {
+    double cells = (double)r->size * r->size;
+    fprintf(out,
+            "%s  {\"kernel\": \"%s\", \"preset\": \"%s\", \"size\": %d, \"warmup\": %d, "
+            "\"steps\": %d, \"reps\": %d, \"classify_ns\": %.1f, \"diffuse_ns\": %.1f, "
+            "\"update_ns\": %.1f, \"step_ns\": %.1f, \"min_step_ns\": %.1f, "
+            "\"steps_per_sec\": %.3f, \"ns_per_cell\": %.4f, \"frozen\": %d}",
+            first ? "" : ",\n", r->kernel, r->preset, r->size, r->warmup, r->steps, r->reps,
+            r->phase_ns[PHASE_CLASSIFY], r->phase_ns[PHASE_DIFFUSE], r->phase_ns[PHASE_UPDATE],
+            r->step_ns, r->min_step_ns, 1e9 / r->step_ns, r->step_ns / cells, r->frozen);
+}
+
+// ===================================================================
+// Function: Compare a result against a baseline CSV
+// Returns true if it is a regression beyond the threshold.
+// ===================================================================
+static bool baseline_check(FILE* baseline, const BenchResult* r, double threshold) {
+    char line[512];
+    rewind(baseline);
+    while(fgets(line, sizeof(line), baseline)) {
+        char kernel[64], preset[64];
+        int size;
+        double ns_per_cell;
+        // kernel,preset,size,...,ns_per_cell is the 13th column
+        if(sscanf(line, "%63[^,],%63[^,],%d,%*d,%*d,%*d,%*f,%*f,%*f,%*f,%*f,%*f,%lf",
+                  kernel, preset, &size, &ns_per_cell) != 4) {
+            continue;
+        }
+        if(strcmp(kernel, r->kernel) != 0 || strcmp(preset, r->preset) != 0 || size != r->size) {
+            continue;
+        }
+        
+        double now = r->step_ns / ((double)r->size * r->size);
+        double change = (now / ns_per_cell - 1.0) * 100.0;
+        bool regression = change > threshold;
+        fprintf(stderr, "%-10s %-10s %5d  %8.4f -> %8.4f ns/cell  %+6.1f%%%s\n",
+                r->kernel, r->preset, r->size, ns_per_cell, now, change,
+                regression ? "  REGRESSION" : "");
+        return regression;
+    }
+    
+    fprintf(stderr, "%-10s %-10s %5d  not in baseline\n", r->kernel, r->preset, r->size);
+    return false;
+}
+
+// ===================================================================
+// Function: Parse a comma separated list of sizes
+// ===================================================================
+static int parse_sizes(const char* list, int sizes[MAX_SIZES]) {
+    int count = 0;
+    const char* p = list;
+    while(*p && count < MAX_SIZES) {
+        char* end;
+        long value = strtol(p, &end, 10);
+        if(end == p || value < 5) return 0;
+        sizes[count++] = (int)value;
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return count;
+}
+
+// ===================================================================
+// Function: Check whether a name is in a comma separated list
+// ===================================================================
+static bool name_selected(const char* list, const char* name) {
+    if(!list) return true;
+    size_t len = strlen(name);
+    for(const char* p = list; *p;) {
+        const char* end = strchr(p, ',');
+        size_t item = end ? (size_t)(end - p) : strlen(p);
+        if(item == len && strncmp(p, name, len) == 0) return true;
+        if(!end) break;
+        p = end + 1;
+    }
+    return false;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --sizes 16,64,...   lattice sizes (default 16..4096, powers of two)\n"
+            "  --kernels a,b       kernels to run (default all)\n"
+            "  --presets a,b       presets to run (default all)\n"
+            "  --warmup N          untimed steps per repetition (default: same as --steps)\n"
+            "  --steps N           timed steps per repetition (default: ~4M cell updates)\n"
+            "  --reps N            repetitions, the median is reported (default 3)\n"
+            "  --json              JSON instead of CSV\n"
+            "  --out FILE          write results to FILE instead of stdout\n"
+            "  --baseline FILE     compare against a CSV written earlier\n"
+            "  --threshold PCT     allowed slowdown against the baseline (default 5)\n",
+            name);
+}
+
+int main(int argc, char** argv) {
+    BenchConfig config = {
+        .sizes = {16, 32, 64, 128, 256, 512, 1024, 2048, 4096},
+        .size_count = 9,
+        .kernels = NULL,
+        .presets = NULL,
+        .warmup = -1,
+        .steps = 0,
+        .reps = 3,
+        .json = false,
+        .out_path = NULL,
+        .baseline_path = NULL,
+        .threshold = 5.0,
+    };
+    
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if(strcmp(arg, "--json") == 0) {
+            config.json = true;
+            continue;
+        }
+        if(!value) {
+            usage(argv[0]);
+            return 1;
+        }
+        if(strcmp(arg, "--sizes") == 0) {
+            config.size_count = parse_sizes(value, config.sizes);
+        } else if(strcmp(arg, "--kernels") == 0) {
+            config.kernels = value;
+        } else if(strcmp(arg, "--presets") == 0) {
+            config.presets = value;
+        } else if(strcmp(arg, "--warmup") == 0) {
+            config.warmup = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "--steps") == 0) {
+            config.steps = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "--reps") == 0) {
+            config.reps = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "--out") == 0) {
+            config.out_path = value;
+        } else if(strcmp(arg, "--baseline") == 0) {
+            config.baseline_path = value;
+        } else if(strcmp(arg, "--threshold") == 0) {
+            config.threshold = strtod(value, NULL);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    
+    if(config.size_count == 0 || config.reps < 1 || config.reps > MAX_REPS) {
+        usage(argv[0]);
+        return 1;
+    }
+    
+    FILE* out = config.out_path ? fopen(config.out_path, "w") : stdout;
+    if(!out) {
+        perror(config.out_path);
+        return 1;
+    }
+    FILE* baseline = NULL;
+    if(config.baseline_path) {
+        baseline = fopen(config.baseline_path, "r");
+        if(!baseline) {
+            perror(config.baseline_path);
+            return 1;
+        }
+    }
+    
+    fputs(config.json ? "[\n" : csv_header, out);
+    
+    bool first = true;
+    bool regression = false;
+    for(int k = 0; k < snowflake_kernel_count; k++) {
+        const SnowflakeKernel* kernel = &snowflake_kernels[k];
+        if(!name_selected(config.kernels, kernel->name)) continue;
+        
+        for(size_t p = 0; p < snowflake_preset_count; p++) {
+            const SnowflakePreset* preset = &snowflake_presets[p];
+            if(!name_selected(config.presets, preset->name)) continue;
+            
+            for(int s = 0; s < config.size_count; s++) {
+                BenchResult result;
+                if(!bench_run(&config, kernel, preset, config.sizes[s], &result)) {
+                    fprintf(stderr, "Out of memory for a %dx%d lattice, skipped\n",
+                            config.sizes[s], config.sizes[s]);
+                    continue;
+                }
+                
+                if(config.json) {
+                    write_json(out, &result, first);
+                } else {
+                    write_csv(out, &result);
+                }
+                fflush(out);
+                first = false;
+                
+                if(baseline) regression |= baseline_check(baseline, &result, config.threshold);
+            }
+        }
+    }
+    
+    if(config.json) fputs("\n]\n", out);
+    
+    if(out != stdout) fclose(out);
+    if(baseline) fclose(baseline);
+    return regression ? 2 : 0;
+}
@@ -0,0 +1,233 @@
+// Includes
+#include <math.h>           // fabsf
+#include <stdio.h>          // printf
+#include <stdlib.h>         // strtol
+#include <string.h>         // memcmp, strcmp
+#include "snowflake_config.h"
+#include "snowflake_kernels.h"
+#include "snowflake_model.h"
+#include "snowflake_presets.h"
+#include "snowflake_reference.h"
+
+// ===================================================================
+// Golden-state differential test for step kernels
+//
+// Runs the frozen reference implementation and each candidate kernel in
+// lockstep from the same seed, over all presets plus random parameter
+// sets, and compares after every step:
+//   - the frozen mask (FNV-1a checksum per step, must match exactly)
+//   - the s field (max |ds|, must stay within --tolerance)
+// The first divergent step of every failing case is reported. Exit code
+// is 1 if any case diverges.
+// ===================================================================
+
+#define MAX_SIZES 8
+
+typedef struct {
+    int sizes[MAX_SIZES];
+    int size_count;
+    int steps;          // Steps per case; random cases draw 1..steps
+    int random_cases;
+    uint32_t seed;
+    float tolerance;    // Allowed max |ds|
+    bool verbose;       // Print the per-step checksums
+} DiffConfig;
+
+// ===================================================================
+// Function: xorshift32 PRNG, deterministic across platforms
+// ===================================================================
+static uint32_t rng_next(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static float rng_range(uint32_t* state, float min, float max) {
+    return min + (max - min) * (float)(rng_next(state) & 0xFFFFFF) / (float)0xFFFFFF;
+}
+
+// ===================================================================
+// Function: FNV-1a checksum of a frozen mask
+// ===================================================================
+static uint32_t frozen_checksum(const uint8_t* frozen, int cells) {
+    uint32_t hash = 2166136261u;
+    for(int i = 0; i < cells; i++) {
+        hash ^= frozen[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// ===================================================================
+// Function: Run one case in lockstep. Returns true if it matches.
+// ===================================================================
+static bool diff_case(
+    const DiffConfig* config,
+    const SnowflakeKernel* candidate,
+    const char* label,
+    const SnowflakeParams* params,
+    int size,
+    int steps) {
+    SnowflakeReference* ref = snowflake_reference_alloc(size, params);
+    SnowflakeModel* model = snowflake_model_alloc(size, params);
+    if(!ref || !model) {
+        fprintf(stderr, "Out of memory for a %dx%d lattice\n", size, size);
+        snowflake_reference_free(ref);
+        snowflake_model_free(model);
+        return false;
+    }
+    snowflake_model_set_kernel(model, candidate);
+    
+    int cells = size * size;
+    int first_divergent = -1;
+    const char* reason = "";
+    float max_ds = 0.0f;
+    uint32_t ref_sum = 0, cand_sum = 0;
+    
+    for(int step = 1; step <= steps; step++) {
+        int ref_frozen = snowflake_reference_step(ref);
+        int cand_frozen = snowflake_model_step(model);
+        
+        const float* s = snowflake_model_get_s(model);
+        const uint8_t* frozen = snowflake_model_get_frozen(model);
+        
+        float step_ds = 0.0f;
+        for(int i = 0; i < cells; i++) {
+            float ds = fabsf(s[i] - ref->s[i]);
+            if(ds > step_ds || ds != ds) step_ds = ds;
+        }
+        if(step_ds > max_ds || step_ds != step_ds) max_ds = step_ds;
+        
+        ref_sum = frozen_checksum(ref->frozen, cells);
+        cand_sum = frozen_checksum(frozen, cells);
+        
+        if(config->verbose) {
+            printf("  %s %s step %4d  frozen %08x %08x  max|ds| %g\n",
+                   candidate->name, label, step, (unsigned)ref_sum, (unsigned)cand_sum, (double)step_ds);
+        }
+        
+        if(first_divergent < 0) {
+            if(memcmp(frozen, ref->frozen, cells) != 0) {
+                first_divergent = step;
+                reason = "frozen mask";
+            } else if(ref_frozen != cand_frozen) {
+                first_divergent = step;
+                reason = "freeze count";
+            } else if(!(step_ds <= config->tolerance)) {
+                first_divergent = step;
+                reason = "s field";
+            }
+        }
+    }
+    
+    bool pass = first_divergent < 0;
+    printf("%s %-9s %-12s a=%.3f b=%.3f g=%.4f size=%-4d steps=%-4d frozen=%08x max|ds|=%g",
+           pass ? "PASS" : "FAIL", candidate->name, label,
+           (double)params->alpha, (double)params->beta, (double)params->gamma,
+           size, steps, (unsigned)cand_sum, (double)max_ds);
+    if(!pass) printf("  first divergence at step %d (%s)", first_divergent, reason);
+    printf("\n");
+    
+    snowflake_reference_free(ref);
+    snowflake_model_free(model);
+    return pass;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --sizes 16,33,...   lattice sizes (default 16,33,64)\n"
+            "  --steps N           steps per case (default 300)\n"
+            "  --random N          random parameter cases per size (default 20)\n"
+            "  --seed N            PRNG seed (default 1)\n"
+            "  --tolerance X       allowed max |ds| (default 0, bit-exact)\n"
+            "  --verbose           print per-step checksums\n",
+            name);
+}
+
+int main(int argc, char** argv) {
+    DiffConfig config = {
+        .sizes = {16, 33, 64},
+        .size_count = 3,
+        .steps = 300,
+        .random_cases = 20,
+        .seed = 1,
+        .tolerance = 0.0f,
+        .verbose = false,
+    };
+    
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if(strcmp(arg, "--verbose") == 0) {
+            config.verbose = true;
+            continue;
+        }
+        if(!value) {
+            usage(argv[0]);
+            return 2;
+        }
+        if(strcmp(arg, "--sizes") == 0) {
+            config.size_count = 0;
+            for(const char* p = value; *p && config.size_count < MAX_SIZES;) {
+                char* end;
+                config.sizes[config.size_count++] = (int)strtol(p, &end, 10);
+                if(end == p) break;
+                p = (*end == ',') ? end + 1 : end;
+            }
+        } else if(strcmp(arg, "--steps") == 0) {
+            config.steps = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "--random") == 0) {
+            config.random_cases = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "--seed") == 0) {
+            config.seed = (uint32_t)strtoul(value, NULL, 10);
+        } else if(strcmp(arg, "--tolerance") == 0) {
+            config.tolerance = strtof(value, NULL);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    
+    if(config.steps < 1 || config.seed == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    
+    int failures = 0;
+    int cases = 0;
+    for(int c = 0; c < snowflake_kernel_count; c++) {
+        const SnowflakeKernel* candidate = &snowflake_kernels[c];
+        uint32_t rng = config.seed;
+        
+        for(int s = 0; s < config.size_count; s++) {
+            int size = config.sizes[s];
+            
+            for(size_t p = 0; p < snowflake_preset_count; p++) {
+                const SnowflakePreset* preset = &snowflake_presets[p];
+                cases++;
+                if(!diff_case(&config, candidate, preset->name, &preset->params, size, config.steps)) {
+                    failures++;
+                }
+            }
+            
+            for(int r = 0; r < config.random_cases; r++) {
+                SnowflakeParams params = {
+                    .alpha = rng_range(&rng, ALPHA_MIN, ALPHA_MAX),
+                    .beta = rng_range(&rng, BETA_MIN, BETA_MAX),
+                    .gamma = rng_range(&rng, GAMMA_MIN, GAMMA_MAX),
+                };
+                int steps = 1 + (int)(rng_next(&rng) % (uint32_t)config.steps);
+                cases++;
+                if(!diff_case(&config, candidate, "random", &params, size, steps)) failures++;
+            }
+        }
+    }
+    
+    printf("%d/%d cases match the reference\n", cases - failures, cases);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,224 @@
+// Includes
+#include <stdio.h>          // printf, fopen
+#include <stdlib.h>         // strtol
+#include <string.h>         // strcmp
+#include "host_util.h"
+#include "snowflake_growth.h"
+#include "snowflake_model.h"
+
+// ===================================================================
+// Host player for growth recordings (snowflake_cli -G, or growth.sfg
+// from the app's data folder)
+//
+// Replays a recording into a model without simulating and reports its
+// size and the playback speed. --verify grows the same parameters with
+// the step kernel alongside and checks the frozen masks after every
+// step, so a recording can be trusted as a stand-in for the real run.
+// --damaged replays built-in recordings with out-of-range deltas, which
+// must be rejected without touching memory outside the lattice.
+// ===================================================================
+
+#define DAMAGED_SIZE 16
+#define DAMAGED_CELLS (DAMAGED_SIZE * DAMAGED_SIZE)
+
+// Deltas of one step each, ending at the first 0
+static const uint32_t damaged_steps[][3] = {
+    {0xFFFFFFF0u, 0, 0},            // Wraps to a negative index
+    {DAMAGED_CELLS + 1, 0, 0},      // One past the last cell
+    {100, 0xFFFFFF00u, 0},          // Back before the first cell
+    {1, 0x7FFFFFFFu, 0},            // Overflows int32_t
+    {DAMAGED_CELLS - 1, 2, 0},      // Past the end from within
+};
+
+// ===================================================================
+// Function: SnowflakeReader over a buffer in memory
+// ===================================================================
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+} MemoryReader;
+
+static size_t memory_read(void* context, void* data, size_t size) {
+    MemoryReader* memory = context;
+    if(size > memory->size - memory->position) size = memory->size - memory->position;
+    memcpy(data, memory->data + memory->position, size);
+    memory->position += size;
+    return size;
+}
+
+// ===================================================================
+// Function: Every damaged recording must fail to play, a valid one of
+// the same layout must play. Returns the number of failures.
+// ===================================================================
+static int check_damaged(void) {
+    SnowflakeParams params = {.alpha = 1.0f, .beta = 0.5f, .gamma = 0.01f};
+    int case_count = (int)(sizeof(damaged_steps) / sizeof(damaged_steps[0]));
+    int failures = 0;
+    
+    for(int c = -1; c < case_count; c++) {
+        // Case -1 is the valid control: the first and the last cell
+        static const uint32_t valid[3] = {1, DAMAGED_CELLS - 2, 0};
+        const uint32_t* deltas = c < 0 ? valid : damaged_steps[c];
+        uint8_t data[SNOWFLAKE_GROWTH_HEADER_SIZE + 3 * SNOWFLAKE_VARINT_MAX];
+        uint32_t bits[3];
+        memcpy(&bits[0], &params.alpha, sizeof(uint32_t));
+        memcpy(&bits[1], &params.beta, sizeof(uint32_t));
+        memcpy(&bits[2], &params.gamma, sizeof(uint32_t));
+        memcpy(data, "SFGR", 4);
+        snowflake_put_u16(data + 4, SNOWFLAKE_GROWTH_VERSION);
+        snowflake_put_u16(data + 6, DAMAGED_SIZE);
+        for(int i = 0; i < 3; i++) snowflake_put_u32(data + 8 + 4 * i, bits[i]);
+        size_t size = SNOWFLAKE_GROWTH_HEADER_SIZE;
+        for(int i = 0; i < 3; i++) size += snowflake_put_varint(data + size, deltas[i]);
+        
+        MemoryReader memory = {.data = data, .size = size};
+        SnowflakeReader reader = {.read = memory_read, .context = &memory};
+        static SnowflakeGrowthPlayer player;
+        SnowflakeGrowthHeader header;
+        SnowflakeModel* model = snowflake_model_alloc(DAMAGED_SIZE, &params);
+        if(!model || !snowflake_growth_player_begin(&player, &reader, &header)) {
+            printf("damaged: case %d could not be set up\n", c);
+            snowflake_model_free(model);
+            return failures + 1;
+        }
+        int count = snowflake_growth_play_step(&player, model);
+        if(c < 0 ? count != 2 : count != -1) {
+            printf("damaged: case %d played %d cells\n", c, count);
+            failures++;
+        }
+        snowflake_model_free(model);
+    }
+    printf("damaged: %d of %d cases rejected as expected\n", case_count - failures, case_count);
+    return failures;
+}
+
+// ===================================================================
+// Function: Print the frozen mask, odd columns shifted half a row
+// ===================================================================
+static void print_frozen(const SnowflakeModel* model) {
+    int size = snowflake_model_get_size(model);
+    for(int row = 0; row < 2 * size; row++) {
+        for(int x = 0; x < size; x++) {
+            int y = row / 2;
+            bool shifted_row = (row % 2) != (x % 2);
+            putchar(shifted_row ? ' ' : (snowflake_model_is_frozen(model, x, y) ? '#' : '.'));
+        }
+        putchar('\n');
+    }
+}
+
+// ===================================================================
+// Function: Compare the frozen masks of two models
+// ===================================================================
+static bool frozen_equal(const SnowflakeModel* a, const SnowflakeModel* b) {
+    int size = snowflake_model_get_size(a);
+    for(int y = 0; y < size; y++) {
+        for(int x = 0; x < size; x++) {
+            if(snowflake_model_is_frozen(a, x, y) != snowflake_model_is_frozen(b, x, y)) return false;
+        }
+    }
+    return true;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [--verify] [-p] growth.sfg\n"
+            "       %s --damaged\n"
+            "  --verify   simulate alongside and compare the frozen masks after every step\n"
+            "  -p         print the final frozen mask\n"
+            "  --damaged  check that recordings with out-of-range cells are rejected\n",
+            name, name);
+}
+
+int main(int argc, char** argv) {
+    bool verify = false;
+    bool print = false;
+    const char* path = NULL;
+    
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--damaged") == 0) {
+            return check_damaged() ? 1 : 0;
+        } else if(strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else if(strcmp(argv[i], "-p") == 0) {
+            print = true;
+        } else if(!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if(!path) {
+        usage(argv[0]);
+        return 2;
+    }
+    
+    FILE* file = fopen(path, "rb");
+    if(!file) {
+        fprintf(stderr, "Cannot read %s\n", path);
+        return 1;
+    }
+    
+    SnowflakeReader reader = {.read = file_read, .context = file};
+    static SnowflakeGrowthPlayer player;
+    SnowflakeGrowthHeader header;
+    if(!snowflake_growth_player_begin(&player, &reader, &header) || header.size < 5) {
+        fprintf(stderr, "Invalid growth recording %s\n", path);
+        fclose(file);
+        return 1;
+    }
+    
+    SnowflakeModel* model = snowflake_model_alloc(header.size, &header.params);
+    SnowflakeModel* simulated = verify ? snowflake_model_alloc(header.size, &header.params) : NULL;
+    if(!model || (verify && !simulated)) {
+        fprintf(stderr, "Out of memory for a %dx%d lattice\n", header.size, header.size);
+        snowflake_model_free(model);
+        snowflake_model_free(simulated);
+        fclose(file);
+        return 1;
+    }
+    
+    int steps = 0;
+    int cells = 0;
+    int mismatch = -1;
+    int64_t elapsed = 0;
+    while(true) {
+        int64_t start = now_ns();
+        int count = snowflake_growth_play_step(&player, model);
+        elapsed += now_ns() - start;
+        if(count < 0) break;
+        steps++;
+        cells += count;
+        
+        if(simulated && mismatch < 0) {
+            snowflake_model_step(simulated);
+            if(!frozen_equal(model, simulated)) mismatch = steps;
+        }
+    }
+    long length = ftell(file);
+    fclose(file);
+    
+    if(print) print_frozen(model);
+    
+    const SnowflakeParams* params = &header.params;
+    printf("size=%d steps=%d alpha=%.3f beta=%.3f gamma=%.4f\n",
+           header.size, steps, (double)params->alpha, (double)params->beta, (double)params->gamma);
+    printf("bytes=%ld cells=%d frozen=%d (%.2f bytes/cell)\n",
+           length, cells, snowflake_model_get_stats(model)->frozen_total, cells ? (double)length / cells : 0.0);
+    if(steps > 0) {
+        printf("playback=%.3f ms (%.2f us/step)\n", (double)elapsed * 1e-6, (double)elapsed * 1e-3 / steps);
+    }
+    if(verify) {
+        if(mismatch < 0) {
+            printf("verify: all %d steps match the simulation\n", steps);
+        } else {
+            printf("verify: frozen mask differs from the simulation at step %d\n", mismatch);
+        }
+    }
+    
+    snowflake_model_free(model);
+    snowflake_model_free(simulated);
+    return mismatch < 0 ? 0 : 1;
+}
@@ -0,0 +1,215 @@
+// Includes
+#include <stdio.h>          // printf
+#include <stdlib.h>         // strtol, malloc
+#include <string.h>         // strcmp, memcmp
+#include "host_util.h"
+#include "snowflake_history.h"
+#include "snowflake_kernels.h"
+#include "snowflake_model.h"
+#include "snowflake_presets.h"
+
+// ===================================================================
+// Host check of the undo history (snowflake_history.c)
+//
+// Grows a run while recording keyframes, with a snapshot of every step
+// on the side, then restores random earlier steps and compares the
+// frozen mask, the age map, the statistics and s of the liquid cells
+// with the snapshot. After each restore the run is grown to the end
+// again, which also checks that growth from a restored state matches
+// the original bit for bit. Reports keyframe sizes and restore times.
+// Exit code is 1 on any mismatch.
+// ===================================================================
+
+#define DEFAULT_BUDGET_KB 64
+#define DEFAULT_INTERVAL 20
+#define DEFAULT_RESTORES 50
+
+typedef struct {
+    int size;
+    int steps;
+    const char* preset;
+    const char* kernel;
+    int budget_kb;
+    int interval;
+    int restores;
+} HistoryConfig;
+
+typedef struct {
+    uint8_t* frozen;
+    uint16_t* freeze_steps;
+    float* s;
+    SnowflakeStats stats;
+} Snapshot;
+
+static bool snapshot_take(Snapshot* snapshot, const SnowflakeModel* model) {
+    size_t cells = (size_t)snowflake_model_get_size(model) * snowflake_model_get_size(model);
+    snapshot->frozen = malloc(cells);
+    snapshot->freeze_steps = malloc(cells * sizeof(uint16_t));
+    snapshot->s = malloc(cells * sizeof(float));
+    if(!snapshot->frozen || !snapshot->freeze_steps || !snapshot->s) return false;
+    
+    memcpy(snapshot->frozen, snowflake_model_get_frozen(model), cells);
+    memcpy(snapshot->freeze_steps, snowflake_model_get_freeze_steps(model), cells * sizeof(uint16_t));
+    memcpy(snapshot->s, snowflake_model_get_s(model), cells * sizeof(float));
+    snapshot->stats = *snowflake_model_get_stats(model);
+    return true;
+}
+
+static void snapshot_free(Snapshot* snapshot) {
+    free(snapshot->frozen);
+    free(snapshot->freeze_steps);
+    free(snapshot->s);
+}
+
+// ===================================================================
+// Function: Compare a model with a snapshot; s only for liquid cells
+// ===================================================================
+static bool snapshot_matches(const Snapshot* snapshot, const SnowflakeModel* model) {
+    size_t cells = (size_t)snowflake_model_get_size(model) * snowflake_model_get_size(model);
+    const uint8_t* frozen = snowflake_model_get_frozen(model);
+    const float* s = snowflake_model_get_s(model);
+    
+    if(memcmp(frozen, snapshot->frozen, cells) != 0) return false;
+    if(memcmp(snowflake_model_get_freeze_steps(model), snapshot->freeze_steps, cells * sizeof(uint16_t)) != 0) {
+        return false;
+    }
+    if(memcmp(snowflake_model_get_stats(model), &snapshot->stats, sizeof(SnowflakeStats)) != 0) return false;
+    for(size_t i = 0; i < cells; i++) {
+        if(!frozen[i] && memcmp(&s[i], &snapshot->s[i], sizeof(float)) != 0) return false;
+    }
+    return true;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -n size          lattice size (default 64)\n"
+            "  -s steps         length of the run (default 400)\n"
+            "  --preset NAME    parameters (default dendritic)\n"
+            "  --kernel NAME    step kernel (default: the registry default)\n"
+            "  --budget KB      keyframe budget (default %d)\n"
+            "  --interval K     steps between keyframes (default %d)\n"
+            "  --restores N     random restores (default %d)\n",
+            name, DEFAULT_BUDGET_KB, DEFAULT_INTERVAL, DEFAULT_RESTORES);
+}
+
+int main(int argc, char** argv) {
+    HistoryConfig config = {
+        .size = 64,
+        .steps = 400,
+        .preset = "dendritic",
+        .kernel = NULL,
+        .budget_kb = DEFAULT_BUDGET_KB,
+        .interval = DEFAULT_INTERVAL,
+        .restores = DEFAULT_RESTORES,
+    };
+    
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if(!value) {
+            usage(argv[0]);
+            return 2;
+        }
+        if(strcmp(arg, "-n") == 0) {
+            config.size = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "-s") == 0) {
+            config.steps = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "--preset") == 0) {
+            config.preset = value;
+        } else if(strcmp(arg, "--kernel") == 0) {
+            config.kernel = value;
+        } else if(strcmp(arg, "--budget") == 0) {
+            config.budget_kb = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "--interval") == 0) {
+            config.interval = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "--restores") == 0) {
+            config.restores = (int)strtol(value, NULL, 10);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    
+    const SnowflakePreset* preset = snowflake_preset_find(config.preset);
+    const SnowflakeKernel* kernel = config.kernel ? snowflake_kernel_find(config.kernel) : snowflake_kernel_default();
+    if(!preset || !kernel || config.size < 5 || config.steps < 1 || config.budget_kb < 1 || config.interval < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+    
+    SnowflakeModel* model = snowflake_model_alloc(config.size, &preset->params);
+    SnowflakeHistory* history = snowflake_history_alloc((size_t)config.budget_kb * 1024, config.interval);
+    Snapshot* snapshots = calloc((size_t)config.steps + 1, sizeof(Snapshot));
+    if(!model || !history || !snapshots) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    snowflake_model_set_kernel(model, kernel);
+    
+    // Reference run
+    snowflake_history_seed(history, &preset->params);
+    bool fits = true;
+    for(int step = 0; step <= config.steps; step++) {
+        if(step > 0) {
+            snowflake_model_step(model);
+            fits = snowflake_history_record(history, model, false) && fits;
+        }
+        if(!snapshot_take(&snapshots[step], model)) {
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+    }
+    if(!fits) fprintf(stderr, "A keyframe does not fit the budget\n");
+    
+    int keyframes = snowflake_history_count(history);
+    size_t bytes = snowflake_history_bytes(history);
+    int oldest = snowflake_history_oldest_step(history);
+    printf("size=%d steps=%d preset=%s kernel=%s budget=%d KB interval=%d\n",
+           config.size, config.steps, config.preset, kernel->name, config.budget_kb, config.interval);
+    printf("keyframes=%d bytes=%zu (%.0f per keyframe, raw s %zu) oldest step=%d\n", keyframes, bytes,
+           keyframes > 1 ? (double)bytes / (keyframes - (oldest == 0 ? 1 : 0)) : (double)bytes,
+           (size_t)config.size * config.size * sizeof(float), oldest);
+    
+    // Random restores, each followed by growing back to the end
+    srand(1);
+    int failures = 0;
+    int64_t restore_ns = 0, restore_max_ns = 0;
+    for(int r = 0; r < config.restores; r++) {
+        oldest = snowflake_history_oldest_step(history);
+        int target = oldest + rand() % (config.steps - oldest + 1);
+        
+        int64_t start = now_ns();
+        bool restored = snowflake_history_restore(history, model, target);
+        int64_t ns = now_ns() - start;
+        restore_ns += ns;
+        if(ns > restore_max_ns) restore_max_ns = ns;
+        
+        if(!restored || snowflake_model_get_step(model) != target || !snapshot_matches(&snapshots[target], model)) {
+            printf("restore of step %d %s\n", target, restored ? "differs" : "failed");
+            failures++;
+            break;
+        }
+        
+        while(snowflake_model_get_step(model) < config.steps) {
+            snowflake_model_step(model);
+            snowflake_history_record(history, model, false);
+        }
+        if(!snapshot_matches(&snapshots[config.steps], model)) {
+            printf("regrowing from step %d differs at the end\n", target);
+            failures++;
+            break;
+        }
+    }
+    if(config.restores > 0) {
+        printf("restores=%d avg=%.1f us max=%.1f us %s\n", config.restores,
+               (double)restore_ns / 1e3 / config.restores, (double)restore_max_ns / 1e3, failures ? "FAILED" : "match");
+    }
+    
+    for(int step = 0; step <= config.steps; step++) snapshot_free(&snapshots[step]);
+    free(snapshots);
+    snowflake_history_free(history);
+    snowflake_model_free(model);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,24 @@
+// Includes
+#include "host_util.h"
+#include <stdio.h>          // fread, fwrite
+#include <time.h>           // clock_gettime
+
+// ===================================================================
+// Function: Monotonic time in nanoseconds
+// ===================================================================
+int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// ===================================================================
+// Function: SnowflakeReader / SnowflakeWriter over a stdio FILE
+// ===================================================================
+size_t file_read(void* context, void* data, size_t size) {
+    return fread(data, 1, size, (FILE*)context);
+}
+
+size_t file_write(void* context, const void* data, size_t size) {
+    return fwrite(data, 1, size, (FILE*)context);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// ===================================================================
+// Helpers shared by the host tools: a monotonic clock for timings and
+// the SnowflakeReader / SnowflakeWriter callbacks over a stdio FILE.
+// ===================================================================
+#include <stddef.h>
+#include <stdint.h>
+
+/** Monotonic time in nanoseconds */
+int64_t now_ns(void);
+
+/** SnowflakeReader / SnowflakeWriter callbacks, the context is a FILE* */
+size_t file_read(void* context, void* data, size_t size);
+size_t file_write(void* context, const void* data, size_t size);
@@ -0,0 +1,164 @@
+// Includes
+#include <stdio.h>          // printf
+#include <stdlib.h>         // strtol, strtod
+#include <string.h>         // strcmp
+#include <math.h>           // log
+#include "host_util.h"
+#include "snowflake_model.h"
+#include "snowflake_latency.h"
+
+// ===================================================================
+// Host simulation of the press-to-pixel latency
+//
+// A simulated event source feeds OK presses into the same latency
+// tracker the app uses. Events are handled one after the other like the
+// app's main loop; each one runs a real model step, timed on the host.
+// The GUI thread is modelled as a single drawer with a fixed draw time:
+// a draw starts once the first change is committed and the previous
+// draw is done, and every change committed before it starts is shown
+// by it (view_port_update requests coalesce).
+//
+// The clock is simulated in nanoseconds, so the tick unit of the
+// printed figures matches the host build of snowflake_profile.h.
+// ===================================================================
+
+typedef struct {
+    int size;
+    int events;
+    double interval_ms;  // Time between events (mean with --poisson)
+    bool poisson;        // Exponential inter-arrival times instead of a fixed key repeat
+    double draw_us;      // Time the GUI thread needs for one draw
+    uint32_t seed;
+} SimConfig;
+
+// ===================================================================
+// Function: xorshift32 PRNG, uniform in (0, 1]
+// ===================================================================
+static double rng_uniform(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return ((double)(x >> 8) + 1.0) / 16777216.0;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -n size          lattice size (default 16)\n"
+            "  -e events        simulated OK events (default 200)\n"
+            "  --interval-ms X  time between events (default 150, the key repeat)\n"
+            "  --poisson        random arrivals with the interval as mean\n"
+            "  --draw-us X      draw callback time (default 2000)\n"
+            "  --seed N         PRNG seed for --poisson (default 1)\n",
+            name);
+}
+
+int main(int argc, char** argv) {
+    SimConfig config = {
+        .size = 16,
+        .events = 200,
+        .interval_ms = 150.0,
+        .poisson = false,
+        .draw_us = 2000.0,
+        .seed = 1,
+    };
+    
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if(strcmp(arg, "--poisson") == 0) {
+            config.poisson = true;
+            continue;
+        }
+        if(!value) {
+            usage(argv[0]);
+            return 1;
+        }
+        if(strcmp(arg, "-n") == 0) {
+            config.size = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "-e") == 0) {
+            config.events = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "--interval-ms") == 0) {
+            config.interval_ms = strtod(value, NULL);
+        } else if(strcmp(arg, "--draw-us") == 0) {
+            config.draw_us = strtod(value, NULL);
+        } else if(strcmp(arg, "--seed") == 0) {
+            config.seed = (uint32_t)strtoul(value, NULL, 10);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    
+    if(config.size < 5 || config.events < 1 || config.interval_ms < 0 || config.draw_us < 0 ||
+       config.seed == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    
+    SnowflakeParams params = {.alpha = 1.0f, .beta = 0.5f, .gamma = 0.01f};
+    SnowflakeModel* model = snowflake_model_alloc(config.size, &params);
+    if(!model) {
+        fprintf(stderr, "Out of memory for a %dx%d lattice\n", config.size, config.size);
+        return 1;
+    }
+    
+    SnowflakeLatency latency;
+    snowflake_latency_reset(&latency);
+    
+    uint64_t draw_ns = (uint64_t)(config.draw_us * 1e3);
+    uint64_t arrival = 0;     // Simulated clock, ns
+    uint64_t main_free = 0;   // Main loop idle from
+    uint64_t gui_free = 0;    // GUI thread idle from
+    uint64_t draw_start = 0;  // Start of the scheduled draw
+    bool draw_scheduled = false;
+    int draws = 0;
+    uint32_t rng = config.seed;
+    
+    for(int i = 0; i < config.events; i++) {
+        // Handle the event: dequeue when the main loop is free, then step
+        uint64_t dequeue = arrival > main_free ? arrival : main_free;
+        uint64_t start = now_ns();
+        snowflake_model_step(model);
+        uint64_t commit = dequeue + (now_ns() - start);
+        main_free = commit;
+        
+        // A change committed after the scheduled draw started waits for the next one
+        if(draw_scheduled && commit > draw_start) {
+            gui_free = draw_start + draw_ns;
+            snowflake_latency_draw_done(&latency, (uint32_t)gui_free);
+            draw_scheduled = false;
+            draws++;
+        }
+        snowflake_latency_commit(&latency, (uint32_t)arrival, (uint32_t)dequeue, (uint32_t)commit);
+        if(!draw_scheduled) {
+            draw_start = commit > gui_free ? commit : gui_free;
+            draw_scheduled = true;
+        }
+        
+        double interval = config.poisson ? -log(rng_uniform(&rng)) * config.interval_ms : config.interval_ms;
+        arrival += (uint64_t)(interval * 1e6);
+    }
+    if(draw_scheduled) {
+        snowflake_latency_draw_done(&latency, (uint32_t)(draw_start + draw_ns));
+        draws++;
+    }
+    
+    printf("size=%d events=%d draws=%d interval=%.1f ms%s draw=%.0f us dropped=%lu\n",
+           config.size, config.events, draws, config.interval_ms,
+           config.poisson ? " (poisson)" : "", config.draw_us, (unsigned long)latency.dropped);
+    printf("%-8s %10s %10s %10s %10s   (us, last %d events)\n", "stage", "p50", "p90", "p99", "max",
+           latency.count);
+    for(int stage = 0; stage < SNOWFLAKE_LATENCY_STAGE_COUNT; stage++) {
+        SnowflakeLatencyStats stats;
+        snowflake_latency_get_stats(&latency, stage, &stats);
+        printf("%-8s %10.1f %10.1f %10.1f %10.1f\n", snowflake_latency_stage_name(stage),
+               stats.p50 / 1e3, stats.p90 / 1e3, stats.p99 / 1e3, stats.max / 1e3);
+    }
+    
+    snowflake_model_free(model);
+    return 0;
+}
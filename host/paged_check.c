@@ -0,0 +1,180 @@
+// Includes
+#include <stdio.h>          // printf, tmpfile
+#include <stdlib.h>         // strtol
+#include <string.h>         // strcmp, memcmp
+#include "host_util.h"
+#include "snowflake_kernels.h"
+#include "snowflake_model.h"
+#include "snowflake_paged.h"
+#include "snowflake_presets.h"
+
+// ===================================================================
+// Host check of the out-of-core lattice (snowflake_paged.c)
+//
+// Grows the same run with the in-RAM model and with the tiles in a
+// temporary file, comparing the cells that froze and the statistics
+// after every step and the whole state (s bit for bit, the age map)
+// every --check steps and at the end. Halfway through, one step is
+// made to fail on a write; it must leave the state as it was and
+// succeed when repeated. Reports the time per step of both and the
+// file traffic. Exit code is 1 on any mismatch.
+// ===================================================================
+
+#define DEFAULT_CACHE_KB 24
+#define DEFAULT_CHECK 50
+
+typedef struct {
+    FILE* file;
+    int fail_after;  // Writes that succeed before one fails, -1 = never
+} BlockFile;
+
+// ===================================================================
+// Function: SnowflakeBlockFile over a stdio FILE
+// ===================================================================
+static bool block_read(void* context, uint64_t offset, void* data, size_t size) {
+    BlockFile* block = context;
+    return fseeko(block->file, (off_t)offset, SEEK_SET) == 0 && fread(data, 1, size, block->file) == size;
+}
+
+static bool block_write(void* context, uint64_t offset, const void* data, size_t size) {
+    BlockFile* block = context;
+    if(block->fail_after == 0) return false;
+    if(block->fail_after > 0) block->fail_after--;
+    return fseeko(block->file, (off_t)offset, SEEK_SET) == 0 && fwrite(data, 1, size, block->file) == size;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -n size          lattice size (default 100)\n"
+            "  -s steps         length of the run (default 400)\n"
+            "  --preset NAME    parameters (default dendritic)\n"
+            "  --cache KB       tile cache (default %d, at least %d lines of %d bytes)\n"
+            "  --check K        steps between full comparisons (default %d)\n",
+            name, DEFAULT_CACHE_KB, SNOWFLAKE_PAGED_MIN_LINES, (int)SNOWFLAKE_PAGED_LINE_BYTES, DEFAULT_CHECK);
+}
+
+// ===================================================================
+// Function: Compare the out-of-core state with the model's
+// ===================================================================
+static bool state_matches(SnowflakePaged* paged, SnowflakeModel* loaded, const SnowflakeModel* model) {
+    if(!snowflake_paged_load(paged, loaded)) return false;
+    size_t cells = (size_t)snowflake_model_get_size(model) * snowflake_model_get_size(model);
+    return snowflake_model_get_step(loaded) == snowflake_model_get_step(model) &&
+           memcmp(snowflake_model_get_s(loaded), snowflake_model_get_s(model), cells * sizeof(float)) == 0 &&
+           memcmp(snowflake_model_get_freeze_steps(loaded), snowflake_model_get_freeze_steps(model),
+                  cells * sizeof(uint16_t)) == 0 &&
+           memcmp(snowflake_model_get_frozen(loaded), snowflake_model_get_frozen(model), cells) == 0 &&
+           memcmp(snowflake_model_get_stats(loaded), snowflake_model_get_stats(model), sizeof(SnowflakeStats)) == 0;
+}
+
+int main(int argc, char** argv) {
+    int size = 100;
+    int steps = 400;
+    const char* preset_name = "dendritic";
+    int cache_kb = DEFAULT_CACHE_KB;
+    int check = DEFAULT_CHECK;
+    
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if(!value) {
+            usage(argv[0]);
+            return 2;
+        }
+        if(strcmp(arg, "-n") == 0) {
+            size = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "-s") == 0) {
+            steps = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "--preset") == 0) {
+            preset_name = value;
+        } else if(strcmp(arg, "--cache") == 0) {
+            cache_kb = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "--check") == 0) {
+            check = (int)strtol(value, NULL, 10);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    
+    const SnowflakePreset* preset = snowflake_preset_find(preset_name);
+    if(!preset || size < 5 || steps < 1 || cache_kb < 0 || check < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+    
+    BlockFile block = {.file = tmpfile(), .fail_after = -1};
+    SnowflakeBlockFile file = {.read = block_read, .write = block_write, .context = &block};
+    SnowflakeModel* model = snowflake_model_alloc(size, &preset->params);
+    SnowflakeModel* loaded = snowflake_model_alloc(size, &preset->params);
+    SnowflakePaged* paged =
+        block.file ? snowflake_paged_alloc(size, &preset->params, &file, (size_t)cache_kb * 1024) : NULL;
+    if(!model || !loaded || !paged) {
+        fprintf(stderr, "Out of memory or no temporary file\n");
+        return 1;
+    }
+    
+    int lines = snowflake_paged_get_cache_lines(paged);
+    fseeko(block.file, 0, SEEK_END);
+    printf("size=%d steps=%d preset=%s cache=%d lines (%zu bytes) file=%lld bytes\n", size, steps, preset_name,
+           lines, (size_t)lines * SNOWFLAKE_PAGED_LINE_BYTES, (long long)ftello(block.file));
+    
+    int failures = 0;
+    int64_t model_ns = 0, paged_ns = 0;
+    SnowflakePagedIo io = *snowflake_paged_get_io(paged);
+    uint64_t hits = 0, misses = 0, bytes_read = 0, bytes_written = 0;
+    for(int step = 1; step <= steps && !failures; step++) {
+        int64_t start = now_ns();
+        int model_frozen = snowflake_model_step(model);
+        model_ns += now_ns() - start;
+        
+        // A write failing halfway through the sweep must leave the state untouched
+        if(step == steps / 2) {
+            int tiles = (size + SNOWFLAKE_PAGED_TILE - 1) / SNOWFLAKE_PAGED_TILE;
+            block.fail_after = tiles * ((tiles + SNOWFLAKE_PAGED_LINE_TILES - 1) / SNOWFLAKE_PAGED_LINE_TILES) / 2;
+            if(snowflake_paged_step(paged) != -1 || snowflake_paged_get_step(paged) != step - 1) {
+                printf("step %d: the failed write was not reported\n", step);
+                failures++;
+                break;
+            }
+            block.fail_after = -1;
+            io = *snowflake_paged_get_io(paged);
+        }
+        
+        start = now_ns();
+        int paged_frozen = snowflake_paged_step(paged);
+        paged_ns += now_ns() - start;
+        const SnowflakePagedIo* after = snowflake_paged_get_io(paged);
+        hits += after->hits - io.hits;
+        misses += after->misses - io.misses;
+        bytes_read += after->bytes_read - io.bytes_read;
+        bytes_written += after->bytes_written - io.bytes_written;
+        
+        if(paged_frozen != model_frozen || memcmp(snowflake_paged_get_stats(paged), snowflake_model_get_stats(model),
+                                                  sizeof(SnowflakeStats)) != 0) {
+            printf("step %d: %d cells froze instead of %d or the statistics differ\n", step, paged_frozen,
+                   model_frozen);
+            failures++;
+        } else if((step % check == 0 || step == steps) && !state_matches(paged, loaded, model)) {
+            printf("step %d: the state differs\n", step);
+            failures++;
+        }
+        io = *snowflake_paged_get_io(paged);
+    }
+    
+    const SnowflakeStats* stats = snowflake_model_get_stats(model);
+    printf("frozen=%d radius=%d perimeter=%d\n", stats->frozen_total, stats->radius, stats->perimeter);
+    printf("model=%.1f us/step paged=%.1f us/step\n", (double)model_ns / 1e3 / steps, (double)paged_ns / 1e3 / steps);
+    printf("per step: read=%.0f bytes written=%.0f bytes, hits=%.1f%% (%llu misses)\n", (double)bytes_read / steps,
+           (double)bytes_written / steps, hits + misses ? 100.0 * (double)hits / (double)(hits + misses) : 0.0,
+           (unsigned long long)misses);
+    printf("%s\n", failures ? "FAILED" : "match");
+    
+    snowflake_paged_free(paged);
+    snowflake_model_free(model);
+    snowflake_model_free(loaded);
+    fclose(block.file);
+    return failures ? 1 : 0;
+}
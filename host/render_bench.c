@@ -0,0 +1,328 @@
+// Includes
+#include <stdio.h>          // printf, fopen
+#include <stdlib.h>         // strtol, malloc
+#include <string.h>         // strcmp
+#include "canvas_stub.h"
+#include "host_util.h"
+#include "snowflake_frame.h"
+#include "snowflake_frame_reference.h"
+#include "snowflake_presets.h"
+#include "snowflake_screen.h"
+
+// ===================================================================
+// Host benchmark of the app's render pipeline
+//
+// Draws the main screen (snowflake_screen_draw) into the stub Canvas
+// from host/stub for a set of scenarios with different crystal sizes
+// and reports frames per second and primitive calls per frame.
+//
+// Every scenario's first frame is also compared pixel by pixel against
+// a golden image in host/golden (binary PBM). Render optimizations must
+// keep them identical; after an intended change of the screen, rewrite
+// them with --update. Exit code is 1 if any frame differs.
+//
+// The grid bitmap itself is also checked against the original
+// dot-by-dot renderer (host/snowflake_frame_reference.c) after every
+// step of every preset, on the original 16x16 lattice at 5x3 zoom.
+// ===================================================================
+
+#define DEFAULT_FRAMES 5000
+#define DEFAULT_GOLDEN_DIR "host/golden"
+
+#define REFERENCE_SIZE 16    // Lattice of the original app
+#define REFERENCE_ZOOM 2     // 5x3 in the sprite atlas of snowflake_frame.c
+#define REFERENCE_STEPS 300
+
+typedef struct {
+    const char* name;
+    const char* preset;
+    int size;
+    int steps;
+    ParamType selected_param;
+    bool view_mode;
+    int rewind;          // Shown step, SNOWFLAKE_FRAME_LIVE for the grown crystal
+    uint16_t ring_steps; // Growth ring shading, 0 = off
+} RenderScenario;
+
+static const RenderScenario render_scenarios[] = {
+    {"seed", "sectored", 16, 0, PARAM_ALPHA, false, SNOWFLAKE_FRAME_LIVE, 0},
+    {"small", "sectored", 16, 20, PARAM_BETA, false, SNOWFLAKE_FRAME_LIVE, 0},
+    {"full", "sectored", 16, 200, PARAM_GAMMA, false, SNOWFLAKE_FRAME_LIVE, 0},
+    {"plate", "plate", 32, 60, PARAM_ALPHA, true, SNOWFLAKE_FRAME_LIVE, 0},
+    {"dendritic", "dendritic", 64, 400, PARAM_BETA, false, SNOWFLAKE_FRAME_LIVE, 0},
+    {"rings", "dendritic", 64, 400, PARAM_STEP, false, 250, 25},
+};
+
+#define RENDER_SCENARIO_COUNT (sizeof(render_scenarios) / sizeof(render_scenarios[0]))
+
+typedef struct {
+    int frames;
+    const char* golden_dir;
+    bool update;  // Write the golden images instead of comparing
+} RenderConfig;
+
+// ===================================================================
+// Function: Write / read a raster as binary PBM (P4)
+// ===================================================================
+static bool pbm_write(const char* path, const uint8_t* pixels) {
+    FILE* file = fopen(path, "wb");
+    if(!file) return false;
+    
+    fprintf(file, "P4\n%d %d\n", CANVAS_STUB_WIDTH, CANVAS_STUB_HEIGHT);
+    for(int y = 0; y < CANVAS_STUB_HEIGHT; y++) {
+        uint8_t row[CANVAS_STUB_WIDTH / 8] = {0};
+        for(int x = 0; x < CANVAS_STUB_WIDTH; x++) {
+            if(pixels[y * CANVAS_STUB_WIDTH + x]) row[x / 8] |= 0x80 >> (x % 8);
+        }
+        fwrite(row, 1, sizeof(row), file);
+    }
+    return fclose(file) == 0;
+}
+
+static bool pbm_read(const char* path, uint8_t* pixels) {
+    FILE* file = fopen(path, "rb");
+    if(!file) return false;
+    
+    int width = 0, height = 0;
+    bool ok = fscanf(file, "P4 %d %d", &width, &height) == 2 && fgetc(file) != EOF &&
+              width == CANVAS_STUB_WIDTH && height == CANVAS_STUB_HEIGHT;
+    for(int y = 0; ok && y < CANVAS_STUB_HEIGHT; y++) {
+        uint8_t row[CANVAS_STUB_WIDTH / 8];
+        ok = fread(row, 1, sizeof(row), file) == sizeof(row);
+        for(int x = 0; ok && x < CANVAS_STUB_WIDTH; x++) {
+            pixels[y * CANVAS_STUB_WIDTH + x] = (row[x / 8] >> (7 - x % 8)) & 1;
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+// ===================================================================
+// Function: Compare the first frame with its golden image
+// ===================================================================
+static bool golden_check(const RenderConfig* config, const RenderScenario* scenario, const uint8_t* pixels) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s.pbm", config->golden_dir, scenario->name);
+    
+    if(config->update) {
+        if(!pbm_write(path, pixels)) {
+            fprintf(stderr, "Failed to write %s\n", path);
+            return false;
+        }
+        return true;
+    }
+    
+    static uint8_t golden[CANVAS_STUB_WIDTH * CANVAS_STUB_HEIGHT];
+    if(!pbm_read(path, golden)) {
+        fprintf(stderr, "%s: missing or unreadable golden image %s (run with --update)\n", scenario->name, path);
+        return false;
+    }
+    
+    int differing = 0, first = -1;
+    for(int i = 0; i < CANVAS_STUB_WIDTH * CANVAS_STUB_HEIGHT; i++) {
+        if(pixels[i] != golden[i]) {
+            if(first < 0) first = i;
+            differing++;
+        }
+    }
+    if(differing) {
+        fprintf(stderr, "%s: %d pixels differ from %s, first at (%d, %d)\n", scenario->name, differing, path,
+                first % CANVAS_STUB_WIDTH, first / CANVAS_STUB_WIDTH);
+    }
+    return differing == 0;
+}
+
+// ===================================================================
+// Function: Grow one scenario, check its frame and time the draws
+// ===================================================================
+static bool render_scenario(const RenderConfig* config, const RenderScenario* scenario, bool* match) {
+    const SnowflakePreset* preset = snowflake_preset_find(scenario->preset);
+    SnowflakeModel* model = preset ? snowflake_model_alloc(scenario->size, &preset->params) : NULL;
+    SnowflakeFrame* frame = malloc(sizeof(SnowflakeFrame));
+    Canvas* canvas = canvas_stub_alloc();
+    if(!model || !frame || !canvas) {
+        snowflake_model_free(model);
+        free(frame);
+        canvas_stub_free(canvas);
+        return false;
+    }
+    
+    // Grow the way the app does, so the frame is built incrementally
+    snowflake_frame_init(frame, model);
+    snowflake_frame_reset(frame);
+    for(int i = 0; i < scenario->steps; i++) {
+        snowflake_model_step(model);
+        snowflake_frame_update_zoom(frame, false);
+    }
+    snowflake_frame_set_rings(frame, scenario->ring_steps);
+    snowflake_frame_rewind(frame, scenario->rewind);
+    
+    SnowflakeScreen screen = {
+        .params = &preset->params,
+        .selected_param = scenario->selected_param,
+        .view_mode = scenario->view_mode,
+        .frame = frame,
+    };
+    
+    snowflake_screen_draw(canvas, &screen);
+    *match = golden_check(config, scenario, canvas_stub_pixels(canvas));
+    
+    canvas_stub_reset_calls(canvas);
+    int64_t start = now_ns();
+    for(int i = 0; i < config->frames; i++) snowflake_screen_draw(canvas, &screen);
+    double seconds = (double)(now_ns() - start) * 1e-9;
+    
+    const uint32_t* calls = canvas_stub_calls(canvas);
+    uint32_t total = 0;
+    for(int c = 0; c < CANVAS_CALL_COUNT; c++) total += calls[c];
+    
+    printf("%-10s %4d %5d %6d %4d %10.0f %9.2f %6.1f ", scenario->name, scenario->size, scenario->steps,
+           snowflake_model_get_stats(model)->frozen_total, frame->view.zoom, config->frames / seconds,
+           seconds * 1e6 / config->frames, (double)total / config->frames);
+    for(int c = 0; c < CANVAS_CALL_COUNT; c++) {
+        if(calls[c]) printf(" %s=%.0f", canvas_stub_call_name(c), (double)calls[c] / config->frames);
+    }
+    printf("  %s\n", config->update ? "updated" : (*match ? "match" : "DIFFERS"));
+    
+    snowflake_model_free(model);
+    free(frame);
+    canvas_stub_free(canvas);
+    return true;
+}
+
+// ===================================================================
+// Function: Compare the frame bitmap with the original renderer
+// The view is panned so cell (0, 0) is centered on the screen pixel
+// the original app drew it at. Only the grid area is compared: the
+// original also spilled column 0 two pixels into the parameter panel.
+// ===================================================================
+static bool reference_check(const SnowflakePreset* preset, bool* match) {
+    SnowflakeModel* model = snowflake_model_alloc(REFERENCE_SIZE, &preset->params);
+    SnowflakeFrame* frame = malloc(sizeof(SnowflakeFrame));
+    Canvas* canvas = canvas_stub_alloc();
+    Canvas* reference = canvas_stub_alloc();
+    bool ok = model && frame && canvas && reference;
+    
+    *match = true;
+    if(ok) {
+        int center = REFERENCE_SIZE / 2;
+        snowflake_frame_init(frame, model);
+        snowflake_frame_reset(frame);
+        frame->view.zoom = REFERENCE_ZOOM;
+        frame->view.auto_zoom = false;
+        frame->view.x = SNOWFLAKE_FRAME_WIDTH / 2 - center * SNOWFLAKE_FRAME_REFERENCE_HEX_WIDTH -
+                        (SNOWFLAKE_FRAME_REFERENCE_OFFSET_X - SNOWFLAKE_SCREEN_GRID_X);
+        frame->view.y = SNOWFLAKE_FRAME_HEIGHT / 2 - center * SNOWFLAKE_FRAME_REFERENCE_HEX_HEIGHT -
+                        (SNOWFLAKE_FRAME_REFERENCE_OFFSET_Y - SNOWFLAKE_SCREEN_GRID_Y);
+        snowflake_frame_rebuild(frame);
+    }
+    
+    // Step 0 is the seed; later frames are only updated as cells freeze
+    for(int step = 0; ok && *match && step <= REFERENCE_STEPS; step++) {
+        if(step > 0) {
+            snowflake_model_step(model);
+            snowflake_frame_update_zoom(frame, false);
+        }
+        
+        canvas_clear(canvas);
+        canvas_draw_xbm(
+            canvas, SNOWFLAKE_SCREEN_GRID_X, SNOWFLAKE_SCREEN_GRID_Y, SNOWFLAKE_FRAME_WIDTH, SNOWFLAKE_FRAME_HEIGHT,
+            frame->bits);
+        canvas_clear(reference);
+        snowflake_frame_reference_draw(reference, REFERENCE_SIZE, snowflake_model_get_frozen(model));
+        
+        const uint8_t* pixels = canvas_stub_pixels(canvas);
+        const uint8_t* expected = canvas_stub_pixels(reference);
+        for(int y = SNOWFLAKE_SCREEN_GRID_Y; *match && y < SNOWFLAKE_SCREEN_GRID_Y + SNOWFLAKE_FRAME_HEIGHT; y++) {
+            for(int x = SNOWFLAKE_SCREEN_GRID_X; x < SNOWFLAKE_SCREEN_GRID_X + SNOWFLAKE_FRAME_WIDTH; x++) {
+                if(pixels[y * CANVAS_STUB_WIDTH + x] != expected[y * CANVAS_STUB_WIDTH + x]) {
+                    fprintf(stderr, "reference %s: step %d differs from the original renderer at (%d, %d)\n",
+                            preset->name, step, x, y);
+                    *match = false;
+                    break;
+                }
+            }
+        }
+    }
+    
+    snowflake_model_free(model);
+    free(frame);
+    canvas_stub_free(canvas);
+    canvas_stub_free(reference);
+    return ok;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --frames N     timed frames per scenario (default %d)\n"
+            "  --golden DIR   golden images (default %s)\n"
+            "  --update       write the golden images instead of comparing\n",
+            name, DEFAULT_FRAMES, DEFAULT_GOLDEN_DIR);
+}
+
+int main(int argc, char** argv) {
+    RenderConfig config = {
+        .frames = DEFAULT_FRAMES,
+        .golden_dir = DEFAULT_GOLDEN_DIR,
+        .update = false,
+    };
+    
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if(strcmp(arg, "--update") == 0) {
+            config.update = true;
+            continue;
+        }
+        if(!value) {
+            usage(argv[0]);
+            return 2;
+        }
+        if(strcmp(arg, "--frames") == 0) {
+            config.frames = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "--golden") == 0) {
+            config.golden_dir = value;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    
+    if(config.frames < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+    
+    printf("%-10s %4s %5s %6s %4s %10s %9s %6s  calls per frame\n",
+           "scenario", "size", "steps", "frozen", "zoom", "frames/s", "us/frame", "calls");
+    
+    int failures = 0;
+    for(size_t s = 0; s < RENDER_SCENARIO_COUNT; s++) {
+        bool match = false;
+        if(!render_scenario(&config, &render_scenarios[s], &match)) {
+            fprintf(stderr, "%s: out of memory\n", render_scenarios[s].name);
+            failures++;
+        } else if(!match) {
+            failures++;
+        }
+    }
+    
+    int matching = 0;
+    for(size_t p = 0; p < snowflake_preset_count; p++) {
+        bool match = false;
+        if(!reference_check(&snowflake_presets[p], &match)) {
+            fprintf(stderr, "reference %s: out of memory\n", snowflake_presets[p].name);
+            failures++;
+        } else if(match) {
+            matching++;
+        } else {
+            failures++;
+        }
+    }
+    printf("reference  %4d %5d  %d/%zu presets match the original renderer at 5x3\n", REFERENCE_SIZE,
+           REFERENCE_STEPS, matching, snowflake_preset_count);
+    
+    return failures ? 1 : 0;
+}
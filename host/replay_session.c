@@ -0,0 +1,386 @@
+// Includes
+#include <math.h>           // fminf, fmaxf
+#include <stdio.h>          // printf, fopen
+#include <stdlib.h>         // atoi
+#include <string.h>         // strcmp
+#include "host_util.h"
+#include "snowflake_config.h"
+#include "snowflake_frame.h"
+#include "snowflake_history.h"
+#include "snowflake_model.h"
+#include "snowflake_recording.h"
+#include "snowflake_tiles.h"
+
+// ===================================================================
+// Replay a recorded session (session.rec from the app data folder on
+// the SD card) against the portable model and frame renderer at full
+// speed, and report where the time goes.
+//
+// The input handling mirrors the main loop of snowflake_main. The
+// background preview runs synchronously here: every parameter change
+// regrows PREVIEW_STEPS steps from the seed before the next event, as
+// on the device when the user pauses long enough. The gallery screen
+// only swallows the keys it takes on the device; the flakes picked on
+// it are on the recording user's SD card, so the replay goes on with
+// the flake it has and counts the picks.
+// ===================================================================
+
+// Undo history as configured by default in snowflake.c / settings.txt
+#define HISTORY_KB 16
+#define HISTORY_KEYFRAME_STEPS 20
+
+typedef enum {
+    PARAM_ALPHA,
+    PARAM_BETA,
+    PARAM_GAMMA,
+    PARAM_STEP,
+    PARAM_TOOL,
+    PARAM_COUNT
+} ParamType;
+
+typedef enum {
+    TOOL_VIEW,
+    TOOL_GALLERY,
+    TOOL_SWAP,
+    TOOL_DEMO,
+    TOOL_TRACE,
+    TOOL_DEBUG,
+    TOOL_BENCH,
+    TOOL_COUNT
+} ToolType;
+
+typedef struct {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} ReplayTiming;
+
+typedef struct {
+    SnowflakeModel* model;
+    SnowflakeFrame frame;
+    SnowflakeModel* preview_model;  // The preview grows here, then is copied over
+    SnowflakeFrame preview_frame;
+    SnowflakeHistory* history;
+    SnowflakeTiles* other_branch;  // Flake the last branch left behind, NULL if none
+    
+    SnowflakeParams params;
+    ParamType selected_param;
+    ToolType selected_tool;
+    bool view_mode;
+    bool gallery_open;
+    uint32_t gallery_picks;
+    uint32_t back_press_tick;
+    
+    ReplayTiming step;     // Manual steps, incl. cells drawn as they freeze
+    ReplayTiming render;   // Zoom updates, rebuilds, pans, rewinds
+    ReplayTiming preview;  // Complete preview regrows
+    ReplayTiming undo;     // Keyframes and branches off a rewind
+    uint64_t preview_steps;
+} ReplayApp;
+
+static void timing_add(ReplayTiming* timing, uint64_t start) {
+    uint64_t ns = now_ns() - start;
+    timing->count++;
+    timing->total_ns += ns;
+    if(ns > timing->max_ns) timing->max_ns = ns;
+}
+
+// ===================================================================
+// Function: App actions, as in snowflake.c
+// ===================================================================
+static void replay_reset(ReplayApp* app) {
+    uint64_t start = now_ns();
+    snowflake_model_set_params(app->model, &app->params);
+    snowflake_model_reset(app->model);
+    snowflake_frame_reset(&app->frame);
+    timing_add(&app->render, start);
+    snowflake_history_seed(app->history, &app->params);
+    snowflake_tiles_free(app->other_branch);
+    app->other_branch = NULL;
+}
+
+// ===================================================================
+// Function: Branch off the rewound step, as branch_from_rewind()
+// ===================================================================
+static bool replay_branch(ReplayApp* app) {
+    int step = app->frame.rewind_step;
+    if(step == SNOWFLAKE_FRAME_LIVE) return false;
+    
+    uint64_t start = now_ns();
+    SnowflakeTiles* left = snowflake_tiles_alloc(app->model);
+    bool restored = snowflake_history_restore(app->history, app->model, step);
+    if(restored) {
+        app->params = *snowflake_model_get_params(app->model);
+        snowflake_tiles_free(app->other_branch);
+        app->other_branch = left;
+    } else {
+        snowflake_tiles_free(left);
+    }
+    timing_add(&app->undo, start);
+    
+    start = now_ns();
+    snowflake_frame_rewind(&app->frame, SNOWFLAKE_FRAME_LIVE);
+    snowflake_frame_update_zoom(&app->frame, false);
+    timing_add(&app->render, start);
+    return restored;
+}
+
+// ===================================================================
+// Function: Swap with the other branch, as swap_branch()
+// ===================================================================
+static void replay_swap(ReplayApp* app) {
+    uint64_t start = now_ns();
+    SnowflakeTiles* current = snowflake_tiles_fork(app->other_branch);
+    if(!current || !snowflake_tiles_store(current, app->model)) {
+        snowflake_tiles_free(current);
+        return;
+    }
+    snowflake_tiles_load(app->other_branch, app->model);
+    snowflake_tiles_free(app->other_branch);
+    app->other_branch = current;
+    app->params = *snowflake_model_get_params(app->model);
+    snowflake_history_clear(app->history);
+    snowflake_history_record(app->history, app->model, true);
+    timing_add(&app->undo, start);
+    
+    start = now_ns();
+    snowflake_frame_reset(&app->frame);
+    timing_add(&app->render, start);
+}
+
+static void replay_record(ReplayApp* app, const SnowflakeModel* model, bool force) {
+    uint64_t start = now_ns();
+    snowflake_history_record(app->history, model, force);
+    timing_add(&app->undo, start);
+}
+
+static void replay_step(ReplayApp* app) {
+    replay_branch(app);
+    
+    uint64_t start = now_ns();
+    snowflake_model_step(app->model);
+    timing_add(&app->step, start);
+    
+    start = now_ns();
+    snowflake_frame_update_zoom(&app->frame, false);
+    timing_add(&app->render, start);
+    replay_record(app, app->model, false);
+}
+
+static void replay_preview(ReplayApp* app) {
+    uint64_t start = now_ns();
+    snowflake_model_set_params(app->preview_model, &app->params);
+    snowflake_model_reset(app->preview_model);
+    snowflake_frame_reset(&app->preview_frame);
+    snowflake_history_seed(app->history, &app->params);
+    for(int i = 0; i < PREVIEW_STEPS; i++) {
+        snowflake_model_step(app->preview_model);
+        snowflake_frame_update_zoom(&app->preview_frame, false);
+        snowflake_history_record(app->history, app->preview_model, false);
+    }
+    snowflake_model_copy(app->model, app->preview_model);
+    snowflake_frame_copy(&app->frame, &app->preview_frame);
+    timing_add(&app->preview, start);
+    app->preview_steps += PREVIEW_STEPS;
+}
+
+static void replay_scrub(ReplayApp* app, int direction) {
+    uint64_t start = now_ns();
+    int shown = app->frame.rewind_step;
+    if(shown == SNOWFLAKE_FRAME_LIVE) shown = snowflake_model_get_step(app->model);
+    if(direction < 0 && shown > 0) shown--;
+    if(direction > 0) shown++;
+    snowflake_frame_rewind(&app->frame, shown);
+    timing_add(&app->render, start);
+}
+
+static void replay_adjust(ReplayApp* app, int direction) {
+    if(app->selected_param == PARAM_STEP) {
+        replay_scrub(app, direction);
+        return;
+    }
+    
+    SnowflakeParams params = app->params;
+    if(app->selected_param == PARAM_ALPHA) {
+        params.alpha = direction > 0 ? fminf(params.alpha + ALPHA_STEP, ALPHA_MAX) :
+                                       fmaxf(params.alpha - ALPHA_STEP, ALPHA_MIN);
+    } else if(app->selected_param == PARAM_BETA) {
+        params.beta = direction > 0 ? fminf(params.beta + BETA_STEP, BETA_MAX) :
+                                      fmaxf(params.beta - BETA_STEP, BETA_MIN);
+    } else if(app->selected_param == PARAM_GAMMA) {
+        params.gamma = direction > 0 ? fminf(params.gamma + GAMMA_STEP, GAMMA_MAX) :
+                                       fmaxf(params.gamma - GAMMA_STEP, GAMMA_MIN);
+    }
+    
+    // A rewound flake branches off with the new parameters instead of regrowing
+    bool branched = replay_branch(app);
+    app->params = params;
+    snowflake_model_set_params(app->model, &app->params);
+    replay_record(app, app->model, true);
+    if(!branched) replay_preview(app);
+}
+
+// ===================================================================
+// Function: Handle one event like the main loop. Returns false on exit.
+// ===================================================================
+static bool replay_event(ReplayApp* app, const SnowflakeRecordedEvent* event) {
+    bool press = event->type == SNOWFLAKE_INPUT_PRESS || event->type == SNOWFLAKE_INPUT_REPEAT;
+    
+    if(event->key == SNOWFLAKE_KEY_BACK) {
+        if(event->type == SNOWFLAKE_INPUT_PRESS) {
+            app->back_press_tick = event->tick;
+        } else if(event->type == SNOWFLAKE_INPUT_RELEASE) {
+            if(event->tick - app->back_press_tick > BACK_LONG_PRESS_MS) return false;
+            if(app->gallery_open) {
+                app->gallery_open = false;
+            } else if(app->view_mode) {
+                app->view_mode = false;
+            } else {
+                replay_reset(app);
+            }
+        }
+    } else if(app->gallery_open) {
+        // Left/Right page through the gallery, OK picks and closes it
+        if(event->key == SNOWFLAKE_KEY_OK && press) {
+            app->gallery_open = false;
+            app->gallery_picks++;
+        }
+    } else if(app->view_mode) {
+        // Long OK saves an image, nothing to replay
+        if(event->key == SNOWFLAKE_KEY_OK && event->type == SNOWFLAKE_INPUT_SHORT) {
+            uint64_t start = now_ns();
+            snowflake_frame_cycle_zoom(&app->frame);
+            timing_add(&app->render, start);
+        } else if(press) {
+            int dx = 0, dy = 0;
+            if(event->key == SNOWFLAKE_KEY_UP) dy = -PAN_STEP;
+            if(event->key == SNOWFLAKE_KEY_DOWN) dy = PAN_STEP;
+            if(event->key == SNOWFLAKE_KEY_LEFT) dx = -PAN_STEP;
+            if(event->key == SNOWFLAKE_KEY_RIGHT) dx = PAN_STEP;
+            if(dx || dy) {
+                uint64_t start = now_ns();
+                snowflake_frame_pan(&app->frame, dx, dy);
+                timing_add(&app->render, start);
+            }
+        }
+    } else if(event->key == SNOWFLAKE_KEY_OK && event->type == SNOWFLAKE_INPUT_SHORT &&
+              app->selected_param == PARAM_TOOL) {
+        if(app->selected_tool == TOOL_VIEW) {
+            app->view_mode = true;
+        } else if(app->selected_tool == TOOL_GALLERY) {
+            app->gallery_open = true;
+        } else if(app->selected_tool == TOOL_SWAP && app->other_branch) {
+            replay_swap(app);
+        }
+        // The other tools only write to the SD card or draw, nothing to replay
+    } else if(press) {
+        if(event->key == SNOWFLAKE_KEY_OK && app->selected_param == PARAM_TOOL) {
+            // The tool row runs on the release
+        } else if(event->key == SNOWFLAKE_KEY_OK) {
+            replay_step(app);
+        } else if(event->key == SNOWFLAKE_KEY_UP) {
+            app->selected_param = (app->selected_param + PARAM_COUNT - 1) % PARAM_COUNT;
+        } else if(event->key == SNOWFLAKE_KEY_DOWN) {
+            app->selected_param = (app->selected_param + 1) % PARAM_COUNT;
+        } else if(app->selected_param == PARAM_TOOL &&
+                  (event->key == SNOWFLAKE_KEY_LEFT || event->key == SNOWFLAKE_KEY_RIGHT)) {
+            app->selected_tool =
+                (app->selected_tool + (event->key == SNOWFLAKE_KEY_RIGHT ? 1 : TOOL_COUNT - 1)) % TOOL_COUNT;
+        } else if(event->key == SNOWFLAKE_KEY_RIGHT) {
+            replay_adjust(app, 1);
+        } else if(event->key == SNOWFLAKE_KEY_LEFT) {
+            replay_adjust(app, -1);
+        }
+    }
+    return true;
+}
+
+static void print_timing(const char* name, const ReplayTiming* timing) {
+    printf("%-8s %8llu  total %9.3f ms  mean %9.2f us  max %9.2f us\n", name,
+           (unsigned long long)timing->count, timing->total_ns / 1e6,
+           timing->count ? timing->total_ns / 1e3 / timing->count : 0.0, timing->max_ns / 1e3);
+}
+
+int main(int argc, char** argv) {
+    int size_override = 0;
+    const char* path = NULL;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            size_override = atoi(argv[++i]);
+        } else if(!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if(!path) {
+        fprintf(stderr, "Usage: %s [-n size] session.rec\n"
+                        "  -n size   replay on a different lattice size than recorded\n", argv[0]);
+        return 1;
+    }
+    
+    FILE* file = fopen(path, "rb");
+    if(!file) {
+        perror(path);
+        return 1;
+    }
+    SnowflakeReader reader = {.read = file_read, .context = file};
+    SnowflakeRecordingHeader header;
+    if(!snowflake_recording_read_header(&reader, &header)) {
+        fprintf(stderr, "%s: not a version %d session recording\n", path, SNOWFLAKE_RECORDING_VERSION);
+        fclose(file);
+        return 1;
+    }
+    int size = size_override ? size_override : header.grid_size;
+    
+    static ReplayApp app;
+    app.params = header.params;
+    app.selected_param = PARAM_ALPHA;
+    app.model = snowflake_model_alloc(size, &app.params);
+    app.preview_model = snowflake_model_alloc(size, &app.params);
+    app.history = snowflake_history_alloc(HISTORY_KB * 1024, HISTORY_KEYFRAME_STEPS);
+    if(!app.model || !app.preview_model || !app.history) {
+        fprintf(stderr, "Out of memory for a %dx%d lattice\n", size, size);
+        fclose(file);
+        return 1;
+    }
+    snowflake_frame_init(&app.frame, app.model);
+    snowflake_frame_init(&app.preview_frame, app.preview_model);
+    replay_reset(&app);
+    app.render = (ReplayTiming){0};
+    
+    SnowflakeRecordedEvent event = {0};
+    uint32_t events = 0;
+    bool exited = false;
+    uint64_t start = now_ns();
+    while(snowflake_recording_read_event(&reader, &event)) {
+        events++;
+        if(!replay_event(&app, &event)) {
+            exited = true;
+            break;
+        }
+    }
+    double replay_ms = (now_ns() - start) / 1e6;
+    fclose(file);
+    
+    printf("session %s: size=%d events=%u duration=%.1f s%s\n", path, size, (unsigned)events,
+           event.tick / 1e3, exited ? " (exit)" : "");
+    printf("replay %.3f ms, final step %d, %d frozen\n", replay_ms, snowflake_model_get_step(app.model),
+           snowflake_model_get_stats(app.model)->frozen_total);
+    if(app.gallery_picks) printf("gallery  %8u picks not replayed\n", (unsigned)app.gallery_picks);
+    print_timing("step", &app.step);
+    print_timing("render", &app.render);
+    print_timing("preview", &app.preview);
+    print_timing("undo", &app.undo);
+    if(app.preview.count) {
+        printf("preview  %8llu steps, %.2f us per step incl. render\n",
+               (unsigned long long)app.preview_steps, app.preview.total_ns / 1e3 / app.preview_steps);
+    }
+    
+    snowflake_model_free(app.model);
+    snowflake_model_free(app.preview_model);
+    snowflake_history_free(app.history);
+    snowflake_tiles_free(app.other_branch);
+    return 0;
+}
@@ -0,0 +1,468 @@
+// Includes
+#include <stdio.h>          // printf
+#include <stdlib.h>         // strtol, strtof
+#include <string.h>         // strcmp, strrchr
+#include <time.h>           // clock_gettime
+#include "host_util.h"
+#include "snowflake_checkpoint.h"
+#include "snowflake_export.h"
+#include "snowflake_gallery.h"
+#include "snowflake_growth.h"
+#include "snowflake_model.h"
+#include "snowflake_paged.h"
+#include "snowflake_profile.h"
+#include "snowflake_trace.h"
+
+// ===================================================================
+// Host command line runner for the snowflake model
+// Grows a flake with the given parameters and prints its statistics,
+// optionally as ASCII art. Handy as a target for perf/gprof.
+// ===================================================================
+
+#define DEFAULT_GALLERY_KB 256
+#define DEFAULT_PAGED_CACHE_KB 64
+
+// ===================================================================
+// Function: Print usage
+// ===================================================================
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [-n size] [-s steps] [-a alpha] [-b beta] [-g gamma] [-p] [-t] [-T trace.bin]\n"
+            "          [-R resume.ckpt] [-C checkpoint.ckpt] [-G growth.sfg] [-c dir] [-k KB] [-E file]\n"
+            "  -n size   lattice size (default 16)\n"
+            "  -s steps  number of steps (default 200)\n"
+            "  -a/-b/-g  model parameters (default 1.0 0.5 0.01)\n"
+            "  -p        print the frozen mask\n"
+            "  -t        print per-phase timings of the last steps\n"
+            "  -T file   write a binary trace of the run (see trace_dump)\n"
+            "  -R file   resume from a checkpoint (size and parameters come from the file)\n"
+            "  -C file   write a checkpoint after the last step\n"
+            "  -G file   record the growth for playback (see growth_play, not with -R)\n"
+            "  -c dir    gallery cache: load the flake from dir if it was grown before,\n"
+            "            otherwise grow it and add it (not with -R or -G)\n"
+            "  -k KB     byte budget of the gallery (default %d)\n"
+            "  -E file   export after the last step, by extension: .pbm/.bmp/.png image,\n"
+            "            .pgm (16 bit, 0 to the largest s) / .raw (float32) s field,\n"
+            "            .gif growth animation\n"
+            "  -D file   grow out of core, the tiles in the scratch file, for lattices\n"
+            "            larger than RAM (statistics only: not with -R/-G/-c/-C/-E/-T/-t/-p)\n"
+            "  -m KB     tile cache of -D (default %d)\n",
+            name, DEFAULT_GALLERY_KB, DEFAULT_PAGED_CACHE_KB);
+}
+
+// ===================================================================
+// Function: Print the frozen mask, odd columns shifted half a row
+// ===================================================================
+static void print_frozen(const SnowflakeModel* model) {
+    int size = snowflake_model_get_size(model);
+    for(int row = 0; row < 2 * size; row++) {
+        for(int x = 0; x < size; x++) {
+            int y = row / 2;
+            bool shifted_row = (row % 2) != (x % 2);
+            putchar(shifted_row ? ' ' : (snowflake_model_is_frozen(model, x, y) ? '#' : '.'));
+        }
+        putchar('\n');
+    }
+}
+
+// ===================================================================
+// Function: SnowflakeBlockFile over a stdio FILE
+// ===================================================================
+static bool file_block_read(void* context, uint64_t offset, void* data, size_t size) {
+    return fseeko((FILE*)context, (off_t)offset, SEEK_SET) == 0 && fread(data, 1, size, (FILE*)context) == size;
+}
+
+static bool file_block_write(void* context, uint64_t offset, const void* data, size_t size) {
+    return fseeko((FILE*)context, (off_t)offset, SEEK_SET) == 0 && fwrite(data, 1, size, (FILE*)context) == size;
+}
+
+// ===================================================================
+// Function: Grow out of core and print the statistics
+// ===================================================================
+static int run_paged(int size, int steps, const SnowflakeParams* params, const char* path, int cache_kb) {
+    FILE* file = fopen(path, "w+b");
+    if(!file) {
+        fprintf(stderr, "Cannot create %s\n", path);
+        return 1;
+    }
+    SnowflakeBlockFile block = {.read = file_block_read, .write = file_block_write, .context = file};
+    SnowflakePaged* paged = snowflake_paged_alloc(size, params, &block, (size_t)cache_kb * 1024);
+    if(!paged) {
+        fprintf(stderr, "Out of memory or failed to write %s\n", path);
+        fclose(file);
+        return 1;
+    }
+    
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(int i = 0; i < steps; i++) {
+        if(snowflake_paged_step(paged) < 0) {
+            fprintf(stderr, "I/O failure on %s at step %d\n", path, snowflake_paged_get_step(paged));
+            snowflake_paged_free(paged);
+            fclose(file);
+            return 1;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) * 1e-9;
+    
+    const SnowflakeStats* stats = snowflake_paged_get_stats(paged);
+    const SnowflakePagedIo* io = snowflake_paged_get_io(paged);
+    int lines = snowflake_paged_get_cache_lines(paged);
+    printf("size=%d step=%d alpha=%.3f beta=%.3f gamma=%.4f\n",
+           size, snowflake_paged_get_step(paged), (double)params->alpha, (double)params->beta, (double)params->gamma);
+    printf("frozen=%d radius=%d perimeter=%d bbox=[%d..%d]x[%d..%d]\n",
+           stats->frozen_total, stats->radius, stats->perimeter,
+           stats->min_x, stats->max_x, stats->min_y, stats->max_y);
+    if(steps > 0) {
+        printf("time=%.3f ms (%.1f us/step)\n", seconds * 1e3, seconds * 1e6 / steps);
+    }
+    printf("paged: cache=%d lines (%zu bytes) read=%llu written=%llu bytes, %llu misses\n", lines,
+           (size_t)lines * SNOWFLAKE_PAGED_LINE_BYTES, (unsigned long long)io->bytes_read,
+           (unsigned long long)io->bytes_written, (unsigned long long)io->misses);
+    
+    snowflake_paged_free(paged);
+    return fclose(file) == 0 ? 0 : 1;
+}
+
+// ===================================================================
+// Function: Lattice size stored in a checkpoint, 0 if unreadable
+// ===================================================================
+static int checkpoint_size(const char* path) {
+    uint8_t header[SNOWFLAKE_CHECKPOINT_HEADER_SIZE];
+    FILE* file = fopen(path, "rb");
+    if(!file) return 0;
+    size_t read = fread(header, 1, sizeof(header), file);
+    fclose(file);
+    return read == sizeof(header) ? snowflake_get_u16(header + 6) : 0;
+}
+
+// ===================================================================
+// Function: Gallery files: the index and one checkpoint per entry
+// ===================================================================
+static void gallery_path(char* path, size_t size, const char* dir, uint32_t id) {
+    if(id) {
+        snprintf(path, size, "%s/%lu.bin", dir, (unsigned long)id);
+    } else {
+        snprintf(path, size, "%s/index.bin", dir);
+    }
+}
+
+static void gallery_load(SnowflakeGallery* gallery, const char* dir) {
+    char path[512];
+    gallery_path(path, sizeof(path), dir, 0);
+    FILE* file = fopen(path, "rb");
+    SnowflakeReader reader = {.read = file_read, .context = file};
+    if(!file || !snowflake_gallery_read(gallery, &reader)) snowflake_gallery_init(gallery, gallery->capacity);
+    if(file) fclose(file);
+}
+
+static bool gallery_save(const SnowflakeGallery* gallery, const char* dir) {
+    char path[512];
+    gallery_path(path, sizeof(path), dir, 0);
+    FILE* file = fopen(path, "wb");
+    SnowflakeWriter writer = {.write = file_write, .context = file};
+    bool ok = file && snowflake_gallery_write(gallery, &writer);
+    if(file && fclose(file) != 0) ok = false;
+    return ok;
+}
+
+// ===================================================================
+// Function: Load a gallery entry into the model, false if unreadable
+// ===================================================================
+static bool gallery_fetch(const char* dir, uint32_t id, SnowflakeModel* model) {
+    char path[512];
+    gallery_path(path, sizeof(path), dir, id);
+    FILE* file = fopen(path, "rb");
+    SnowflakeReader reader = {.read = file_read, .context = file};
+    bool ok = file && snowflake_checkpoint_read(model, &reader);
+    if(file) fclose(file);
+    return ok;
+}
+
+// ===================================================================
+// Function: Add the model to the gallery, deleting evicted files
+// ===================================================================
+static bool gallery_store(SnowflakeGallery* gallery, const char* dir, const SnowflakeModel* model) {
+    char path[512];
+    uint32_t id = snowflake_gallery_reserve(gallery);
+    gallery_path(path, sizeof(path), dir, id);
+    FILE* file = fopen(path, "wb");
+    SnowflakeWriter writer = {.write = file_write, .context = file};
+    bool ok = file && snowflake_checkpoint_write(model, &writer);
+    long bytes = file ? ftell(file) : 0;
+    if(file && fclose(file) != 0) ok = false;
+    if(!ok) {
+        remove(path);
+        return false;
+    }
+    
+    SnowflakeGalleryKey key = snowflake_gallery_key(
+        snowflake_model_get_params(model), snowflake_model_get_size(model), snowflake_model_get_step(model));
+    uint32_t evicted[SNOWFLAKE_GALLERY_MAX_ENTRIES + 1];
+    int evicted_count = snowflake_gallery_add(gallery, &key, id, (uint32_t)bytes, evicted);
+    for(int i = 0; i < evicted_count; i++) {
+        gallery_path(path, sizeof(path), dir, evicted[i]);
+        remove(path);
+    }
+    printf("gallery: stored %ld bytes as %lu, evicted %d, %d entries %zu bytes\n", bytes, (unsigned long)id,
+           evicted_count, gallery->count, snowflake_gallery_bytes(gallery));
+    return gallery_save(gallery, dir);
+}
+
+int main(int argc, char** argv) {
+    int size = 16;
+    int steps = 200;
+    bool print = false;
+    bool profile_phases = false;
+    const char* trace_path = NULL;
+    const char* resume_path = NULL;
+    const char* checkpoint_path = NULL;
+    const char* growth_path = NULL;
+    const char* gallery_dir = NULL;
+    const char* export_path = NULL;
+    const char* paged_path = NULL;
+    int paged_kb = DEFAULT_PAGED_CACHE_KB;
+    SnowflakeExportFormat export_format = SNOWFLAKE_EXPORT_PNG;
+    int gallery_kb = DEFAULT_GALLERY_KB;
+    SnowflakeParams params = {.alpha = 1.0f, .beta = 0.5f, .gamma = 0.01f};
+    
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if(strcmp(arg, "-p") == 0) {
+            print = true;
+            continue;
+        }
+        if(strcmp(arg, "-t") == 0) {
+            profile_phases = true;
+            continue;
+        }
+        if(!value) {
+            usage(argv[0]);
+            return 1;
+        }
+        if(strcmp(arg, "-n") == 0) {
+            size = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "-s") == 0) {
+            steps = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "-T") == 0) {
+            trace_path = value;
+        } else if(strcmp(arg, "-R") == 0) {
+            resume_path = value;
+        } else if(strcmp(arg, "-C") == 0) {
+            checkpoint_path = value;
+        } else if(strcmp(arg, "-G") == 0) {
+            growth_path = value;
+        } else if(strcmp(arg, "-E") == 0) {
+            const char* extension = strrchr(value, '.');
+            if(!extension || !snowflake_export_find_format(extension + 1, &export_format)) {
+                usage(argv[0]);
+                return 1;
+            }
+            export_path = value;
+        } else if(strcmp(arg, "-c") == 0) {
+            gallery_dir = value;
+        } else if(strcmp(arg, "-k") == 0) {
+            gallery_kb = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "-D") == 0) {
+            paged_path = value;
+        } else if(strcmp(arg, "-m") == 0) {
+            paged_kb = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "-a") == 0) {
+            params.alpha = strtof(value, NULL);
+        } else if(strcmp(arg, "-b") == 0) {
+            params.beta = strtof(value, NULL);
+        } else if(strcmp(arg, "-g") == 0) {
+            params.gamma = strtof(value, NULL);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    
+    if(resume_path) {
+        size = checkpoint_size(resume_path);
+        if(size == 0) {
+            fprintf(stderr, "Cannot read %s\n", resume_path);
+            return 1;
+        }
+    }
+    
+    if(size < 5 || steps < 0 || (growth_path && resume_path) || (gallery_dir && (resume_path || growth_path)) ||
+       gallery_kb < 0 || paged_kb < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    
+    // Out of core the state never is in RAM as a whole
+    if(paged_path) {
+        if(resume_path || growth_path || gallery_dir || checkpoint_path || export_path || trace_path ||
+           profile_phases || print) {
+            usage(argv[0]);
+            return 1;
+        }
+        return run_paged(size, steps, &params, paged_path, paged_kb);
+    }
+    
+    SnowflakeModel* model = snowflake_model_alloc(size, &params);
+    if(!model) {
+        fprintf(stderr, "Out of memory for a %dx%d lattice\n", size, size);
+        return 1;
+    }
+    
+    if(resume_path) {
+        FILE* file = fopen(resume_path, "rb");
+        SnowflakeReader reader = {.read = file_read, .context = file};
+        bool resumed = file && snowflake_checkpoint_read(model, &reader);
+        if(file) fclose(file);
+        if(!resumed) {
+            fprintf(stderr, "Invalid checkpoint %s\n", resume_path);
+            snowflake_model_free(model);
+            return 1;
+        }
+        params = *snowflake_model_get_params(model);
+    }
+    
+    // A flake grown before comes from the gallery instead of the simulation
+    static SnowflakeGallery gallery;
+    bool cached = false;
+    if(gallery_dir) {
+        gallery.capacity = (size_t)gallery_kb * 1024;
+        gallery_load(&gallery, gallery_dir);
+        SnowflakeGalleryKey key = snowflake_gallery_key(&params, size, steps);
+        int index = snowflake_gallery_find(&gallery, &key);
+        if(index >= 0) {
+            uint32_t id = gallery.entries[index].id;
+            cached = gallery_fetch(gallery_dir, id, model);
+            if(cached) {
+                snowflake_gallery_touch(&gallery, index);
+                printf("gallery: hit %lu, %d entries %zu bytes\n", (unsigned long)id, gallery.count,
+                       snowflake_gallery_bytes(&gallery));
+                gallery_save(&gallery, gallery_dir);
+            } else {
+                snowflake_gallery_remove(&gallery, index);
+            }
+        }
+    }
+    int grow_steps = cached ? 0 : steps;
+    
+    SnowflakeProfile profile;
+    snowflake_profile_reset(&profile);
+    if(profile_phases) snowflake_model_set_profile(model, &profile);
+    
+    static SnowflakeTrace trace;
+    snowflake_trace_reset(&trace);
+    if(trace_path) snowflake_trace_params(&trace, SNOWFLAKE_TRACE_RESET, SNOWFLAKE_TRACE_MANUAL, model, &params);
+    
+    // A recording always starts from the seed
+    FILE* growth_file = growth_path ? fopen(growth_path, "wb") : NULL;
+    SnowflakeWriter growth_writer = {.write = file_write, .context = growth_file};
+    static SnowflakeGrowthRecorder recorder;
+    if(growth_path && (!growth_file || !snowflake_growth_recorder_begin(&recorder, &growth_writer, model))) {
+        fprintf(stderr, "Failed to write %s\n", growth_path);
+        if(growth_file) fclose(growth_file);
+        snowflake_model_free(model);
+        return 1;
+    }
+    
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(int i = 0; i < grow_steps; i++) {
+        if(trace_path) {
+            uint32_t step_start = snowflake_profile_now();
+            int frozen_count = snowflake_model_step(model);
+            snowflake_trace_step(&trace, SNOWFLAKE_TRACE_MANUAL, model, frozen_count,
+                                 snowflake_profile_now() - step_start);
+        } else {
+            snowflake_model_step(model);
+        }
+        if(growth_file) snowflake_growth_recorder_step(&recorder);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) * 1e-9;
+    
+    if(gallery_dir && !cached && !gallery_store(&gallery, gallery_dir, model)) {
+        fprintf(stderr, "Failed to write the gallery in %s\n", gallery_dir);
+        snowflake_model_free(model);
+        return 1;
+    }
+    
+    if(growth_file) {
+        bool recorded = snowflake_growth_recorder_end(&recorder);
+        long length = ftell(growth_file);
+        if(fclose(growth_file) != 0 || !recorded) {
+            fprintf(stderr, "Failed to write %s\n", growth_path);
+            snowflake_model_free(model);
+            return 1;
+        }
+        printf("growth=%ld bytes steps=%u cells=%u\n", length, (unsigned)recorder.steps, (unsigned)recorder.cells);
+    }
+    
+    if(print) print_frozen(model);
+    
+    const SnowflakeStats* stats = snowflake_model_get_stats(model);
+    printf("size=%d step=%d alpha=%.3f beta=%.3f gamma=%.4f\n",
+           size, snowflake_model_get_step(model), (double)params.alpha, (double)params.beta, (double)params.gamma);
+    printf("frozen=%d radius=%d perimeter=%d bbox=[%d..%d]x[%d..%d]\n",
+           stats->frozen_total, stats->radius, stats->perimeter,
+           stats->min_x, stats->max_x, stats->min_y, stats->max_y);
+    if(grow_steps > 0) {
+        printf("time=%.3f ms (%.1f us/step)\n", seconds * 1e3, seconds * 1e6 / grow_steps);
+    }
+    if(profile_phases) {
+        double ticks_per_us = snowflake_profile_ticks_per_us();
+        for(int phase = 0; phase < SNOWFLAKE_PHASE_COUNT; phase++) {
+            SnowflakeProfileStats phase_stats;
+            snowflake_profile_get_stats(&profile, phase, &phase_stats);
+            if(phase_stats.count == 0) continue;
+            printf("%-8s avg=%.1f min=%.1f max=%.1f us (last %d steps)\n",
+                   snowflake_profile_phase_name(phase),
+                   phase_stats.avg / ticks_per_us, phase_stats.min / ticks_per_us,
+                   phase_stats.max / ticks_per_us, phase_stats.count);
+        }
+    }
+    
+    if(checkpoint_path) {
+        FILE* file = fopen(checkpoint_path, "wb");
+        SnowflakeWriter writer = {.write = file_write, .context = file};
+        if(!file || !snowflake_checkpoint_write(model, &writer)) {
+            fprintf(stderr, "Failed to write %s\n", checkpoint_path);
+            if(file) fclose(file);
+            snowflake_model_free(model);
+            return 1;
+        }
+        fclose(file);
+    }
+    
+    if(export_path) {
+        static SnowflakeFrame frame;
+        snowflake_frame_init(&frame, model);
+        SnowflakeExportOptions options = {.format = export_format, .zoom = 0, .scale = 1};
+        FILE* file = fopen(export_path, "wb");
+        SnowflakeWriter writer = {.write = file_write, .context = file};
+        if(!file || !snowflake_export_write(&frame, &options, &writer)) {
+            fprintf(stderr, "Failed to write %s\n", export_path);
+            if(file) fclose(file);
+            snowflake_model_free(model);
+            return 1;
+        }
+        fclose(file);
+    }
+    
+    if(trace_path) {
+        FILE* file = fopen(trace_path, "wb");
+        SnowflakeWriter writer = {.write = file_write, .context = file};
+        if(!file || !snowflake_trace_write(&trace, &writer, snowflake_profile_ticks_per_us())) {
+            fprintf(stderr, "Failed to write %s\n", trace_path);
+            if(file) fclose(file);
+            snowflake_model_free(model);
+            return 1;
+        }
+        fclose(file);
+    }
+    
+    snowflake_model_free(model);
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Includes
+#include "snowflake_frame_reference.h"
+#include <stdbool.h>
+
+// ===================================================================
+// Do not optimize anything in this file: it defines the pixels the
+// cached frame renderer is compared against.
+// ===================================================================
+
+#define HEX_WIDTH SNOWFLAKE_FRAME_REFERENCE_HEX_WIDTH
+#define HEX_HEIGHT SNOWFLAKE_FRAME_REFERENCE_HEX_HEIGHT
+#define SCREEN_OFFSET_X SNOWFLAKE_FRAME_REFERENCE_OFFSET_X
+#define SCREEN_OFFSET_Y SNOWFLAKE_FRAME_REFERENCE_OFFSET_Y
+
+// ===================================================================
+// Function: Map logical hex cell to screen center pixel
+// Flat-top hexagons: odd columns are offset downward by HEX_HEIGHT/2
+// ===================================================================
+static void get_hex_center_pixel(int hex_x, int hex_y, int* pixel_x, int* pixel_y) {
+    *pixel_x = SCREEN_OFFSET_X + hex_x * HEX_WIDTH;
+    *pixel_y = SCREEN_OFFSET_Y + hex_y * HEX_HEIGHT;
+    
+    // Offset odd columns downward for hexagonal packing
+    if(hex_x % 2 == 1) {
+        *pixel_y += HEX_HEIGHT / 2;
+    }
+}
+
+// ===================================================================
+// Function: Fill hexagonal cell
+// Draws a 5x3 flat-top hexagon pattern:
+//   0,X,X,X,0
+//   X,X,C,X,X
+//   0,X,X,X,0
+// Center pixel C is at row 1, col 2 (middle of pattern)
+// ===================================================================
+static void fill_hex_cell(Canvas* canvas, int center_px, int center_py, bool filled) {
+    // Row 0: 0,X,X,X,0 (offset -1 from center)
+    if(filled) {
+        canvas_draw_dot(canvas, center_px - 1, center_py - 1);
+        canvas_draw_dot(canvas, center_px, center_py - 1);
+        canvas_draw_dot(canvas, center_px + 1, center_py - 1);
+    }
+    
+    // Row 1: X,X,C,X,X (center row, offset 0)
+    if(filled) {
+        canvas_draw_dot(canvas, center_px - 2, center_py);
+        canvas_draw_dot(canvas, center_px - 1, center_py);
+        canvas_draw_dot(canvas, center_px, center_py);      // C = center pixel
+        canvas_draw_dot(canvas, center_px + 1, center_py);
+        canvas_draw_dot(canvas, center_px + 2, center_py);
+    } else {
+        // Always draw center pixel even when not filled (for grid visualization)
+        canvas_draw_dot(canvas, center_px, center_py);
+    }
+    
+    // Row 2: 0,X,X,X,0 (offset +1 from center)
+    if(filled) {
+        canvas_draw_dot(canvas, center_px - 1, center_py + 1);
+        canvas_draw_dot(canvas, center_px, center_py + 1);
+        canvas_draw_dot(canvas, center_px + 1, center_py + 1);
+    }
+}
+
+// ===================================================================
+// Function: Draw all hexagonal cells
+// ===================================================================
+void snowflake_frame_reference_draw(Canvas* canvas, int size, const uint8_t* frozen) {
+    for(int y = 0; y < size; y++) {
+        for(int x = 0; x < size; x++) {
+            int px, py;
+            get_hex_center_pixel(x, y, &px, &py);
+            
+            // Check bounds
+            if(px >= 48 && px < 128 && py >= 0 && py < 64) {
+                bool is_frozen = frozen[y * size + x];
+                fill_hex_cell(canvas, px, py, is_frozen);
+            }
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+// ===================================================================
+// Reference renderer of the hex grid
+//
+// A frozen copy of the original dot-by-dot drawing from snowflake.c
+// (get_hex_center_pixel, fill_hex_cell and the loop of the draw
+// callback), kept deliberately simple and never optimized. The cached
+// frame bitmap is checked against it with render_bench.
+// ===================================================================
+#include <stdint.h>
+#include <gui/canvas.h>
+
+#define SNOWFLAKE_FRAME_REFERENCE_HEX_WIDTH 5   // The original 5x3 flat-top hexagon
+#define SNOWFLAKE_FRAME_REFERENCE_HEX_HEIGHT 3
+#define SNOWFLAKE_FRAME_REFERENCE_OFFSET_X 48   // Cell (0, 0) is centered on this screen pixel
+#define SNOWFLAKE_FRAME_REFERENCE_OFFSET_Y 0
+
+/** Draw every cell of a size x size lattice with one canvas_draw_dot
+ * per pixel, as the original app did: frozen cells as a full hexagon,
+ * the others as their center pixel.
+ */
+void snowflake_frame_reference_draw(Canvas* canvas, int size, const uint8_t* frozen);
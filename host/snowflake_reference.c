@@ -0,0 +1,184 @@
+// Includes
+#include "snowflake_reference.h"
+#include <stdlib.h>         // malloc, free
+#include <string.h>         // memcpy
+
+// ===================================================================
+// Do not optimize anything in this file: it defines the behavior every
+// other kernel is compared against.
+// ===================================================================
+
+static inline int get_index(const SnowflakeReference* ref, int x, int y) {
+    return y * ref->size + x;
+}
+
+// ===================================================================
+// Function: Get hexagonal neighbors for flat-top hexagons
+// Using "odd-q" vertical layout (odd columns shifted down)
+// ===================================================================
+static void get_hex_neighbors(int x, int y, int neighbors_x[6], int neighbors_y[6]) {
+    if(x % 2 == 0) {
+        neighbors_x[0] = x;      neighbors_y[0] = y - 1;  // N
+        neighbors_x[1] = x + 1;  neighbors_y[1] = y - 1;  // NE
+        neighbors_x[2] = x + 1;  neighbors_y[2] = y;      // SE
+        neighbors_x[3] = x;      neighbors_y[3] = y + 1;  // S
+        neighbors_x[4] = x - 1;  neighbors_y[4] = y;      // SW
+        neighbors_x[5] = x - 1;  neighbors_y[5] = y - 1;  // NW
+    } else {
+        neighbors_x[0] = x;      neighbors_y[0] = y - 1;  // N
+        neighbors_x[1] = x + 1;  neighbors_y[1] = y;      // NE
+        neighbors_x[2] = x + 1;  neighbors_y[2] = y + 1;  // SE
+        neighbors_x[3] = x;      neighbors_y[3] = y + 1;  // S
+        neighbors_x[4] = x - 1;  neighbors_y[4] = y + 1;  // SW
+        neighbors_x[5] = x - 1;  neighbors_y[5] = y;      // NW
+    }
+}
+
+// ===================================================================
+// Function: Check if cell is boundary cell
+// ===================================================================
+static bool is_boundary_cell(const SnowflakeReference* ref, int x, int y) {
+    int size = ref->size;
+    if(ref->frozen[get_index(ref, x, y)]) return false;
+    if(x < 2 || x >= size - 2 || y < 2 || y >= size - 2) return false;
+    
+    int neighbors_x[6], neighbors_y[6];
+    get_hex_neighbors(x, y, neighbors_x, neighbors_y);
+    
+    for(int i = 0; i < 6; i++) {
+        int nx = neighbors_x[i];
+        int ny = neighbors_y[i];
+        if(nx >= 0 && nx < size && ny >= 0 && ny < size) {
+            if(ref->frozen[get_index(ref, nx, ny)]) return true;
+        }
+    }
+    return false;
+}
+
+SnowflakeReference* snowflake_reference_alloc(int size, const SnowflakeParams* params) {
+    SnowflakeReference* ref = malloc(sizeof(SnowflakeReference));
+    if(!ref) return NULL;
+    
+    size_t cells = (size_t)size * size;
+    ref->size = size;
+    ref->params = *params;
+    ref->s = malloc(cells * sizeof(float));
+    ref->u = malloc(cells * sizeof(float));
+    ref->frozen = malloc(cells * sizeof(uint8_t));
+    if(!ref->s || !ref->u || !ref->frozen) {
+        snowflake_reference_free(ref);
+        return NULL;
+    }
+    
+    snowflake_reference_reset(ref);
+    return ref;
+}
+
+void snowflake_reference_free(SnowflakeReference* ref) {
+    if(!ref) return;
+    free(ref->s);
+    free(ref->u);
+    free(ref->frozen);
+    free(ref);
+}
+
+void snowflake_reference_reset(SnowflakeReference* ref) {
+    for(int i = 0; i < ref->size * ref->size; i++) {
+        ref->s[i] = ref->params.beta;
+        ref->u[i] = 0.0f;
+        ref->frozen[i] = 0;
+    }
+    
+    int center = ref->size / 2;
+    int center_idx = get_index(ref, center, center);
+    ref->s[center_idx] = 1.0f;
+    ref->frozen[center_idx] = 1;
+    ref->step = 0;
+}
+
+int snowflake_reference_step(SnowflakeReference* ref) {
+    int size = ref->size;
+    int cells = size * size;
+    float* u_new = malloc(cells * sizeof(float));
+    float* s_new = malloc(cells * sizeof(float));
+    uint8_t* frozen_new = malloc(cells * sizeof(uint8_t));
+    if(!u_new || !s_new || !frozen_new) {
+        free(u_new);
+        free(s_new);
+        free(frozen_new);
+        return -1;
+    }
+    
+    // Step 1: Classify cells and set u values
+    for(int y = 0; y < size; y++) {
+        for(int x = 0; x < size; x++) {
+            int idx = get_index(ref, x, y);
+            bool is_receptive = ref->frozen[idx] || is_boundary_cell(ref, x, y);
+            ref->u[idx] = is_receptive ? 0.0f : ref->s[idx];
+        }
+    }
+    
+    // Step 2: Diffusion
+    for(int y = 0; y < size; y++) {
+        for(int x = 0; x < size; x++) {
+            int idx = get_index(ref, x, y);
+            if(x < 2 || x >= size - 2 || y < 2 || y >= size - 2) {
+                u_new[idx] = ref->params.beta;
+                continue;
+            }
+            
+            int neighbors_x[6], neighbors_y[6];
+            get_hex_neighbors(x, y, neighbors_x, neighbors_y);
+            
+            float sum = 0.0f;
+            int count = 0;
+            for(int i = 0; i < 6; i++) {
+                int nx = neighbors_x[i];
+                int ny = neighbors_y[i];
+                if(nx >= 0 && nx < size && ny >= 0 && ny < size) {
+                    sum += ref->u[get_index(ref, nx, ny)];
+                    count++;
+                }
+            }
+            
+            float avg = (count > 0) ? (sum / count) : ref->u[idx];
+            u_new[idx] = ref->u[idx] + (ref->params.alpha / 2.0f) * (avg - ref->u[idx]);
+        }
+    }
+    memcpy(ref->u, u_new, cells * sizeof(float));
+    
+    // Step 3: Two-phase update of s and the frozen mask
+    memcpy(frozen_new, ref->frozen, cells * sizeof(uint8_t));
+    int frozen_count = 0;
+    
+    for(int y = 0; y < size; y++) {
+        for(int x = 0; x < size; x++) {
+            int idx = get_index(ref, x, y);
+            if(x < 2 || x >= size - 2 || y < 2 || y >= size - 2) {
+                s_new[idx] = ref->params.beta;
+                frozen_new[idx] = 0;
+                continue;
+            }
+            
+            bool is_receptive = ref->frozen[idx] || is_boundary_cell(ref, x, y);
+            if(is_receptive) {
+                s_new[idx] = ref->u[idx] + ref->s[idx] + ref->params.gamma;
+                if(!ref->frozen[idx] && s_new[idx] >= 1.0f) {
+                    frozen_new[idx] = 1;
+                    frozen_count++;
+                }
+            } else {
+                s_new[idx] = ref->u[idx];
+            }
+        }
+    }
+    
+    memcpy(ref->s, s_new, cells * sizeof(float));
+    memcpy(ref->frozen, frozen_new, cells * sizeof(uint8_t));
+    free(u_new);
+    free(s_new);
+    free(frozen_new);
+    
+    ref->step++;
+    return frozen_count;
+}
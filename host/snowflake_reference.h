@@ -0,0 +1,31 @@
+#pragma once
+
+// ===================================================================
+// Reference implementation of the Reiter step
+//
+// A frozen copy of the original grow_snowflake() from snowflake.c,
+// kept deliberately simple and never optimized. Faster kernels are
+// checked against it with diff_kernels.
+// ===================================================================
+#include <stdbool.h>
+#include <stdint.h>
+#include "snowflake_model.h"
+
+typedef struct {
+    int size;
+    SnowflakeParams params;
+    float* s;
+    float* u;
+    uint8_t* frozen;
+    int step;
+} SnowflakeReference;
+
+SnowflakeReference* snowflake_reference_alloc(int size, const SnowflakeParams* params);
+
+void snowflake_reference_free(SnowflakeReference* ref);
+
+/** Reset to the seed: all cells at beta, the center cell frozen */
+void snowflake_reference_reset(SnowflakeReference* ref);
+
+/** Advance one step. Returns the number of cells that froze. */
+int snowflake_reference_step(SnowflakeReference* ref);
@@ -0,0 +1,322 @@
+// Includes
+#include "canvas_stub.h"
+#include "gui/elements.h"
+#include "mitzi_snowflake_icons.h"
+#include <stdlib.h>         // calloc, free
+#include <string.h>         // memset, strlen
+
+// ===================================================================
+// Stub Canvas: a 128x64 raster plus primitive call counters
+// ===================================================================
+struct Canvas {
+    uint8_t pixels[CANVAS_STUB_HEIGHT][CANVAS_STUB_WIDTH];
+    Color color;
+    Font font;
+    uint32_t calls[CANVAS_CALL_COUNT];
+};
+
+static const char* const call_names[CANVAS_CALL_COUNT] = {
+    "clear", "dot", "line", "box", "frame", "xbm", "icon", "str", "element",
+};
+
+// ===================================================================
+// 3x5 font for 0x20..0x5F, one row of three bits after the other,
+// top row in the high bits. Lower case is drawn as upper case.
+// ===================================================================
+#define GLYPH_WIDTH 3
+#define GLYPH_HEIGHT 5
+
+static const uint16_t font_3x5[] = {
+    0x0000, // ' '
+    0x2482, // '!'
+    0x5A00, // '"'
+    0x5F7D, // '#'
+    0x3C9E, // '$'
+    0x52A5, // '%'
+    0x2AAB, // '&'
+    0x2400, // "'"
+    0x1491, // '('
+    0x4494, // ')'
+    0x0AA8, // '*'
+    0x05D0, // '+'
+    0x0014, // ','
+    0x01C0, // '-'
+    0x0002, // '.'
+    0x12A4, // '/'
+    0x7B6F, // '0'
+    0x2C97, // '1'
+    0x62A7, // '2'
+    0x628E, // '3'
+    0x5BC9, // '4'
+    0x798E, // '5'
+    0x39EF, // '6'
+    0x7292, // '7'
+    0x7BEF, // '8'
+    0x7BCE, // '9'
+    0x0410, // ':'
+    0x0414, // ';'
+    0x1511, // '<'
+    0x0E38, // '='
+    0x4454, // '>'
+    0x6282, // '?'
+    0x2BE3, // '@'
+    0x2BED, // 'A'
+    0x6BAE, // 'B'
+    0x3923, // 'C'
+    0x6B6E, // 'D'
+    0x79A7, // 'E'
+    0x79A4, // 'F'
+    0x396B, // 'G'
+    0x5BED, // 'H'
+    0x7497, // 'I'
+    0x126A, // 'J'
+    0x5BAD, // 'K'
+    0x4927, // 'L'
+    0x5FED, // 'M'
+    0x5FFD, // 'N'
+    0x2B6A, // 'O'
+    0x6BA4, // 'P'
+    0x2B7B, // 'Q'
+    0x6BAD, // 'R'
+    0x388E, // 'S'
+    0x7492, // 'T'
+    0x5B6B, // 'U'
+    0x5B52, // 'V'
+    0x5BFD, // 'W'
+    0x5AAD, // 'X'
+    0x5A92, // 'Y'
+    0x72A7, // 'Z'
+    0x6926, // '['
+    0x4889, // backslash
+    0x324B, // ']'
+    0x2A00, // '^'
+    0x0007, // '_'
+};
+
+// ===================================================================
+// Icons, converted from images/*.png
+// ===================================================================
+static const uint8_t icon_10x10_bits[] = {
+    0x28, 0x00, 0x92, 0x00, 0x54, 0x00, 0xBA, 0x00, 0x10,
+    0x00, 0xBA, 0x00, 0x54, 0x00, 0x92, 0x00, 0x28, 0x00, 0x00, 0x00,
+};
+const Icon I_icon_10x10 = {.width = 10, .height = 10, .bits = icon_10x10_bits};
+
+static const uint8_t back_bits[] = {0x0C, 0x06, 0x3F, 0x46, 0x4C, 0x40, 0x3E};
+const Icon I_back = {.width = 7, .height = 7, .bits = back_bits};
+
+// Firmware asset used by elements_button_center
+static const uint8_t button_center_bits[] = {0x1C, 0x22, 0x5D, 0x5D, 0x5D, 0x22, 0x1C};
+static const Icon I_ButtonCenter_7x7 = {.width = 7, .height = 7, .bits = button_center_bits};
+
+// ===================================================================
+// Function: Set one pixel in the current color, clipped to the screen
+// ===================================================================
+static inline void put_pixel(Canvas* canvas, int32_t x, int32_t y) {
+    if(x < 0 || x >= CANVAS_STUB_WIDTH || y < 0 || y >= CANVAS_STUB_HEIGHT) return;
+    uint8_t* pixel = &canvas->pixels[y][x];
+    if(canvas->color == ColorXOR) {
+        *pixel ^= 1;
+    } else {
+        *pixel = (canvas->color == ColorBlack);
+    }
+}
+
+static void fill_rect(Canvas* canvas, int32_t x, int32_t y, int32_t width, int32_t height) {
+    for(int32_t j = 0; j < height; j++) {
+        for(int32_t i = 0; i < width; i++) put_pixel(canvas, x + i, y + j);
+    }
+}
+
+static void blit_xbm(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height, const uint8_t* bitmap) {
+    size_t stride = (width + 7) / 8;
+    for(size_t j = 0; j < height; j++) {
+        for(size_t i = 0; i < width; i++) {
+            if(bitmap[j * stride + i / 8] & (1 << (i % 8))) put_pixel(canvas, x + (int32_t)i, y + (int32_t)j);
+        }
+    }
+}
+
+static int32_t glyph_advance(const Canvas* canvas) {
+    return canvas->font == FontPrimary ? GLYPH_WIDTH + 2 : GLYPH_WIDTH + 1;
+}
+
+// ===================================================================
+// Host-only accessors
+// ===================================================================
+Canvas* canvas_stub_alloc(void) {
+    Canvas* canvas = calloc(1, sizeof(Canvas));
+    if(canvas) canvas->color = ColorBlack;
+    return canvas;
+}
+
+void canvas_stub_free(Canvas* canvas) {
+    free(canvas);
+}
+
+const uint8_t* canvas_stub_pixels(const Canvas* canvas) {
+    return &canvas->pixels[0][0];
+}
+
+const uint32_t* canvas_stub_calls(const Canvas* canvas) {
+    return canvas->calls;
+}
+
+void canvas_stub_reset_calls(Canvas* canvas) {
+    memset(canvas->calls, 0, sizeof(canvas->calls));
+}
+
+const char* canvas_stub_call_name(CanvasStubCall call) {
+    return call < CANVAS_CALL_COUNT ? call_names[call] : "?";
+}
+
+// ===================================================================
+// Canvas API
+// ===================================================================
+size_t canvas_width(const Canvas* canvas) {
+    (void)canvas;
+    return CANVAS_STUB_WIDTH;
+}
+
+size_t canvas_height(const Canvas* canvas) {
+    (void)canvas;
+    return CANVAS_STUB_HEIGHT;
+}
+
+void canvas_clear(Canvas* canvas) {
+    canvas->calls[CANVAS_CALL_CLEAR]++;
+    memset(canvas->pixels, 0, sizeof(canvas->pixels));
+}
+
+void canvas_set_color(Canvas* canvas, Color color) {
+    canvas->color = color;
+}
+
+void canvas_invert_color(Canvas* canvas) {
+    if(canvas->color == ColorBlack) {
+        canvas->color = ColorWhite;
+    } else if(canvas->color == ColorWhite) {
+        canvas->color = ColorBlack;
+    }
+}
+
+void canvas_set_font(Canvas* canvas, Font font) {
+    canvas->font = font;
+}
+
+void canvas_draw_dot(Canvas* canvas, int32_t x, int32_t y) {
+    canvas->calls[CANVAS_CALL_DOT]++;
+    put_pixel(canvas, x, y);
+}
+
+void canvas_draw_line(Canvas* canvas, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    canvas->calls[CANVAS_CALL_LINE]++;
+    
+    // Bresenham
+    int32_t dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+    int32_t dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+    int32_t err = dx + dy;
+    while(true) {
+        put_pixel(canvas, x1, y1);
+        if(x1 == x2 && y1 == y2) break;
+        int32_t e2 = 2 * err;
+        if(e2 >= dy) {
+            err += dy;
+            x1 += sx;
+        }
+        if(e2 <= dx) {
+            err += dx;
+            y1 += sy;
+        }
+    }
+}
+
+void canvas_draw_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    canvas->calls[CANVAS_CALL_BOX]++;
+    fill_rect(canvas, x, y, (int32_t)width, (int32_t)height);
+}
+
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    canvas->calls[CANVAS_CALL_FRAME]++;
+    int32_t w = (int32_t)width, h = (int32_t)height;
+    if(w <= 0 || h <= 0) return;
+    fill_rect(canvas, x, y, w, 1);
+    fill_rect(canvas, x, y + h - 1, w, 1);
+    fill_rect(canvas, x, y + 1, 1, h - 2);
+    fill_rect(canvas, x + w - 1, y + 1, 1, h - 2);
+}
+
+void canvas_draw_xbm(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height, const uint8_t* bitmap) {
+    canvas->calls[CANVAS_CALL_XBM]++;
+    blit_xbm(canvas, x, y, width, height, bitmap);
+}
+
+void canvas_draw_icon(Canvas* canvas, int32_t x, int32_t y, const Icon* icon) {
+    canvas->calls[CANVAS_CALL_ICON]++;
+    blit_xbm(canvas, x, y, icon->width, icon->height, icon->bits);
+}
+
+uint16_t canvas_string_width(Canvas* canvas, const char* str) {
+    return (uint16_t)(strlen(str) * glyph_advance(canvas));
+}
+
+void canvas_draw_str(Canvas* canvas, int32_t x, int32_t y, const char* str) {
+    canvas->calls[CANVAS_CALL_STR]++;
+    bool bold = canvas->font == FontPrimary;
+    
+    for(; *str; str++, x += glyph_advance(canvas)) {
+        char c = *str;
+        if(c >= 'a' && c <= 'z') c = (char)(c - 'a' + 'A');
+        if(c < 0x20 || c > 0x5F) c = '?';
+        uint16_t glyph = font_3x5[c - 0x20];
+        
+        for(int row = 0; row < GLYPH_HEIGHT; row++) {
+            for(int col = 0; col < GLYPH_WIDTH; col++) {
+                if(!(glyph & (1 << ((GLYPH_HEIGHT - 1 - row) * GLYPH_WIDTH + (GLYPH_WIDTH - 1 - col))))) continue;
+                int32_t px = x + col, py = y - (GLYPH_HEIGHT - 1) + row;
+                put_pixel(canvas, px, py);
+                if(bold) put_pixel(canvas, px + 1, py);
+            }
+        }
+    }
+}
+
+void canvas_draw_str_aligned(
+    Canvas* canvas, int32_t x, int32_t y, Align horizontal, Align vertical, const char* str) {
+    int32_t width = canvas_string_width(canvas, str);
+    if(horizontal == AlignRight) x -= width;
+    if(horizontal == AlignCenter) x -= width / 2;
+    if(vertical == AlignTop) y += GLYPH_HEIGHT;
+    if(vertical == AlignCenter) y += GLYPH_HEIGHT / 2;
+    canvas_draw_str(canvas, x, y, str);
+}
+
+// ===================================================================
+// Function: Center button hint, same geometry as the firmware's
+// ===================================================================
+void elements_button_center(Canvas* canvas, const char* str) {
+    canvas->calls[CANVAS_CALL_ELEMENT]++;
+    
+    const int32_t button_height = 12;
+    const int32_t vertical_offset = 3;
+    const int32_t horizontal_offset = 1;
+    const int32_t string_width = canvas_string_width(canvas, str);
+    const Icon* icon = &I_ButtonCenter_7x7;
+    const int32_t icon_width_with_offset = icon->width + 3;
+    const int32_t icon_v_offset = icon->height + vertical_offset;
+    const int32_t button_width = string_width + horizontal_offset * 2 + icon_width_with_offset;
+    
+    const int32_t x = ((int32_t)canvas_width(canvas) - button_width) / 2;
+    const int32_t y = (int32_t)canvas_height(canvas);
+    
+    canvas_draw_box(canvas, x, y - button_height, button_width, button_height);
+    for(int32_t i = 0; i < 3; i++) {
+        canvas_draw_line(canvas, x - 1 - i, y, x - 1 - i, y - button_height + i);
+        canvas_draw_line(canvas, x + button_width + i, y, x + button_width + i, y - button_height + i);
+    }
+    
+    canvas_invert_color(canvas);
+    canvas_draw_icon(canvas, x + horizontal_offset, y - icon_v_offset, icon);
+    canvas_draw_str(canvas, x + horizontal_offset + icon_width_with_offset, y - vertical_offset, str);
+    canvas_invert_color(canvas);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+// ===================================================================
+// Host-only side of the stub Canvas: allocation, the raster and the
+// primitive call counters
+// ===================================================================
+#include <stdint.h>
+#include <gui/canvas.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CANVAS_STUB_WIDTH 128
+#define CANVAS_STUB_HEIGHT 64
+
+typedef enum {
+    CANVAS_CALL_CLEAR,
+    CANVAS_CALL_DOT,
+    CANVAS_CALL_LINE,
+    CANVAS_CALL_BOX,
+    CANVAS_CALL_FRAME,
+    CANVAS_CALL_XBM,
+    CANVAS_CALL_ICON,
+    CANVAS_CALL_STR,
+    CANVAS_CALL_ELEMENT,  // elements_* helpers; their own primitives are counted too
+    CANVAS_CALL_COUNT
+} CanvasStubCall;
+
+Canvas* canvas_stub_alloc(void);
+void canvas_stub_free(Canvas* canvas);
+
+/** One byte per pixel, row-major, 1 = black */
+const uint8_t* canvas_stub_pixels(const Canvas* canvas);
+
+/** Calls per primitive since the last reset */
+const uint32_t* canvas_stub_calls(const Canvas* canvas);
+void canvas_stub_reset_calls(Canvas* canvas);
+const char* canvas_stub_call_name(CanvasStubCall call);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,72 @@
+#pragma once
+
+// ===================================================================
+// Host stand-in for the firmware's gui/canvas.h
+//
+// Only the part of the Canvas API the app's screens use. Drawing goes
+// into a 128x64 1-bit raster and every primitive call is counted; see
+// canvas_stub.h for the host-only accessors. Text is drawn with a
+// built-in 3x5 font, so string positions and lengths are checked, not
+// the firmware's glyph shapes.
+// ===================================================================
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Canvas Canvas;
+
+typedef struct Icon {
+    uint8_t width;
+    uint8_t height;
+    const uint8_t* bits;  // XBM: rows padded to bytes, LSB first
+} Icon;
+
+typedef enum {
+    ColorWhite,
+    ColorBlack,
+    ColorXOR,
+} Color;
+
+typedef enum {
+    FontPrimary,
+    FontSecondary,
+    FontKeyboard,
+    FontBigNumbers,
+} Font;
+
+typedef enum {
+    AlignLeft,
+    AlignRight,
+    AlignTop,
+    AlignBottom,
+    AlignCenter,
+} Align;
+
+size_t canvas_width(const Canvas* canvas);
+size_t canvas_height(const Canvas* canvas);
+
+void canvas_clear(Canvas* canvas);
+void canvas_set_color(Canvas* canvas, Color color);
+void canvas_invert_color(Canvas* canvas);
+void canvas_set_font(Canvas* canvas, Font font);
+
+void canvas_draw_dot(Canvas* canvas, int32_t x, int32_t y);
+void canvas_draw_line(Canvas* canvas, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+void canvas_draw_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height);
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height);
+void canvas_draw_xbm(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height, const uint8_t* bitmap);
+void canvas_draw_icon(Canvas* canvas, int32_t x, int32_t y, const Icon* icon);
+
+/** y is the baseline */
+void canvas_draw_str(Canvas* canvas, int32_t x, int32_t y, const char* str);
+void canvas_draw_str_aligned(
+    Canvas* canvas, int32_t x, int32_t y, Align horizontal, Align vertical, const char* str);
+uint16_t canvas_string_width(Canvas* canvas, const char* str);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+
+// ===================================================================
+// Host stand-in for the firmware's gui/elements.h
+// ===================================================================
+#include <gui/canvas.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Button hint at the bottom center, drawn like the firmware's */
+void elements_button_center(Canvas* canvas, const char* str);
+
+#ifdef __cplusplus
+}
+#endif
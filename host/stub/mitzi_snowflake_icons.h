@@ -0,0 +1,9 @@
+#pragma once
+
+// ===================================================================
+// Host stand-in for the icon header fbt generates from images/
+// ===================================================================
+#include <gui/canvas.h>
+
+extern const Icon I_icon_10x10;
+extern const Icon I_back;
@@ -0,0 +1,80 @@
+// Includes
+#include <stdio.h>          // printf, fopen
+#include <string.h>         // memcmp, memcpy
+#include "snowflake_trace.h"
+
+// ===================================================================
+// Decode a binary trace (trace.bin from the app data folder on the SD
+// card, or snowflake_cli -T) into CSV, one line per record.
+// ===================================================================
+
+static const char* type_name(uint8_t type) {
+    switch(type) {
+    case SNOWFLAKE_TRACE_STEP:
+        return "step";
+    case SNOWFLAKE_TRACE_RESET:
+        return "reset";
+    case SNOWFLAKE_TRACE_PARAMS:
+        return "params";
+    default:
+        return "?";
+    }
+}
+
+static float value_float(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+int main(int argc, char** argv) {
+    if(argc != 2) {
+        fprintf(stderr, "Usage: %s trace.bin\n", argv[0]);
+        return 1;
+    }
+    
+    FILE* file = fopen(argv[1], "rb");
+    if(!file) {
+        perror(argv[1]);
+        return 1;
+    }
+    
+    uint8_t header[SNOWFLAKE_TRACE_HEADER_SIZE];
+    if(fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, "SFTR", 4) != 0 ||
+       snowflake_get_u16(header + 4) != SNOWFLAKE_TRACE_VERSION ||
+       snowflake_get_u16(header + 6) != SNOWFLAKE_TRACE_RECORD_SIZE) {
+        fprintf(stderr, "%s: not a version %d trace\n", argv[1], SNOWFLAKE_TRACE_VERSION);
+        fclose(file);
+        return 1;
+    }
+    double ticks_per_us = snowflake_get_u32(header + 8);
+    uint32_t count = snowflake_get_u32(header + 12);
+    
+    printf("type,source,step,time_us,frozen,frozen_total,step_us,alpha,beta,gamma\n");
+    uint8_t data[SNOWFLAKE_TRACE_RECORD_SIZE];
+    uint32_t first_time = 0;
+    for(uint32_t i = 0; i < count; i++) {
+        if(fread(data, 1, sizeof(data), file) != sizeof(data)) {
+            fprintf(stderr, "%s: truncated after %u records\n", argv[1], (unsigned)i);
+            fclose(file);
+            return 1;
+        }
+        SnowflakeTraceRecord record;
+        snowflake_trace_decode(data, &record);
+        if(i == 0) first_time = record.time;
+        
+        printf("%s,%s,%u,%.1f,", type_name(record.type),
+               record.source == SNOWFLAKE_TRACE_PREVIEW ? "preview" : "manual",
+               (unsigned)record.step, (uint32_t)(record.time - first_time) / ticks_per_us);
+        if(record.type == SNOWFLAKE_TRACE_STEP) {
+            printf("%u,%u,%.1f,,,\n", (unsigned)record.count, (unsigned)record.value[0],
+                   record.value[1] / ticks_per_us);
+        } else {
+            printf(",,,%.3f,%.3f,%.4f\n", (double)value_float(record.value[0]),
+                   (double)value_float(record.value[1]), (double)value_float(record.value[2]));
+        }
+    }
+    
+    fclose(file);
+    return 0;
+}
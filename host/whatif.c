@@ -0,0 +1,252 @@
+// Includes
+#include <stdio.h>          // printf
+#include <stdlib.h>         // strtol, strtof, malloc
+#include <string.h>         // strcmp, memcmp
+#include "host_util.h"
+#include "snowflake_kernels.h"
+#include "snowflake_model.h"
+#include "snowflake_presets.h"
+#include "snowflake_tiles.h"
+
+// ===================================================================
+// Host check of copy-on-write forks (snowflake_tiles.c)
+//
+// Grows a flake, captures it as tiles and forks one branch per value
+// of a parameter. Every branch is loaded into the same working model,
+// grown further and stored back into its fork after each step, the way
+// a what-if comparison runs on the Flipper. Each branch is checked
+// against the same growth on a plain copy of the model (frozen mask,
+// age map, statistics, s of the liquid cells), and the base state
+// must be unchanged at the end. Reports the memory the forks share.
+// Exit code is 1 on any mismatch.
+// ===================================================================
+
+#define DEFAULT_BRANCHES 4
+#define DEFAULT_THEN 50
+#define MAX_BRANCHES 32
+
+typedef struct {
+    int size;
+    int steps;  // Shared growth before the fork
+    int then;   // Growth of every branch after it
+    const char* preset;
+    const char* kernel;
+    const char* param;
+    float delta;  // Parameter change from one branch to the next
+    int branches;
+} WhatifConfig;
+
+// ===================================================================
+// Function: Compare two models; s only for liquid cells
+// ===================================================================
+static bool models_match(const SnowflakeModel* a, const SnowflakeModel* b) {
+    size_t cells = (size_t)snowflake_model_get_size(a) * snowflake_model_get_size(a);
+    const uint8_t* frozen = snowflake_model_get_frozen(a);
+    const float* s_a = snowflake_model_get_s(a);
+    const float* s_b = snowflake_model_get_s(b);
+    
+    if(snowflake_model_get_step(a) != snowflake_model_get_step(b)) return false;
+    if(memcmp(frozen, snowflake_model_get_frozen(b), cells) != 0) return false;
+    if(memcmp(snowflake_model_get_freeze_steps(a), snowflake_model_get_freeze_steps(b), cells * sizeof(uint16_t)) != 0) {
+        return false;
+    }
+    if(memcmp(snowflake_model_get_stats(a), snowflake_model_get_stats(b), sizeof(SnowflakeStats)) != 0) return false;
+    for(size_t i = 0; i < cells; i++) {
+        if(!frozen[i] && memcmp(&s_a[i], &s_b[i], sizeof(float)) != 0) return false;
+    }
+    return true;
+}
+
+// ===================================================================
+// Function: Parameters of branch k
+// ===================================================================
+static bool branch_params(const WhatifConfig* config, const SnowflakeParams* base, int k, SnowflakeParams* params) {
+    *params = *base;
+    float offset = config->delta * k;
+    if(strcmp(config->param, "alpha") == 0) {
+        params->alpha += offset;
+    } else if(strcmp(config->param, "beta") == 0) {
+        params->beta += offset;
+    } else if(strcmp(config->param, "gamma") == 0) {
+        params->gamma += offset;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -n size          lattice size (default 64)\n"
+            "  -s steps         shared growth before the fork (default 200)\n"
+            "  --then M         growth of every branch after the fork (default %d)\n"
+            "  --preset NAME    parameters (default dendritic)\n"
+            "  --kernel NAME    step kernel (default: the registry default)\n"
+            "  --branches K     branches, the first with unchanged parameters (default %d, max %d)\n"
+            "  --param NAME     parameter the branches differ in: alpha, beta, gamma (default gamma)\n"
+            "  --delta D        change from one branch to the next (default 0.001)\n",
+            name, DEFAULT_THEN, DEFAULT_BRANCHES, MAX_BRANCHES);
+}
+
+int main(int argc, char** argv) {
+    WhatifConfig config = {
+        .size = 64,
+        .steps = 200,
+        .then = DEFAULT_THEN,
+        .preset = "dendritic",
+        .kernel = NULL,
+        .param = "gamma",
+        .delta = 0.001f,
+        .branches = DEFAULT_BRANCHES,
+    };
+    
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if(!value) {
+            usage(argv[0]);
+            return 2;
+        }
+        if(strcmp(arg, "-n") == 0) {
+            config.size = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "-s") == 0) {
+            config.steps = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "--then") == 0) {
+            config.then = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "--preset") == 0) {
+            config.preset = value;
+        } else if(strcmp(arg, "--kernel") == 0) {
+            config.kernel = value;
+        } else if(strcmp(arg, "--branches") == 0) {
+            config.branches = (int)strtol(value, NULL, 10);
+        } else if(strcmp(arg, "--param") == 0) {
+            config.param = value;
+        } else if(strcmp(arg, "--delta") == 0) {
+            config.delta = strtof(value, NULL);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    
+    const SnowflakePreset* preset = snowflake_preset_find(config.preset);
+    const SnowflakeKernel* kernel = config.kernel ? snowflake_kernel_find(config.kernel) : snowflake_kernel_default();
+    SnowflakeParams check;
+    if(!preset || !kernel || config.size < 5 || config.steps < 0 || config.then < 0 || config.branches < 1 ||
+       config.branches > MAX_BRANCHES || !branch_params(&config, &preset->params, 0, &check)) {
+        usage(argv[0]);
+        return 2;
+    }
+    
+    // Shared growth; base keeps the plain copy to check against
+    SnowflakeModel* base = snowflake_model_alloc(config.size, &preset->params);
+    SnowflakeModel* work = snowflake_model_alloc(config.size, &preset->params);
+    SnowflakeModel* plain = snowflake_model_alloc(config.size, &preset->params);
+    if(!base || !work || !plain) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    snowflake_model_set_kernel(base, kernel);
+    snowflake_model_set_kernel(work, kernel);
+    snowflake_model_set_kernel(plain, kernel);
+    for(int i = 0; i < config.steps; i++) snowflake_model_step(base);
+    
+    SnowflakeTiles* root = snowflake_tiles_alloc(base);
+    SnowflakeTiles* forks[MAX_BRANCHES] = {0};
+    if(!root) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    
+    SnowflakeTilesUsage usage_root;
+    snowflake_tiles_get_usage(root, &usage_root);
+    printf("size=%d steps=%d then=%d preset=%s kernel=%s tile=%dx%d\n", config.size, config.steps, config.then,
+           config.preset, kernel->name, SNOWFLAKE_TILE, SNOWFLAKE_TILE);
+    printf("base: frozen=%d tiles=%d shared=%d bytes=%zu (unshared %zu)\n",
+           snowflake_model_get_stats(base)->frozen_total, usage_root.tiles, usage_root.shared, usage_root.bytes,
+           usage_root.unshared);
+    
+    // Fork all branches first, so they really share the base until they write
+    int64_t fork_ns = 0;
+    for(int k = 0; k < config.branches; k++) {
+        int64_t start = now_ns();
+        forks[k] = snowflake_tiles_fork(root);
+        fork_ns += now_ns() - start;
+        if(!forks[k]) {
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+    }
+    
+    int failures = 0;
+    int64_t store_ns = 0;
+    int stores = 0;
+    for(int k = 0; k < config.branches; k++) {
+        SnowflakeParams params;
+        branch_params(&config, &preset->params, k, &params);
+        
+        // The branch lives in its fork between steps, as if others ran in between
+        snowflake_tiles_load(forks[k], work);
+        snowflake_model_set_params(work, &params);
+        bool stored = snowflake_tiles_store(forks[k], work);
+        for(int i = 0; stored && i < config.then; i++) {
+            snowflake_tiles_load(forks[k], work);
+            snowflake_model_step(work);
+            int64_t start = now_ns();
+            stored = snowflake_tiles_store(forks[k], work);
+            store_ns += now_ns() - start;
+            stores++;
+        }
+        if(!stored) {
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+        
+        snowflake_model_copy(plain, base);
+        snowflake_model_set_params(plain, &params);
+        for(int i = 0; i < config.then; i++) snowflake_model_step(plain);
+        snowflake_tiles_load(forks[k], work);
+        bool match = models_match(work, plain);
+        if(!match) failures++;
+        
+        SnowflakeTilesUsage usage;
+        snowflake_tiles_get_usage(forks[k], &usage);
+        printf("branch %d: %s=%.4f frozen=%d shared=%d/%d bytes=%zu %s\n", k, config.param,
+               (double)(strcmp(config.param, "alpha") == 0 ? params.alpha :
+                        strcmp(config.param, "beta") == 0  ? params.beta :
+                                                             params.gamma),
+               snowflake_model_get_stats(work)->frozen_total, usage.shared, usage.tiles, usage.bytes,
+               match ? "match" : "DIFFERS");
+    }
+    
+    // The base must not have seen any of the branches' writes
+    snowflake_tiles_load(root, work);
+    bool base_intact = models_match(work, base);
+    if(!base_intact) {
+        printf("base state changed by a branch\n");
+        failures++;
+    }
+    
+    size_t total = 0;
+    snowflake_tiles_get_usage(root, &usage_root);
+    total += usage_root.bytes;
+    for(int k = 0; k < config.branches; k++) {
+        SnowflakeTilesUsage usage;
+        snowflake_tiles_get_usage(forks[k], &usage);
+        total += usage.bytes;
+    }
+    printf("total=%zu bytes for base and %d branches, %zu as full copies (%.0f%%)\n", total, config.branches,
+           usage_root.unshared * (size_t)(config.branches + 1),
+           100.0 * (double)total / (double)(usage_root.unshared * (size_t)(config.branches + 1)));
+    printf("fork=%.1f us store=%.1f us per step %s\n", (double)fork_ns / 1e3 / config.branches,
+           stores ? (double)store_ns / 1e3 / stores : 0.0, failures ? "FAILED" : "match");
+    
+    for(int k = 0; k < config.branches; k++) snowflake_tiles_free(forks[k]);
+    snowflake_tiles_free(root);
+    snowflake_model_free(base);
+    snowflake_model_free(work);
+    snowflake_model_free(plain);
+    return failures ? 1 : 0;
+}
@@ -1,312 +1,971 @@
 // Includes
 #include <furi.h>           // Furi OS core functionality
 #include <gui/gui.h>        // GUI system for drawing to the screen
-#include <gui/elements.h>   // GUI elements library for button hints and UI components
 #include <input/input.h>    // Input handling for button presses
 #include <stdlib.h>         // Standard library functions (malloc, calloc, etc.)
 #include <string.h>         // Memory and string manipulation functions
 #include <math.h>           // Math functions (sqrt, fmax, fmin)
 #include <furi_hal.h>       // Logging functionality
-#include "mitzi_snowflake_icons.h"
+#include <toolbox/version.h> // Firmware version for benchmark results
+#include "snowflake_config.h" // Grid size, parameter limits
+#include "snowflake_model.h" // Portable simulation core
+#include "snowflake_kernels.h" // Step kernel registry
+#include "snowflake_frame.h" // Cached grid bitmap
+#include "snowflake_screen.h" // Main screen layout
+#include "snowflake_profile.h" // DWT cycle counter timings
+#include "snowflake_latency.h" // Press-to-pixel latency
+#include "snowflake_trace.h"   // Binary trace ring buffer
+#include "snowflake_storage.h" // SD card files
+#include "snowflake_settings.h" // Settings file
+#include "snowflake_recording.h" // Session input recording
+#include "snowflake_bench.h"     // Fixed benchmark workload
+#include "snowflake_checkpoint.h" // Save / resume the flake
+#include "snowflake_growth.h"     // Growth recording for the demo
+#include "snowflake_history.h"    // Undo keyframes
+#include "snowflake_tiles.h"      // Copy-on-write state of the other branch
+#include "snowflake_gallery.h"    // Cache of grown flakes
+#include "snowflake_export.h"     // Image export
 
 // ===================================================================
 // Constants
 // ===================================================================
-#define GRID_SIZE 16        // Grid is 16x16 logical hex cells
-#define HEX_WIDTH 5         // Each hex cell is 5 pixels wide (flat-top)
-#define HEX_HEIGHT 3        // Each hex cell is 3 pixels tall (flat-top)
-#define SCREEN_OFFSET_X 48  // Draw on right side of screen
-#define SCREEN_OFFSET_Y 0   // Start at top
-
 #define TAG "Snowflake"
 
-// Parameter limits
-#define ALPHA_MIN 0.5f
-#define ALPHA_MAX 5.0f
-#define ALPHA_STEP 0.1f
-#define ALPHA_INIT 1.0f     // Initial alpha value
+// Hot path logging, compiled out of release builds; the binary trace covers it there
+#ifdef FURI_DEBUG
+#define DEBUG_LOG(...) FURI_LOG_D(TAG, __VA_ARGS__)
+#else
+#define DEBUG_LOG(...)
+#endif
+
+#define TRACE_PATH APP_DATA_PATH("trace.bin")
+#define SESSION_PATH APP_DATA_PATH("session.rec")
+#define BENCH_PATH APP_DATA_PATH("bench.csv")
+#define CHECKPOINT_PATH APP_DATA_PATH("checkpoint.bin")
+#define GROWTH_PATH APP_DATA_PATH("growth.sfg")
+#define GALLERY_DIR APP_DATA_PATH("gallery")
+#define GALLERY_INDEX_PATH APP_DATA_PATH("gallery/index.bin")
+#define EXPORT_PATH_FORMAT APP_DATA_PATH("flake_%d.%s") // Shown step, extension
+
+// Kernel autotuning, only rerun when the cached choice doesn't fit
+#define AUTOTUNE_WARMUP_STEPS 40 // Grow a typical crystal before timing
+#define AUTOTUNE_STEPS 10
 
-#define BETA_MIN 0.1f
-#define BETA_MAX 0.9f
-#define BETA_STEP 0.05f
-#define BETA_INIT 0.5f      // Initial beta value
+// Undo history; a multiple of PREVIEW_CHUNK_STEPS so published previews hit every keyframe
+#define HISTORY_KEYFRAME_STEPS 20
 
-#define GAMMA_MIN 0.001f
-#define GAMMA_MAX 0.1f
-#define GAMMA_STEP 0.005f
-#define GAMMA_INIT 0.01f    // Initial gamma value
+// Growth demo
+#define DEMO_FRAME_MS 33         // One recorded step per frame
+#define DEMO_DEFAULT_STEPS 200   // Recorded when the flake hasn't grown yet
+
+// Live preview
+#define PREVIEW_CHUNK_STEPS 5   // Steps per chunk; a stale run is dropped after at most one chunk
+#define PREVIEW_FLAG_RESTART (1UL << 0)
+#define PREVIEW_FLAG_EXIT (1UL << 1)
+#define PREVIEW_STACK_SIZE (3 * 1024)  // Reads and writes gallery files
 
 // ===================================================================
-// Parameter selection
+// Debug overlay pages, cycled by the debug tool
 // ===================================================================
 typedef enum {
-    PARAM_ALPHA,
-    PARAM_BETA,
-    PARAM_GAMMA,
-    PARAM_COUNT
-} ParamType;
+    DEBUG_OVERLAY_OFF,
+    DEBUG_OVERLAY_PROFILE,  // Step phase and draw timings
+    DEBUG_OVERLAY_LATENCY,  // Press-to-pixel latency percentiles
+    DEBUG_OVERLAY_COUNT
+} DebugOverlay;
+
+// ===================================================================
+// Input event as queued by the input callback
+// ===================================================================
+typedef struct {
+    InputEvent input;
+    uint32_t arrival;  // snowflake_profile_now() when the callback ran
+} SnowflakeInputEvent;
+
+// ===================================================================
+// Growth demo: a recording played back in a private model
+// ===================================================================
+typedef struct {
+    SnowflakeModel* model;
+    SnowflakeFrame* frame;
+    SnowflakeStorageFile* file;
+    SnowflakeGrowthPlayer player;
+} GrowthDemo;
+
+// ===================================================================
+// Gallery screen: one cached flake at a time in a private model
+// ===================================================================
+typedef struct {
+    int index;      // Shown entry, most recently used first
+    uint32_t id;    // Its file id once loaded
+    bool loaded;    // model holds the entry; only written without the lock while false
+    SnowflakeModel* model;
+    SnowflakeFrame* frame;
+} GalleryBrowser;
 
 // ===================================================================
 // Application State Structure
 // ===================================================================
 typedef struct {
-    float* s;        // State values (water content)
-    float* u;        // Non-frozen diffusing water
-    uint8_t* frozen; // Boolean: is cell frozen?
-    int step;
+    SnowflakeModel* model;  // Lattice fields, step counter and statistics
+    SnowflakeFrame* frame;  // Cached 1-bit bitmap of the grid area, updated as cells freeze
     
-    // Adjustable parameters
-    float alpha;     // Diffusion constant
-    float beta;      // Boundary vapor level
-    float gamma;     // Background vapor addition
+    SnowflakeParams params; // Adjustable parameters (alpha, beta, gamma)
     
     ParamType selected_param;  // Which parameter is being adjusted
+    ToolType selected_tool;    // Tool a short OK on the tool row runs
+    bool view_mode;            // Arrows pan and OK zooms instead of editing parameters
+    DebugOverlay debug_overlay; // Timing pages shown over the grid
+    bool bench_screen;         // Benchmark results shown over the grid
+    int bench_done;            // Lattice sizes of the benchmark finished so far
+    SnowflakeBenchResult bench[SNOWFLAKE_BENCH_SIZE_COUNT];
+    GrowthDemo* demo;          // Growth playback shown instead of the flake, NULL if off
+    GalleryBrowser* browser;   // Gallery screen shown instead of the flake, NULL if closed
     uint32_t back_press_timer; // For detecting long press
+    
+    FuriMutex* mutex;                      // Guards the fields above against the draw callback and preview worker
+    volatile uint32_t preview_generation;  // Bumped on every change that makes a running preview stale
+    
+    SnowflakeProfile profile;  // Rolling timings of manual steps and draws
+    SnowflakeLatency latency;  // Input events from callback to finished draw
+    
+    SnowflakeTrace* trace;              // Shared by the displayed and the preview state
+    SnowflakeHistory* history;          // Undo keyframes of the displayed flake, NULL without undo
+    SnowflakeTiles* other_branch;       // Flake the last branch left behind, NULL if none
+    SnowflakeGallery* gallery;          // Index of the cached flakes in GALLERY_DIR, NULL if off
+    SnowflakeTraceSource trace_source;  // Tags the records this state adds
 } SnowflakeState;
 
 // ===================================================================
-// Function: Get array index
+// Background preview worker
 // ===================================================================
-static inline int get_index(int x, int y) {
-    return y * GRID_SIZE + x;
-}
+typedef struct {
+    FuriThread* thread;
+    SnowflakeState* state;  // Displayed state, receives progressive results
+    SnowflakeState work;    // Private state the preview grows in
+    ViewPort* view_port;
+} PreviewWorker;
 
 // ===================================================================
-// Function: Map logical hex cell to screen center pixel
-// Flat-top hexagons: odd columns are offset downward by HEX_HEIGHT/2
+// Function: Allocate / free grid fields of a state
 // ===================================================================
-static void get_hex_center_pixel(int hex_x, int hex_y, int* pixel_x, int* pixel_y) {
-    *pixel_x = SCREEN_OFFSET_X + hex_x * HEX_WIDTH;
-    *pixel_y = SCREEN_OFFSET_Y + hex_y * HEX_HEIGHT;
+static bool alloc_grid(SnowflakeState* state) {
+    state->model = snowflake_model_alloc(GRID_SIZE, &state->params);
+    state->frame = malloc(sizeof(SnowflakeFrame));
     
-    // Offset odd columns downward for hexagonal packing
-    if(hex_x % 2 == 1) {
-        *pixel_y += HEX_HEIGHT / 2;
+    if(!state->model || !state->frame) {
+        if(state->model) snowflake_model_free(state->model);
+        if(state->frame) free(state->frame);
+        return false;
     }
+    
+    // Newly frozen cells are drawn into the frame as the model commits them
+    snowflake_frame_init(state->frame, state->model);
+    return true;
+}
+
+static void free_grid(SnowflakeState* state) {
+    snowflake_model_free(state->model);
+    free(state->frame);
 }
 
 // ===================================================================
-// Function: Fill hexagonal cell
-// Draws a 5x3 flat-top hexagon pattern:
-//   0,X,X,X,0
-//   X,X,C,X,X
-//   0,X,X,X,0
-// Center pixel C is at row 1, col 2 (middle of pattern)
+// Function: Copy grid fields, step counter and frame between states
 // ===================================================================
-static void fill_hex_cell(Canvas* canvas, int center_px, int center_py, bool filled) {
-    // Row 0: 0,X,X,X,0 (offset -1 from center)
-    if(filled) {
-        canvas_draw_dot(canvas, center_px - 1, center_py - 1);
-        canvas_draw_dot(canvas, center_px, center_py - 1);
-        canvas_draw_dot(canvas, center_px + 1, center_py - 1);
-    }
+static void copy_grid(SnowflakeState* dst, const SnowflakeState* src) {
+    snowflake_model_copy(dst->model, src->model);
+    snowflake_frame_copy(dst->frame, src->frame);
+}
+
+// ===================================================================
+// Function: Initialize Snowflake
+// ===================================================================
+static void init_snowflake(SnowflakeState* state) {
+    DEBUG_LOG("Initializing snowflake");
+    
+    snowflake_model_set_params(state->model, &state->params);
+    snowflake_model_reset(state->model);
+    
+    // Render the grid once; the step only adds newly frozen cells
+    snowflake_frame_reset(state->frame);
+    
+    snowflake_trace_params(state->trace, SNOWFLAKE_TRACE_RESET, state->trace_source, state->model, &state->params);
+    if(state->history) snowflake_history_seed(state->history, &state->params);
+}
+
+// ===================================================================
+// Function: Grow Snowflake (Reiter's model)
+// ===================================================================
+static void grow_snowflake(SnowflakeState* state) {
+    uint32_t start = snowflake_profile_now();
+    int frozen_count = snowflake_model_step(state->model);
+    uint32_t ticks = snowflake_profile_now() - start;
     
-    // Row 1: X,X,C,X,X (center row, offset 0)
-    if(filled) {
-        canvas_draw_dot(canvas, center_px - 2, center_py);
-        canvas_draw_dot(canvas, center_px - 1, center_py);
-        canvas_draw_dot(canvas, center_px, center_py);      // C = center pixel
-        canvas_draw_dot(canvas, center_px + 1, center_py);
-        canvas_draw_dot(canvas, center_px + 2, center_py);
+    snowflake_frame_update_zoom(state->frame, false);
+    if(state->history) snowflake_history_record(state->history, state->model, false);
+    snowflake_trace_step(state->trace, state->trace_source, state->model, frozen_count, ticks);
+    DEBUG_LOG("Step %d: froze %d cells", snowflake_model_get_step(state->model), frozen_count);
+}
+
+// ===================================================================
+// Function: Gallery files on the SD card
+// The index lives in state->gallery under the lock; files are read and
+// written without it.
+// ===================================================================
+static void gallery_entry_path(char* path, size_t size, uint32_t id) {
+    snprintf(path, size, "%s/%lu.bin", GALLERY_DIR, (unsigned long)id);
+}
+
+static bool gallery_index_write_callback(const SnowflakeWriter* writer, void* context) {
+    return snowflake_gallery_write(context, writer);
+}
+
+static void gallery_load_index(SnowflakeGallery* gallery) {
+    SnowflakeStorageFile* file = snowflake_storage_open(GALLERY_INDEX_PATH, false);
+    if(!file) return;
+    
+    SnowflakeReader reader = snowflake_storage_reader(file);
+    if(!snowflake_gallery_read(gallery, &reader)) FURI_LOG_W(TAG, "Ignoring %s", GALLERY_INDEX_PATH);
+    snowflake_storage_close(file);
+}
+
+static void gallery_save_index(SnowflakeState* state) {
+    SnowflakeGallery* index = malloc(sizeof(SnowflakeGallery));
+    if(!index) return;
+    
+    furi_mutex_acquire(state->mutex, FuriWaitForever);
+    *index = *state->gallery;
+    furi_mutex_release(state->mutex);
+    snowflake_storage_write_file(GALLERY_INDEX_PATH, gallery_index_write_callback, index);
+    free(index);
+}
+
+// ===================================================================
+// Function: Read a cached flake into a model no other thread uses
+// Its frame has seen every restored cell and must be reset after.
+// ===================================================================
+static bool gallery_fetch(SnowflakeModel* model, uint32_t id) {
+    char path[64];
+    gallery_entry_path(path, sizeof(path), id);
+    SnowflakeStorageFile* file = snowflake_storage_open(path, false);
+    if(!file) return false;
+    
+    SnowflakeReader reader = snowflake_storage_reader(file);
+    bool ok = snowflake_checkpoint_read(model, &reader);
+    snowflake_storage_close(file);
+    return ok;
+}
+
+// ===================================================================
+// Function: Forget an entry whose file can't be read
+// ===================================================================
+static void gallery_drop(SnowflakeState* state, uint32_t id) {
+    furi_mutex_acquire(state->mutex, FuriWaitForever);
+    int index = snowflake_gallery_find_id(state->gallery, id);
+    if(index >= 0) snowflake_gallery_remove(state->gallery, index);
+    furi_mutex_release(state->mutex);
+    
+    char path[64];
+    gallery_entry_path(path, sizeof(path), id);
+    snowflake_storage_remove(path);
+    FURI_LOG_W(TAG, "Dropped unreadable gallery entry %lu", (unsigned long)id);
+}
+
+// ===================================================================
+// Function: Add a flake to the gallery, evicting the least recently used
+// The model must not change meanwhile: the worker's own, or the
+// displayed one once the worker has stopped.
+// ===================================================================
+typedef struct {
+    const SnowflakeModel* model;
+    const SnowflakeWriter* file;
+    uint32_t bytes;
+} GalleryFile;
+
+static size_t gallery_file_write(void* context, const void* data, size_t size) {
+    GalleryFile* gallery_file = context;
+    size_t written = gallery_file->file->write(gallery_file->file->context, data, size);
+    gallery_file->bytes += written;
+    return written;
+}
+
+static bool gallery_write_callback(const SnowflakeWriter* writer, void* context) {
+    GalleryFile* gallery_file = context;
+    gallery_file->file = writer;
+    SnowflakeWriter counted = {.write = gallery_file_write, .context = gallery_file};
+    return snowflake_checkpoint_write(gallery_file->model, &counted);
+}
+
+static void gallery_store(SnowflakeState* state, const SnowflakeModel* model) {
+    SnowflakeGalleryKey key =
+        snowflake_gallery_key(snowflake_model_get_params(model), GRID_SIZE, snowflake_model_get_step(model));
+    
+    // A flake that is already there only counts as used
+    furi_mutex_acquire(state->mutex, FuriWaitForever);
+    int index = snowflake_gallery_find(state->gallery, &key);
+    if(index >= 0) snowflake_gallery_touch(state->gallery, index);
+    uint32_t id = index < 0 ? snowflake_gallery_reserve(state->gallery) : 0;
+    furi_mutex_release(state->mutex);
+    if(index >= 0) return;
+    
+    char path[64];
+    gallery_entry_path(path, sizeof(path), id);
+    GalleryFile gallery_file = {.model = model, .file = NULL, .bytes = 0};
+    bool written = snowflake_storage_write_file(path, gallery_write_callback, &gallery_file);
+    
+    uint32_t evicted[SNOWFLAKE_GALLERY_MAX_ENTRIES + 1];
+    int evicted_count = 0;
+    furi_mutex_acquire(state->mutex, FuriWaitForever);
+    if(written) {
+        evicted_count = snowflake_gallery_add(state->gallery, &key, id, gallery_file.bytes, evicted);
     } else {
-        // Always draw center pixel even when not filled (for grid visualization)
-        canvas_draw_dot(canvas, center_px, center_py);
+        evicted[evicted_count++] = id;
     }
+    furi_mutex_release(state->mutex);
     
-    // Row 2: 0,X,X,X,0 (offset +1 from center)
-    if(filled) {
-        canvas_draw_dot(canvas, center_px - 1, center_py + 1);
-        canvas_draw_dot(canvas, center_px, center_py + 1);
-        canvas_draw_dot(canvas, center_px + 1, center_py + 1);
+    for(int i = 0; i < evicted_count; i++) {
+        gallery_entry_path(path, sizeof(path), evicted[i]);
+        snowflake_storage_remove(path);
     }
+    gallery_save_index(state);
+    DEBUG_LOG("Gallery: stored %lu bytes as %lu, evicted %d", (unsigned long)gallery_file.bytes, (unsigned long)id,
+              evicted_count);
 }
 
 // ===================================================================
-// Function: Get hexagonal neighbors for flat-top hexagons
-// Using "odd-q" vertical layout (odd columns shifted down)
+// Function: Preview worker thread
+// Regrows the flake from the seed with the current parameters in chunks
+// of PREVIEW_CHUNK_STEPS and publishes every chunk to the displayed state.
+// A newer generation makes the run stale; it is dropped after its chunk.
+// A flake the gallery has for these parameters is published at once
+// instead, and a finished run is added to it.
 // ===================================================================
-static void get_hex_neighbors(int x, int y, int neighbors_x[6], int neighbors_y[6]) {
-    if(x % 2 == 0) {
-        // Even columns
-        neighbors_x[0] = x;      neighbors_y[0] = y - 1;  // N
-        neighbors_x[1] = x + 1;  neighbors_y[1] = y - 1;  // NE
-        neighbors_x[2] = x + 1;  neighbors_y[2] = y;      // SE
-        neighbors_x[3] = x;      neighbors_y[3] = y + 1;  // S
-        neighbors_x[4] = x - 1;  neighbors_y[4] = y;      // SW
-        neighbors_x[5] = x - 1;  neighbors_y[5] = y - 1;  // NW
-    } else {
-        // Odd columns (offset down)
-        neighbors_x[0] = x;      neighbors_y[0] = y - 1;  // N
-        neighbors_x[1] = x + 1;  neighbors_y[1] = y;      // NE
-        neighbors_x[2] = x + 1;  neighbors_y[2] = y + 1;  // SE
-        neighbors_x[3] = x;      neighbors_y[3] = y + 1;  // S
-        neighbors_x[4] = x - 1;  neighbors_y[4] = y + 1;  // SW
-        neighbors_x[5] = x - 1;  neighbors_y[5] = y;      // NW
+static int32_t preview_worker_thread(void* ctx) {
+    PreviewWorker* worker = ctx;
+    SnowflakeState* state = worker->state;
+    SnowflakeState* work = &worker->work;
+    
+    while(true) {
+        uint32_t flags = furi_thread_flags_wait(
+            PREVIEW_FLAG_RESTART | PREVIEW_FLAG_EXIT, FuriFlagWaitAny, FuriWaitForever);
+        if(flags & FuriFlagError) continue;
+        if(flags & PREVIEW_FLAG_EXIT) break;
+        
+        // Snapshot parameters together with the generation they belong to
+        furi_mutex_acquire(state->mutex, FuriWaitForever);
+        uint32_t generation = state->preview_generation;
+        work->params = state->params;
+        int cached = -1;
+        uint32_t cached_id = 0;
+        if(state->gallery) {
+            SnowflakeGalleryKey key = snowflake_gallery_key(&work->params, GRID_SIZE, PREVIEW_STEPS);
+            cached = snowflake_gallery_find(state->gallery, &key);
+            if(cached >= 0) cached_id = state->gallery->entries[cached].id;
+        }
+        furi_mutex_release(state->mutex);
+        
+        if(cached >= 0) {
+            bool fetched = gallery_fetch(work->model, cached_id);
+            snowflake_frame_reset(work->frame);
+            if(fetched) {
+                // Grown on with the exact parameters, not the ones the entry was made with
+                snowflake_model_set_params(work->model, &work->params);
+                snowflake_trace_params(work->trace, SNOWFLAKE_TRACE_RESET, work->trace_source, work->model, &work->params);
+                
+                furi_mutex_acquire(state->mutex, FuriWaitForever);
+                if(generation == state->preview_generation) {
+                    copy_grid(state, work);
+                    if(state->history) {
+                        snowflake_history_clear(state->history);
+                        snowflake_history_record(state->history, state->model, true);
+                    }
+                    int index = snowflake_gallery_find_id(state->gallery, cached_id);
+                    if(index >= 0) snowflake_gallery_touch(state->gallery, index);
+                }
+                furi_mutex_release(state->mutex);
+                view_port_update(worker->view_port);
+                continue;
+            }
+            gallery_drop(state, cached_id);
+        }
+        
+        init_snowflake(work);
+        bool first_chunk = true;
+        bool stale = false;
+        
+        while(snowflake_model_get_step(work->model) < PREVIEW_STEPS) {
+            for(int i = 0; i < PREVIEW_CHUNK_STEPS && snowflake_model_get_step(work->model) < PREVIEW_STEPS; i++) {
+                grow_snowflake(work);
+            }
+            
+            furi_mutex_acquire(state->mutex, FuriWaitForever);
+            stale = (generation != state->preview_generation);
+            if(!stale) {
+                // The undo history follows the displayed flake, which now regrows from the seed
+                if(state->history && first_chunk) snowflake_history_seed(state->history, &work->params);
+                copy_grid(state, work);
+                if(state->history) snowflake_history_record(state->history, state->model, false);
+                first_chunk = false;
+            }
+            furi_mutex_release(state->mutex);
+            
+            if(stale) break;
+            view_port_update(worker->view_port);
+        }
+        
+        if(!stale && state->gallery) gallery_store(state, work->model);
     }
+    
+    return 0;
 }
 
 // ===================================================================
-// Function: Check if cell is boundary cell
+// Function: Invalidate running preview (caller holds state->mutex)
 // ===================================================================
-static bool is_boundary_cell(SnowflakeState* state, int x, int y) {
-    if(state->frozen[get_index(x, y)]) return false;
-    
-    // Border cells (2 cells from edge) can never be boundary cells
-    if(x < 2 || x >= GRID_SIZE - 2 || y < 2 || y >= GRID_SIZE - 2) return false;
+static void preview_cancel(SnowflakeState* state) {
+    state->preview_generation++;
+}
+
+// ===================================================================
+// Function: Start a fresh preview with the current parameters
+// ===================================================================
+static void preview_restart(PreviewWorker* worker) {
+    furi_mutex_acquire(worker->state->mutex, FuriWaitForever);
+    preview_cancel(worker->state);
+    furi_mutex_release(worker->state->mutex);
+    furi_thread_flags_set(furi_thread_get_id(worker->thread), PREVIEW_FLAG_RESTART);
+}
+
+// ===================================================================
+// Function: Draw the phase timings (debug overlay)
+// Microseconds over the last SNOWFLAKE_PROFILE_WINDOW samples
+// ===================================================================
+static void draw_profile_overlay(Canvas* canvas, const SnowflakeProfile* profile) {
+    uint32_t ticks_per_us = snowflake_profile_ticks_per_us();
     
-    int neighbors_x[6], neighbors_y[6];
-    get_hex_neighbors(x, y, neighbors_x, neighbors_y);
+    canvas_set_color(canvas, ColorWhite);
+    canvas_draw_box(canvas, 0, 12, 128, 52);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_draw_str(canvas, 2, 20, "us           avg   min   max");
     
-    for(int i = 0; i < 6; i++) {
-        int nx = neighbors_x[i];
-        int ny = neighbors_y[i];
+    for(int phase = 0; phase < SNOWFLAKE_PHASE_COUNT; phase++) {
+        SnowflakeProfileStats stats;
+        snowflake_profile_get_stats(profile, phase, &stats);
         
-        if(nx >= 0 && nx < GRID_SIZE && ny >= 0 && ny < GRID_SIZE) {
-            if(state->frozen[get_index(nx, ny)]) {
-                return true;
-            }
-        }
+        char line[40];
+        snprintf(line, sizeof(line), "%-8s %5lu %5lu %5lu",
+                 snowflake_profile_phase_name(phase),
+                 (unsigned long)(stats.avg / ticks_per_us),
+                 (unsigned long)(stats.min / ticks_per_us),
+                 (unsigned long)(stats.max / ticks_per_us));
+        canvas_draw_str(canvas, 2, 30 + phase * 9, line);
+    }
+}
+
+// ===================================================================
+// Function: Log the phase timings
+// ===================================================================
+static void log_profile(const SnowflakeProfile* profile) {
+    uint32_t ticks_per_us = snowflake_profile_ticks_per_us();
+    for(int phase = 0; phase < SNOWFLAKE_PHASE_COUNT; phase++) {
+        SnowflakeProfileStats stats;
+        snowflake_profile_get_stats(profile, phase, &stats);
+        FURI_LOG_I(TAG, "%s: avg %lu min %lu max %lu us (%d samples)",
+                   snowflake_profile_phase_name(phase),
+                   (unsigned long)(stats.avg / ticks_per_us),
+                   (unsigned long)(stats.min / ticks_per_us),
+                   (unsigned long)(stats.max / ticks_per_us),
+                   stats.count);
     }
+}
+
+// ===================================================================
+// Function: Draw the latency percentiles (debug overlay)
+// Microseconds over the last SNOWFLAKE_LATENCY_WINDOW events
+// ===================================================================
+static void draw_latency_overlay(Canvas* canvas, const SnowflakeLatency* latency) {
+    uint32_t ticks_per_us = snowflake_profile_ticks_per_us();
     
-    return false;
+    canvas_set_color(canvas, ColorWhite);
+    canvas_draw_box(canvas, 0, 12, 128, 52);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_draw_str(canvas, 2, 20, "us      p50   p90   p99   max");
+    
+    for(int stage = 0; stage < SNOWFLAKE_LATENCY_STAGE_COUNT; stage++) {
+        SnowflakeLatencyStats stats;
+        snowflake_latency_get_stats(latency, stage, &stats);
+        
+        char line[40];
+        snprintf(line, sizeof(line), "%-6s %5lu %5lu %5lu %5lu",
+                 snowflake_latency_stage_name(stage),
+                 (unsigned long)(stats.p50 / ticks_per_us),
+                 (unsigned long)(stats.p90 / ticks_per_us),
+                 (unsigned long)(stats.p99 / ticks_per_us),
+                 (unsigned long)(stats.max / ticks_per_us));
+        canvas_draw_str(canvas, 2, 30 + stage * 9, line);
+    }
 }
 
 // ===================================================================
-// Function: Initialize Snowflake
+// Function: Log the latency percentiles
 // ===================================================================
-static void init_snowflake(SnowflakeState* state) {
-    FURI_LOG_I(TAG, "Initializing snowflake");
+static void log_latency(const SnowflakeLatency* latency) {
+    uint32_t ticks_per_us = snowflake_profile_ticks_per_us();
+    for(int stage = 0; stage < SNOWFLAKE_LATENCY_STAGE_COUNT; stage++) {
+        SnowflakeLatencyStats stats;
+        snowflake_latency_get_stats(latency, stage, &stats);
+        FURI_LOG_I(TAG, "%s: p50 %lu p90 %lu p99 %lu max %lu us (%d events)",
+                   snowflake_latency_stage_name(stage),
+                   (unsigned long)(stats.p50 / ticks_per_us),
+                   (unsigned long)(stats.p90 / ticks_per_us),
+                   (unsigned long)(stats.p99 / ticks_per_us),
+                   (unsigned long)(stats.max / ticks_per_us),
+                   stats.count);
+    }
+    FURI_LOG_I(TAG, "%lu events dropped before a draw", (unsigned long)latency->dropped);
+}
+
+// ===================================================================
+// Function: Write the trace ring buffer to the SD card
+// ===================================================================
+static bool trace_write_callback(const SnowflakeWriter* writer, void* context) {
+    return snowflake_trace_write(context, writer, snowflake_profile_ticks_per_us());
+}
+
+static void trace_flush(const SnowflakeTrace* trace) {
+    if(snowflake_storage_write_file(TRACE_PATH, trace_write_callback, (void*)trace)) {
+        FURI_LOG_I(TAG, "Wrote %lu trace records to %s",
+                   (unsigned long)snowflake_trace_count(trace), TRACE_PATH);
+    }
+}
+
+// ===================================================================
+// Function: Save the flake for the next session
+// ===================================================================
+static bool checkpoint_write_callback(const SnowflakeWriter* writer, void* context) {
+    return snowflake_checkpoint_write(context, writer);
+}
+
+static void checkpoint_save(const SnowflakeState* state) {
+    if(snowflake_storage_write_file(CHECKPOINT_PATH, checkpoint_write_callback, state->model)) {
+        FURI_LOG_I(TAG, "Saved step %d to %s", snowflake_model_get_step(state->model), CHECKPOINT_PATH);
+    }
+}
+
+// ===================================================================
+// Function: Continue the flake of the last session, if there is one
+// ===================================================================
+static void checkpoint_resume(SnowflakeState* state) {
+    SnowflakeStorageFile* file = snowflake_storage_open(CHECKPOINT_PATH, false);
+    if(!file) return;
+    
+    SnowflakeReader reader = snowflake_storage_reader(file);
+    bool resumed = snowflake_checkpoint_read(state->model, &reader);
+    snowflake_storage_close(file);
     
-    // Initialize all cells
-    for(int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
-        state->s[i] = state->beta;
-        state->u[i] = 0.0f;
-        state->frozen[i] = 0;
+    // The frame has seen the restored cells, or a partial restore before a reset
+    snowflake_frame_reset(state->frame);
+    if(!resumed) {
+        FURI_LOG_W(TAG, "Ignoring %s", CHECKPOINT_PATH);
+        return;
     }
     
-    // Freeze center cell
-    int center = GRID_SIZE / 2;
-    int center_idx = get_index(center, center);
-    state->s[center_idx] = 1.0f;
-    state->frozen[center_idx] = 1;
+    state->params = *snowflake_model_get_params(state->model);
+    snowflake_trace_params(state->trace, SNOWFLAKE_TRACE_RESET, state->trace_source, state->model, &state->params);
     
-    state->step = 0;
-    FURI_LOG_I(TAG, "Initialized with α=%f β=%f γ=%f", 
-               (double)state->alpha, (double)state->beta, (double)state->gamma);
+    // Undo reaches back to the resumed step
+    if(state->history) {
+        snowflake_history_clear(state->history);
+        snowflake_history_record(state->history, state->model, true);
+    }
+    FURI_LOG_I(TAG, "Resumed at step %d", snowflake_model_get_step(state->model));
 }
 
 // ===================================================================
-// Function: Grow Snowflake (Reiter's model)
+// Function: Save the shown flake as an image at the frame's zoom, or
+// its s field, as the Export format setting says
+// Runs outside the lock with the preview cancelled, so nothing changes
+// the model meanwhile; the file is streamed one row at a time.
 // ===================================================================
-static void grow_snowflake(SnowflakeState* state) {
-    float* u_new = (float*)malloc(GRID_SIZE * GRID_SIZE * sizeof(float));
-    if(!u_new) return;
-    
-    // Step 1: Classify cells and set u values
-    for(int y = 0; y < GRID_SIZE; y++) {
-        for(int x = 0; x < GRID_SIZE; x++) {
-            int idx = get_index(x, y);
-            bool is_receptive = state->frozen[idx] || is_boundary_cell(state, x, y);
-            
-            if(is_receptive) {
-                state->u[idx] = 0.0f;
-            } else {
-                state->u[idx] = state->s[idx];
-            }
+typedef struct {
+    const SnowflakeFrame* frame;
+    const SnowflakeExportOptions* options;
+} ImageExport;
+
+static bool image_write_callback(const SnowflakeWriter* writer, void* context) {
+    const ImageExport* image = context;
+    return snowflake_export_write(image->frame, image->options, writer);
+}
+
+static void image_export(const SnowflakeState* state, const SnowflakeExportOptions* settings_options) {
+    SnowflakeExportOptions options = *settings_options;
+    options.zoom = state->frame->view.zoom;
+    int width, height;
+    if(!snowflake_export_size(state->frame, &options, &width, &height)) {
+        FURI_LOG_W(TAG, "Export too large, lower Export scale");
+        return;
+    }
+    
+    int step = state->frame->rewind_step;
+    if(step == SNOWFLAKE_FRAME_LIVE) step = snowflake_model_get_step(state->model);
+    char path[64];
+    snprintf(path, sizeof(path), EXPORT_PATH_FORMAT, step, snowflake_export_extension(options.format));
+    ImageExport image = {.frame = state->frame, .options = &options};
+    uint32_t start = furi_get_tick();
+    if(snowflake_storage_write_file(path, image_write_callback, &image)) {
+        FURI_LOG_I(TAG, "Exported %dx%d to %s in %lu ms", width, height, path, (unsigned long)(furi_get_tick() - start));
+    }
+}
+
+// ===================================================================
+// Function: Continue from the rewound step (caller holds state->mutex)
+// Restores the full state of the shown step from the undo history, so
+// growing on branches off there; the parameters go back to the ones of
+// that step. Without a keyframe that far back the flake just returns
+// to its current step. Returns true if it branched.
+// ===================================================================
+static bool branch_from_rewind(SnowflakeState* state) {
+    int step = state->frame->rewind_step;
+    if(step == SNOWFLAKE_FRAME_LIVE) return false;
+    
+    // The flake left behind stays as the other branch if there is memory for it
+    SnowflakeTiles* left = state->history ? snowflake_tiles_alloc(state->model) : NULL;
+    bool restored = state->history && snowflake_history_restore(state->history, state->model, step);
+    if(restored) {
+        state->params = *snowflake_model_get_params(state->model);
+        FURI_LOG_I(TAG, "Branched at step %d", step);
+        if(left) {
+            snowflake_tiles_free(state->other_branch);
+            state->other_branch = left;
+            left = NULL;
+        } else {
+            FURI_LOG_W(TAG, "No memory to keep the other branch");
         }
+    } else {
+        FURI_LOG_W(TAG, "Step %d is no longer in the undo history", step);
     }
+    snowflake_tiles_free(left);
     
-    // Step 2: Diffusion
-    for(int y = 0; y < GRID_SIZE; y++) {
-        for(int x = 0; x < GRID_SIZE; x++) {
-            int idx = get_index(x, y);
-            
-            // Border cells (2 from edge) maintain beta level
-            if(x < 2 || x >= GRID_SIZE - 2 || y < 2 || y >= GRID_SIZE - 2) {
-                u_new[idx] = state->beta;
-                continue;
-            }
-            
-            // Get hex neighbors with proper offset
-            int neighbors_x[6], neighbors_y[6];
-            get_hex_neighbors(x, y, neighbors_x, neighbors_y);
-            
-            float sum = 0.0f;
-            int count = 0;
-            
-            for(int i = 0; i < 6; i++) {
-                int nx = neighbors_x[i];
-                int ny = neighbors_y[i];
-                
-                if(nx >= 0 && nx < GRID_SIZE && ny >= 0 && ny < GRID_SIZE) {
-                    sum += state->u[get_index(nx, ny)];
-                    count++;
-                }
-            }
-            
-            float avg = (count > 0) ? (sum / count) : state->u[idx];
-            u_new[idx] = state->u[idx] + (state->alpha / 2.0f) * (avg - state->u[idx]);
+    snowflake_frame_rewind(state->frame, SNOWFLAKE_FRAME_LIVE);
+    snowflake_frame_update_zoom(state->frame, false);
+    return restored;
+}
+
+// ===================================================================
+// Function: Swap the flake with the other branch (caller holds state->mutex)
+// The flake goes into a fork of the other branch, so only the tiles in
+// which the two differ are copied, the rest stays shared. The undo
+// history only knows the flake it recorded; it starts over at the
+// swapped-in step, as after a resume. Returns false if out of memory.
+// ===================================================================
+static bool swap_branch(SnowflakeState* state) {
+    SnowflakeTiles* other = state->other_branch;
+    SnowflakeTiles* current = snowflake_tiles_fork(other);
+    if(!current || !snowflake_tiles_store(current, state->model)) {
+        snowflake_tiles_free(current);
+        FURI_LOG_W(TAG, "No memory to swap branches");
+        return false;
+    }
+    
+    snowflake_tiles_load(other, state->model);
+    snowflake_tiles_free(other);
+    state->other_branch = current;
+    state->params = *snowflake_model_get_params(state->model);
+    snowflake_frame_reset(state->frame);
+    snowflake_trace_params(state->trace, SNOWFLAKE_TRACE_RESET, state->trace_source, state->model, &state->params);
+    if(state->history) {
+        snowflake_history_clear(state->history);
+        snowflake_history_record(state->history, state->model, true);
+    }
+    
+    SnowflakeTilesUsage usage;
+    snowflake_tiles_get_usage(current, &usage);
+    FURI_LOG_I(TAG, "Swapped to step %d, other branch %u of %u bytes", snowflake_model_get_step(state->model),
+               (unsigned)usage.bytes, (unsigned)usage.unshared);
+    return true;
+}
+
+// ===================================================================
+// Function: Draw the benchmark results (bench tool)
+// ===================================================================
+static void draw_bench_screen(Canvas* canvas, const SnowflakeState* state) {
+    uint32_t ticks_per_us = snowflake_profile_ticks_per_us();
+    
+    canvas_set_color(canvas, ColorWhite);
+    canvas_draw_box(canvas, 0, 12, 128, 52);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_draw_str(canvas, 2, 20, "size step/s cyc/cell frame us");
+    
+    for(int i = 0; i < SNOWFLAKE_BENCH_SIZE_COUNT; i++) {
+        const SnowflakeBenchResult* result = &state->bench[i];
+        char line[40];
+        if(i >= state->bench_done) {
+            snprintf(line, sizeof(line), "%4d  ...", snowflake_bench_sizes[i]);
+        } else if(!result->ok) {
+            snprintf(line, sizeof(line), "%4d  out of memory", result->size);
+        } else {
+            snprintf(line, sizeof(line), "%4d %6lu %8lu %8lu",
+                     result->size,
+                     (unsigned long)snowflake_bench_steps_per_sec(result, ticks_per_us),
+                     (unsigned long)snowflake_bench_ticks_per_cell(result),
+                     (unsigned long)snowflake_bench_frame_us(result, ticks_per_us));
         }
+        canvas_draw_str(canvas, 2, 29 + i * 8, line);
     }
     
-    memcpy(state->u, u_new, GRID_SIZE * GRID_SIZE * sizeof(float));
-    free(u_new);
+    canvas_draw_str(canvas, 2, 62, state->bench_done < SNOWFLAKE_BENCH_SIZE_COUNT ? "Running..." : "Back: close");
+}
+
+// ===================================================================
+// Function: Run the benchmark workload and save the results
+// Runs on the main thread without the lock; the display is updated
+// after every lattice size. The preview must be stopped beforehand.
+// ===================================================================
+typedef struct {
+    const SnowflakeBenchResult* results;
+    const char* label;
+} BenchWriteContext;
+
+static bool bench_write_callback(const SnowflakeWriter* writer, void* context) {
+    const BenchWriteContext* bench = context;
+    return snowflake_bench_write(
+        bench->results, SNOWFLAKE_BENCH_SIZE_COUNT, bench->label, writer, snowflake_profile_ticks_per_us());
+}
+
+static void run_benchmark(SnowflakeState* state, ViewPort* view_port) {
+    const SnowflakeKernel* kernel = snowflake_model_get_kernel(state->model);
+    
+    for(int i = 0; i < SNOWFLAKE_BENCH_SIZE_COUNT; i++) {
+        SnowflakeBenchResult result;
+        snowflake_bench_run(snowflake_bench_sizes[i], kernel, &result);
+        
+        furi_mutex_acquire(state->mutex, FuriWaitForever);
+        state->bench[i] = result;
+        state->bench_done = i + 1;
+        furi_mutex_release(state->mutex);
+        view_port_update(view_port);
+    }
     
-    // Step 3: Add background vapor and update s = u + (v + gamma)
-    // Use two-phase update to avoid directional bias
-    float* s_new = (float*)malloc(GRID_SIZE * GRID_SIZE * sizeof(float));
-    uint8_t* frozen_new = (uint8_t*)malloc(GRID_SIZE * GRID_SIZE * sizeof(uint8_t));
-    if(!s_new || !frozen_new) {
-        if(s_new) free(s_new);
-        if(frozen_new) free(frozen_new);
-        return;
+    // Tag the results so files from different devices and firmware can be told apart
+    const char* name = furi_hal_version_get_name_ptr();
+    char label[64];
+    snprintf(label, sizeof(label), "firmware %s, device %s, kernel %s",
+             version_get_version(furi_hal_version_get_firmware_version()), name ? name : "-", kernel->name);
+    BenchWriteContext context = {.results = state->bench, .label = label};
+    if(snowflake_storage_write_file(BENCH_PATH, bench_write_callback, &context)) {
+        FURI_LOG_I(TAG, "Wrote benchmark results to %s", BENCH_PATH);
     }
+}
+
+// ===================================================================
+// Function: Record the growth of the current parameters
+// Regrows the flake from the seed in the demo model and streams every
+// step's frozen cells to GROWTH_PATH.
+// ===================================================================
+typedef struct {
+    SnowflakeModel* model;
+    int steps;
+} GrowthWriteContext;
+
+static bool growth_write_callback(const SnowflakeWriter* writer, void* context) {
+    const GrowthWriteContext* growth = context;
+    SnowflakeGrowthRecorder* recorder = malloc(sizeof(SnowflakeGrowthRecorder));
+    if(!recorder) return false;
     
-    // Copy current frozen state
-    memcpy(frozen_new, state->frozen, GRID_SIZE * GRID_SIZE * sizeof(uint8_t));
+    snowflake_model_reset(growth->model);
+    bool ok = snowflake_growth_recorder_begin(recorder, writer, growth->model);
+    for(int i = 0; ok && i < growth->steps; i++) {
+        snowflake_model_step(growth->model);
+        snowflake_growth_recorder_step(recorder);
+    }
+    ok = snowflake_growth_recorder_end(recorder) && ok;
+    FURI_LOG_I(TAG, "Recorded %lu steps, %lu cells to %s",
+               (unsigned long)recorder->steps, (unsigned long)recorder->cells, GROWTH_PATH);
+    free(recorder);
+    return ok;
+}
+
+// ===================================================================
+// Function: Start playback from the seed, again at the end
+// ===================================================================
+static bool demo_rewind(GrowthDemo* demo) {
+    snowflake_storage_close(demo->file);
+    demo->file = snowflake_storage_open(GROWTH_PATH, false);
+    if(!demo->file) return false;
     
-    int frozen_count = 0;
+    SnowflakeReader reader = snowflake_storage_reader(demo->file);
+    SnowflakeGrowthHeader header;
+    if(!snowflake_growth_player_begin(&demo->player, &reader, &header) || header.size != GRID_SIZE) {
+        return false;
+    }
     
-    // Phase 1: Calculate new s values and determine which cells should freeze
-    // using the CURRENT (unchanged) frozen state
-    for(int y = 0; y < GRID_SIZE; y++) {
-        for(int x = 0; x < GRID_SIZE; x++) {
-            int idx = get_index(x, y);
-            
-            // Border cells (2 from edge): always maintain beta, never freeze
-            if(x < 2 || x >= GRID_SIZE - 2 || y < 2 || y >= GRID_SIZE - 2) {
-                s_new[idx] = state->beta;
-                frozen_new[idx] = 0;
-                continue;
-            }
-            
-            // Use OLD frozen state for receptiveness check
-            bool is_receptive = state->frozen[idx] || is_boundary_cell(state, x, y);
-            
-            if(is_receptive) {
-                // Receptive: s_new = u_new + (s_old + gamma)
-                s_new[idx] = state->u[idx] + state->s[idx] + state->gamma;
-                
-                // Mark for freezing if threshold reached
-                if(!state->frozen[idx] && s_new[idx] >= 1.0f) {
-                    frozen_new[idx] = 1;
-                    frozen_count++;
-                }
-            } else {
-                // Non-receptive: s = u (v=0 for non-receptive)
-                s_new[idx] = state->u[idx];
-            }
+    snowflake_model_set_params(demo->model, &header.params);
+    snowflake_model_reset(demo->model);
+    snowflake_frame_reset(demo->frame);
+    return true;
+}
+
+static void demo_free(GrowthDemo* demo) {
+    if(!demo) return;
+    snowflake_storage_close(demo->file);
+    snowflake_model_free(demo->model);
+    free(demo->frame);
+    free(demo);
+}
+
+// ===================================================================
+// Function: Record the current flake and start playing it back
+// Runs on the main thread without the lock; the demo is only published
+// once it can be drawn.
+// ===================================================================
+static GrowthDemo* demo_start(
+    const SnowflakeParams* params, int steps, const SnowflakeKernel* kernel, uint16_t ring_steps) {
+    GrowthDemo* demo = malloc(sizeof(GrowthDemo));
+    if(!demo) return NULL;
+    demo->file = NULL;
+    demo->model = snowflake_model_alloc(GRID_SIZE, params);
+    demo->frame = malloc(sizeof(SnowflakeFrame));
+    if(!demo->model || !demo->frame) {
+        demo_free(demo);
+        return NULL;
+    }
+    
+    snowflake_model_set_kernel(demo->model, kernel);
+    snowflake_frame_init(demo->frame, demo->model);
+    demo->frame->ring_steps = ring_steps;
+    GrowthWriteContext context = {.model = demo->model, .steps = steps > 0 ? steps : DEMO_DEFAULT_STEPS};
+    if(!snowflake_storage_write_file(GROWTH_PATH, growth_write_callback, &context) || !demo_rewind(demo)) {
+        FURI_LOG_W(TAG, "Growth demo unavailable");
+        demo_free(demo);
+        return NULL;
+    }
+    return demo;
+}
+
+// ===================================================================
+// Function: Show the next recorded step, looping at the end
+// ===================================================================
+static void demo_advance(GrowthDemo* demo) {
+    if(snowflake_growth_play_step(&demo->player, demo->model) < 0) {
+        // A damaged file just ends the loop early; only a failed reopen stops it
+        if(!demo_rewind(demo)) return;
+    }
+    snowflake_frame_update_zoom(demo->frame, false);
+}
+
+// ===================================================================
+// Function: Open / close the gallery screen
+// ===================================================================
+static void browser_free(GalleryBrowser* browser) {
+    if(!browser) return;
+    snowflake_model_free(browser->model);
+    free(browser->frame);
+    free(browser);
+}
+
+static GalleryBrowser* browser_alloc(const SnowflakeParams* params, uint16_t ring_steps) {
+    GalleryBrowser* browser = malloc(sizeof(GalleryBrowser));
+    if(!browser) return NULL;
+    browser->model = snowflake_model_alloc(GRID_SIZE, params);
+    browser->frame = malloc(sizeof(SnowflakeFrame));
+    if(!browser->model || !browser->frame) {
+        browser_free(browser);
+        return NULL;
+    }
+    
+    snowflake_frame_init(browser->frame, browser->model);
+    browser->frame->ring_steps = ring_steps;
+    browser->index = 0;
+    browser->id = 0;
+    browser->loaded = false;
+    return browser;
+}
+
+// ===================================================================
+// Function: Load the entry the gallery screen points at
+// Runs on the main thread without the lock, like the other SD access.
+// Unreadable entries are dropped and the next one is tried.
+// ===================================================================
+static void browser_load(SnowflakeState* state) {
+    GalleryBrowser* browser = state->browser;
+    while(true) {
+        furi_mutex_acquire(state->mutex, FuriWaitForever);
+        int count = state->gallery->count;
+        if(browser->index >= count) browser->index = count > 0 ? count - 1 : 0;
+        uint32_t id = count > 0 ? state->gallery->entries[browser->index].id : 0;
+        furi_mutex_release(state->mutex);
+        if(count == 0) return;
+        
+        bool fetched = gallery_fetch(browser->model, id);
+        snowflake_frame_reset(browser->frame);
+        if(fetched) {
+            furi_mutex_acquire(state->mutex, FuriWaitForever);
+            browser->id = id;
+            browser->loaded = true;
+            furi_mutex_release(state->mutex);
+            return;
         }
+        gallery_drop(state, id);
+    }
+}
+
+// ===================================================================
+// Function: Show the flake picked on the gallery screen (caller holds state->mutex)
+// It replaces the displayed one and grows on from its step.
+// ===================================================================
+static void browser_pick(SnowflakeState* state) {
+    GalleryBrowser* browser = state->browser;
+    snowflake_model_copy(state->model, browser->model);
+    state->params = *snowflake_model_get_params(state->model);
+    snowflake_frame_reset(state->frame);
+    snowflake_trace_params(state->trace, SNOWFLAKE_TRACE_RESET, state->trace_source, state->model, &state->params);
+    
+    // Undo reaches back to the picked step
+    if(state->history) {
+        snowflake_history_clear(state->history);
+        snowflake_history_record(state->history, state->model, true);
+    }
+    
+    int index = snowflake_gallery_find_id(state->gallery, browser->id);
+    if(index >= 0) snowflake_gallery_touch(state->gallery, index);
+    FURI_LOG_I(TAG, "Picked gallery entry %lu at step %d", (unsigned long)browser->id,
+               snowflake_model_get_step(state->model));
+}
+
+// ===================================================================
+// Function: Draw the position in the gallery over the button hints
+// ===================================================================
+static void draw_gallery_bar(Canvas* canvas, const SnowflakeState* state) {
+    char line[24];
+    if(state->gallery->count == 0) {
+        snprintf(line, sizeof(line), "Gallery empty");
+    } else {
+        snprintf(line, sizeof(line), "< %d/%d >", state->browser->index + 1, state->gallery->count);
     }
     
-    // Phase 2: Commit all changes atomically
-    memcpy(state->s, s_new, GRID_SIZE * GRID_SIZE * sizeof(float));
-    memcpy(state->frozen, frozen_new, GRID_SIZE * GRID_SIZE * sizeof(uint8_t));
-    free(s_new);
-    free(frozen_new);
+    canvas_set_color(canvas, ColorWhite);
+    canvas_draw_box(canvas, 0, 53, SNOWFLAKE_SCREEN_GRID_X, 11);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_draw_str(canvas, 2, 62, line);
+}
+
+// ===================================================================
+// Function: Pick the step kernel
+// Uses the kernel cached in the settings if it was tuned for this grid
+// size, otherwise times all of them and caches the fastest.
+// ===================================================================
+static const SnowflakeKernel* select_kernel(SnowflakeSettings* settings, const SnowflakeParams* params) {
+    const SnowflakeKernel* kernel = snowflake_kernel_find(settings->kernel);
+    if(kernel && settings->kernel_size == GRID_SIZE) return kernel;
     
-    state->step++;
-    FURI_LOG_I(TAG, "Step %d: froze %d cells", state->step, frozen_count);
+    uint32_t start = furi_get_tick();
+    kernel = snowflake_kernel_autotune(GRID_SIZE, params, AUTOTUNE_WARMUP_STEPS, AUTOTUNE_STEPS);
+    FURI_LOG_I(TAG, "Autotuned kernel %s in %lu ms", kernel->name, (unsigned long)(furi_get_tick() - start));
+    
+    settings->kernel_size = GRID_SIZE;
+    snprintf(settings->kernel, sizeof(settings->kernel), "%s", kernel->name);
+    snowflake_settings_save(settings);
+    return kernel;
 }
 
 // ===================================================================
@@ -314,61 +973,36 @@ static void grow_snowflake(SnowflakeState* state) {
 // ===================================================================
 static void snowflake_draw_callback(Canvas* canvas, void* ctx) {
     SnowflakeState* state = (SnowflakeState*)ctx;
+    furi_mutex_acquire(state->mutex, FuriWaitForever);
+    SNOWFLAKE_PROFILE_START(draw_start);
     
-    canvas_clear(canvas);
-    canvas_set_color(canvas, ColorBlack);
+    // The demo and the gallery show their flake with the parameters it was made with
+    const GrowthDemo* demo = state->demo;
+    const GalleryBrowser* browser = (state->browser && state->browser->loaded) ? state->browser : NULL;
+    const SnowflakeModel* shown = demo ? demo->model : (browser ? browser->model : NULL);
+    SnowflakeScreen screen = {
+        .params = shown ? snowflake_model_get_params(shown) : &state->params,
+        .selected_param = state->browser ? PARAM_COUNT : state->selected_param,
+        .selected_tool = state->selected_tool,
+        .view_mode = state->view_mode,
+        .frame = demo ? demo->frame : (browser ? browser->frame : state->frame),
+    };
+    snowflake_screen_draw(canvas, &screen);
     
-    // Draw header with icon and title
-    canvas_set_font(canvas, FontPrimary);
-    canvas_draw_icon(canvas, 1, 1, &I_icon_10x10);    
-    canvas_draw_str_aligned(canvas, 13, 1, AlignLeft, AlignTop, "Snowflake");
-    canvas_set_font(canvas, FontSecondary);
-    
-    // Draw parameter info on left side
-    char alpha_str[32];
-    snprintf(alpha_str, sizeof(alpha_str), "%s alpha:%.1f", 
-             (state->selected_param == PARAM_ALPHA) ? ">" : " ", (double)state->alpha);
-    canvas_draw_str(canvas, 2, 18, alpha_str);
-    
-    char beta_str[32];
-    snprintf(beta_str, sizeof(beta_str), "%s beta:%.2f", 
-             (state->selected_param == PARAM_BETA) ? ">" : " ", (double)state->beta);
-    canvas_draw_str(canvas, 2, 27, beta_str);
-    
-    char gamma_str[32];
-    snprintf(gamma_str, sizeof(gamma_str), "%s gam:%.3f", 
-             (state->selected_param == PARAM_GAMMA) ? ">" : " ", (double)state->gamma);
-    canvas_draw_str(canvas, 2, 36, gamma_str);
-    
-    // Count frozen cells
-    int frozen_total = 0;
-    for(int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
-        if(state->frozen[i]) frozen_total++;
-    }
-    
-    // Draw step counter
-    char buffer[42];
-    snprintf(buffer, sizeof(buffer), "Step %d: %d frozen", state->step, frozen_total);
-    canvas_draw_str(canvas, 2, 50, buffer);
-    
-    // Draw all hexagonal cells
-    for(int y = 0; y < GRID_SIZE; y++) {
-        for(int x = 0; x < GRID_SIZE; x++) {
-            int px, py;
-            get_hex_center_pixel(x, y, &px, &py);
-            
-            // Check bounds
-            if(px >= 48 && px < 128 && py >= 0 && py < 64) {
-                bool is_frozen = state->frozen[get_index(x, y)];
-                fill_hex_cell(canvas, px, py, is_frozen);
-            }
-        }
+    // Timings of the previous draws; this one is recorded after the overlay
+    if(state->browser) {
+        draw_gallery_bar(canvas, state);
+    } else if(state->bench_screen) {
+        draw_bench_screen(canvas, state);
+    } else if(state->debug_overlay == DEBUG_OVERLAY_PROFILE) {
+        draw_profile_overlay(canvas, &state->profile);
+    } else if(state->debug_overlay == DEBUG_OVERLAY_LATENCY) {
+        draw_latency_overlay(canvas, &state->latency);
     }
     
-    // Draw UI hints
-    canvas_draw_icon(canvas, 1, 55, &I_back);
-    canvas_draw_str_aligned(canvas, 11, 62, AlignLeft, AlignBottom, "Hold: Exit");
-    elements_button_center(canvas, "OK");
+    SNOWFLAKE_PROFILE_LAP(&state->profile, SNOWFLAKE_PHASE_DRAW, draw_start);
+    snowflake_latency_draw_done(&state->latency, snowflake_profile_now());
+    furi_mutex_release(state->mutex);
 }
 
 // ===================================================================
@@ -377,7 +1011,8 @@ static void snowflake_draw_callback(Canvas* canvas, void* ctx) {
 static void snowflake_input_callback(InputEvent* input_event, void* ctx) {
     furi_assert(ctx);
     FuriMessageQueue* event_queue = ctx;
-    furi_message_queue_put(event_queue, input_event, FuriWaitForever);
+    SnowflakeInputEvent event = {.input = *input_event, .arrival = snowflake_profile_now()};
+    furi_message_queue_put(event_queue, &event, FuriWaitForever);
 }
 
 // ===================================================================
@@ -392,109 +1027,437 @@ int32_t snowflake_main(void* p) {
     SnowflakeState* state = malloc(sizeof(SnowflakeState));
     if(!state) return -1;
     
-    state->s = (float*)malloc(GRID_SIZE * GRID_SIZE * sizeof(float));
-    state->u = (float*)malloc(GRID_SIZE * GRID_SIZE * sizeof(float));
-    state->frozen = (uint8_t*)malloc(GRID_SIZE * GRID_SIZE * sizeof(uint8_t));
-    
-    if(!state->s || !state->u || !state->frozen) {
-        if(state->s) free(state->s);
-        if(state->u) free(state->u);
-        if(state->frozen) free(state->frozen);
+    state->trace = malloc(sizeof(SnowflakeTrace));
+    if(!state->trace) {
         free(state);
         return -1;
     }
+    snowflake_trace_reset(state->trace);
+    state->trace_source = SNOWFLAKE_TRACE_MANUAL;
     
     // Initialize default parameters
-    state->alpha = ALPHA_INIT;
-    state->beta = BETA_INIT;
-    state->gamma = GAMMA_INIT;
+    state->params.alpha = ALPHA_INIT;
+    state->params.beta = BETA_INIT;
+    state->params.gamma = GAMMA_INIT;
+    
+    if(!alloc_grid(state)) {
+        free(state->trace);
+        free(state);
+        return -1;
+    }
+    
+    PreviewWorker* worker = malloc(sizeof(PreviewWorker));
+    if(worker) worker->work.params = state->params;
+    if(!worker || !alloc_grid(&worker->work)) {
+        if(worker) free(worker);
+        free_grid(state);
+        free(state->trace);
+        free(state);
+        return -1;
+    }
+    worker->work.trace = state->trace;
+    worker->work.trace_source = SNOWFLAKE_TRACE_PREVIEW;
+    
     state->selected_param = PARAM_ALPHA;
+    state->selected_tool = TOOL_VIEW;
+    state->view_mode = false;
+    state->debug_overlay = DEBUG_OVERLAY_OFF;
+    state->bench_screen = false;
+    state->bench_done = 0;
+    state->demo = NULL;
     state->back_press_timer = 0;
+    state->preview_generation = 0;
+    
+    // Only manual steps are profiled; the preview worker grows its own model
+    snowflake_profile_reset(&state->profile);
+    snowflake_model_set_profile(state->model, &state->profile);
+    snowflake_latency_reset(&state->latency);
+    
+    SnowflakeSettings settings;
+    snowflake_settings_load(&settings);
+    const SnowflakeKernel* kernel = select_kernel(&settings, &state->params);
+    snowflake_model_set_kernel(state->model, kernel);
+    snowflake_model_set_kernel(worker->work.model, kernel);
+    
+    // Both frames shade the same rings; the preview's is copied over the displayed one
+    uint16_t ring_steps = settings.growth_rings < UINT16_MAX ? (uint16_t)settings.growth_rings : UINT16_MAX;
+    snowflake_frame_set_rings(state->frame, ring_steps);
+    snowflake_frame_set_rings(worker->work.frame, ring_steps);
+    
+    // Exports take the zoom of the moment, the rest comes from the settings
+    SnowflakeExportOptions export_options = {
+        .format = SNOWFLAKE_EXPORT_PNG,
+        .zoom = 0,
+        .scale = settings.export_scale >= 1 && settings.export_scale <= UINT8_MAX ? (uint8_t)settings.export_scale : 1,
+        .whole_lattice = false,
+        .grid = false,
+    };
+    if(!snowflake_export_find_format(settings.export_format, &export_options.format)) {
+        FURI_LOG_W(TAG, "Unknown export format %s, using png", settings.export_format);
+    }
+    
+    // Undo is optional; without the RAM the step counter still rewinds the shape
+    state->history = settings.history_kb ?
+                         snowflake_history_alloc((size_t)settings.history_kb * 1024, HISTORY_KEYFRAME_STEPS) :
+                         NULL;
+    worker->work.history = NULL;
+    state->other_branch = NULL;
+    worker->work.other_branch = NULL;
+    
+    // The index is kept in RAM; the flakes are checkpoint files next to it
+    state->gallery = settings.gallery_kb ? malloc(sizeof(SnowflakeGallery)) : NULL;
+    if(state->gallery) {
+        snowflake_gallery_init(state->gallery, (size_t)settings.gallery_kb * 1024);
+        snowflake_storage_mkdir(GALLERY_DIR);
+        gallery_load_index(state->gallery);
+    }
+    state->browser = NULL;
+    worker->work.gallery = NULL;
+    worker->work.browser = NULL;
     
     init_snowflake(state);
+    checkpoint_resume(state);
     
-    FuriMessageQueue* event_queue = furi_message_queue_alloc(8, sizeof(InputEvent));
+    FuriMessageQueue* event_queue = furi_message_queue_alloc(8, sizeof(SnowflakeInputEvent));
     if(!event_queue) {
-        free(state->s);
-        free(state->u);
-        free(state->frozen);
+        free_grid(&worker->work);
+        free(worker);
+        free_grid(state);
+        snowflake_history_free(state->history);
+        snowflake_tiles_free(state->other_branch);
+        free(state->gallery);
+        free(state->trace);
         free(state);
         return -1;
     }
     
+    state->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    
     ViewPort* view_port = view_port_alloc();
     view_port_draw_callback_set(view_port, snowflake_draw_callback, state);
     view_port_input_callback_set(view_port, snowflake_input_callback, event_queue);
     
+    worker->state = state;
+    worker->view_port = view_port;
+    worker->thread = furi_thread_alloc_ex("SnowflakePreview", PREVIEW_STACK_SIZE, preview_worker_thread, worker);
+    furi_thread_start(worker->thread);
+    
     Gui* gui = furi_record_open(RECORD_GUI);
     gui_add_view_port(gui, view_port, GuiLayerFullscreen);
     
-    InputEvent event;
+    // Optionally log the whole session for replay on the host
+    SnowflakeStorageFile* session_file = NULL;
+    SnowflakeRecorder* recorder = NULL;
+    if(settings.record_sessions) {
+        session_file = snowflake_storage_open(SESSION_PATH, true);
+        recorder = session_file ? malloc(sizeof(SnowflakeRecorder)) : NULL;
+        if(recorder) {
+            SnowflakeWriter writer = snowflake_storage_writer(session_file);
+            SnowflakeRecordingHeader header = {.grid_size = GRID_SIZE, .params = state->params};
+            snowflake_recorder_begin(recorder, &writer, &header, furi_get_tick());
+        }
+    }
+    
+    SnowflakeInputEvent queued;
     bool running = true;
+    InputKey demo_stop_key = InputKeyMAX;  // Key that stopped the demo, swallowed until released
     
     while(running) {
-        if(furi_message_queue_get(event_queue, &event, 100) == FuriStatusOk) {
-            if(event.key == InputKeyBack) {
+        // Only this thread sets the demo, so it can be read without the lock
+        uint32_t timeout = state->demo ? DEMO_FRAME_MS : 100;
+        FuriStatus status = furi_message_queue_get(event_queue, &queued, timeout);
+        if(status == FuriStatusErrorTimeout && state->demo) {
+            furi_mutex_acquire(state->mutex, FuriWaitForever);
+            demo_advance(state->demo);
+            furi_mutex_release(state->mutex);
+            view_port_update(view_port);
+        }
+        if(status == FuriStatusOk) {
+            uint32_t dequeued = snowflake_profile_now();
+            InputEvent event = queued.input;
+            if(recorder) snowflake_recorder_add(recorder, event.key, event.type, furi_get_tick());
+            bool params_changed = false;
+            bool branched = false;
+            bool redraw = false;
+            bool flush_trace = false;
+            bool benchmark = false;
+            int demo_steps = -1;  // Starts the demo if set
+            GrowthDemo* stopped_demo = NULL;
+            bool open_browser = false;
+            bool browse = false;  // Load the entry the gallery screen moved to
+            GalleryBrowser* closed_browser = NULL;
+            bool export_image = false;
+            furi_mutex_acquire(state->mutex, FuriWaitForever);
+            
+            if(event.key == demo_stop_key) {
+                // Rest of the key press that stopped the demo
+                if(event.type == InputTypeRelease) demo_stop_key = InputKeyMAX;
+            } else if(state->demo) {
+                // Any key stops the demo
+                if(event.type == InputTypePress) {
+                    stopped_demo = state->demo;
+                    state->demo = NULL;
+                    demo_stop_key = event.key;
+                    redraw = true;
+                }
+            } else if(event.key == InputKeyBack) {
                 if(event.type == InputTypePress) {
                     state->back_press_timer = furi_get_tick();
                 } else if(event.type == InputTypeRelease) {
                     uint32_t press_duration = furi_get_tick() - state->back_press_timer;
-                    if(press_duration > 500) {
+                    if(press_duration > BACK_LONG_PRESS_MS) {
                         // Long press - exit
                         FURI_LOG_I(TAG, "Long press - exiting");
                         running = false;
+                    } else if(state->bench_screen) {
+                        // Short press - close the benchmark screen
+                        if(state->bench_done == SNOWFLAKE_BENCH_SIZE_COUNT) {
+                            state->bench_screen = false;
+                            redraw = true;
+                        }
+                    } else if(state->browser) {
+                        // Short press - close the gallery
+                        closed_browser = state->browser;
+                        state->browser = NULL;
+                        redraw = true;
+                    } else if(state->view_mode) {
+                        // Short press - leave view mode
+                        state->view_mode = false;
+                        redraw = true;
                     } else {
                         // Short press - reset
                         FURI_LOG_I(TAG, "Short press - reset");
+                        preview_cancel(state);
+                        snowflake_tiles_free(state->other_branch);
+                        state->other_branch = NULL;
                         init_snowflake(state);
-                        view_port_update(view_port);
+                        redraw = true;
                     }
                 }
+            } else if(state->bench_screen) {
+                // Other keys are ignored while the benchmark screen is up
+            } else if(state->browser) {
+                // Gallery: Left/Right page through the cached flakes, OK picks the shown one
+                GalleryBrowser* browser = state->browser;
+                int count = state->gallery->count;
+                if(event.type == InputTypePress || event.type == InputTypeRepeat) {
+                    if((event.key == InputKeyLeft || event.key == InputKeyRight) && count > 1) {
+                        browser->index = (browser->index + (event.key == InputKeyRight ? 1 : count - 1)) % count;
+                        browser->loaded = false;
+                        browse = true;
+                        redraw = true;
+                    } else if(event.key == InputKeyOk && browser->loaded) {
+                        browser_pick(state);
+                        closed_browser = browser;
+                        state->browser = NULL;
+                        redraw = true;
+                    }
+                }
+            } else if(state->view_mode) {
+                if(event.key == InputKeyOk && event.type == InputTypeShort) {
+                    preview_cancel(state);
+                    snowflake_frame_cycle_zoom(state->frame);
+                    redraw = true;
+                } else if(event.key == InputKeyOk && event.type == InputTypeLong) {
+                    // Long OK in view mode saves the flake as an image
+                    preview_cancel(state);
+                    export_image = true;
+                } else if(event.type == InputTypePress || event.type == InputTypeRepeat) {
+                    int dx = 0, dy = 0;
+                    if(event.key == InputKeyUp) dy = -PAN_STEP;
+                    if(event.key == InputKeyDown) dy = PAN_STEP;
+                    if(event.key == InputKeyLeft) dx = -PAN_STEP;
+                    if(event.key == InputKeyRight) dx = PAN_STEP;
+                    if(dx || dy) {
+                        preview_cancel(state);
+                        snowflake_frame_pan(state->frame, dx, dy);
+                        redraw = true;
+                    }
+                }
+            } else if(event.key == InputKeyOk && event.type == InputTypeShort &&
+                      state->selected_param == PARAM_TOOL) {
+                // Tool row: the selected tool runs once OK is let go
+                if(state->selected_tool == TOOL_VIEW) {
+                    state->view_mode = true;
+                    redraw = true;
+                } else if(state->selected_tool == TOOL_GALLERY && state->gallery) {
+                    preview_cancel(state);
+                    open_browser = true;
+                } else if(state->selected_tool == TOOL_SWAP && state->other_branch) {
+                    preview_cancel(state);
+                    swap_branch(state);
+                    redraw = true;
+                } else if(state->selected_tool == TOOL_DEMO) {
+                    preview_cancel(state);
+                    demo_steps = snowflake_model_get_step(state->model);
+                } else if(state->selected_tool == TOOL_TRACE) {
+                    flush_trace = true;
+                } else if(state->selected_tool == TOOL_DEBUG) {
+                    state->debug_overlay = (state->debug_overlay + 1) % DEBUG_OVERLAY_COUNT;
+                    if(state->debug_overlay == DEBUG_OVERLAY_PROFILE) log_profile(&state->profile);
+                    if(state->debug_overlay == DEBUG_OVERLAY_LATENCY) log_latency(&state->latency);
+                    redraw = true;
+                } else if(state->selected_tool == TOOL_BENCH) {
+                    preview_cancel(state);
+                    state->bench_screen = true;
+                    state->bench_done = 0;
+                    benchmark = true;
+                    redraw = true;
+                }
             } else if(event.type == InputTypePress || event.type == InputTypeRepeat) {
-                if(event.key == InputKeyOk) {
+                if(event.key == InputKeyOk && state->selected_param == PARAM_TOOL) {
+                    // Runs on the release instead, see above
+                } else if(event.key == InputKeyOk) {
+                    // Manual stepping continues from whatever the preview reached, or branches off a rewind
+                    preview_cancel(state);
+                    branch_from_rewind(state);
                     grow_snowflake(state);
-                    view_port_update(view_port);
+                    redraw = true;
                 } else if(event.key == InputKeyUp) {
                     // Previous parameter
                     state->selected_param = (state->selected_param + PARAM_COUNT - 1) % PARAM_COUNT;
-                    view_port_update(view_port);
+                    redraw = true;
                 } else if(event.key == InputKeyDown) {
                     // Next parameter
                     state->selected_param = (state->selected_param + 1) % PARAM_COUNT;
-                    view_port_update(view_port);
+                    redraw = true;
+                } else if(state->selected_param == PARAM_STEP &&
+                          (event.key == InputKeyLeft || event.key == InputKeyRight)) {
+                    // Scrub through the growth by thresholding the age map, no simulation
+                    int shown = state->frame->rewind_step;
+                    if(shown == SNOWFLAKE_FRAME_LIVE) shown = snowflake_model_get_step(state->model);
+                    if(event.key == InputKeyLeft && shown > 0) shown--;
+                    if(event.key == InputKeyRight) shown++;
+                    preview_cancel(state);
+                    snowflake_frame_rewind(state->frame, shown);
+                    redraw = true;
+                } else if(state->selected_param == PARAM_TOOL &&
+                          (event.key == InputKeyLeft || event.key == InputKeyRight)) {
+                    // Pick the tool a short OK runs
+                    state->selected_tool =
+                        (state->selected_tool + (event.key == InputKeyRight ? 1 : TOOL_COUNT - 1)) % TOOL_COUNT;
+                    redraw = true;
                 } else if(event.key == InputKeyRight) {
                     // Increase parameter
                     if(state->selected_param == PARAM_ALPHA) {
-                        state->alpha = fminf(state->alpha + ALPHA_STEP, ALPHA_MAX);
+                        state->params.alpha = fminf(state->params.alpha + ALPHA_STEP, ALPHA_MAX);
                     } else if(state->selected_param == PARAM_BETA) {
-                        state->beta = fminf(state->beta + BETA_STEP, BETA_MAX);
+                        state->params.beta = fminf(state->params.beta + BETA_STEP, BETA_MAX);
                     } else if(state->selected_param == PARAM_GAMMA) {
-                        state->gamma = fminf(state->gamma + GAMMA_STEP, GAMMA_MAX);
+                        state->params.gamma = fminf(state->params.gamma + GAMMA_STEP, GAMMA_MAX);
                     }
-                    view_port_update(view_port);
+                    params_changed = true;
+                    redraw = true;
                 } else if(event.key == InputKeyLeft) {
                     // Decrease parameter
                     if(state->selected_param == PARAM_ALPHA) {
-                        state->alpha = fmaxf(state->alpha - ALPHA_STEP, ALPHA_MIN);
+                        state->params.alpha = fmaxf(state->params.alpha - ALPHA_STEP, ALPHA_MIN);
                     } else if(state->selected_param == PARAM_BETA) {
-                        state->beta = fmaxf(state->beta - BETA_STEP, BETA_MIN);
+                        state->params.beta = fmaxf(state->params.beta - BETA_STEP, BETA_MIN);
                     } else if(state->selected_param == PARAM_GAMMA) {
-                        state->gamma = fmaxf(state->gamma - GAMMA_STEP, GAMMA_MIN);
+                        state->params.gamma = fmaxf(state->params.gamma - GAMMA_STEP, GAMMA_MIN);
                     }
-                    view_port_update(view_port);
+                    params_changed = true;
+                    redraw = true;
                 }
             }
+            
+            // Manual steps use the new parameters right away
+            if(params_changed) {
+                // On a rewound flake the new parameters take over from the shown step
+                SnowflakeParams params = state->params;
+                branched = branch_from_rewind(state);
+                state->params = params;
+                snowflake_model_set_params(state->model, &state->params);
+                if(state->history) snowflake_history_record(state->history, state->model, true);
+                snowflake_trace_params(
+                    state->trace, SNOWFLAKE_TRACE_PARAMS, SNOWFLAKE_TRACE_MANUAL, state->model, &state->params);
+            }
+            
+            // The change is committed; the next finished draw closes the event
+            if(redraw) {
+                snowflake_latency_commit(&state->latency, queued.arrival, dequeued, snowflake_profile_now());
+            }
+            furi_mutex_release(state->mutex);
+            if(redraw) view_port_update(view_port);
+            
+            // SD writes happen outside the lock so drawing is not held up
+            if(flush_trace) trace_flush(state->trace);
+            if(export_image) image_export(state, &export_options);
+            if(benchmark) run_benchmark(state, view_port);
+            demo_free(stopped_demo);
+            browser_free(closed_browser);
+            if(open_browser) {
+                GalleryBrowser* browser = browser_alloc(&state->params, state->frame->ring_steps);
+                furi_mutex_acquire(state->mutex, FuriWaitForever);
+                state->browser = browser;
+                furi_mutex_release(state->mutex);
+                browse = browser != NULL;
+                if(!browser) FURI_LOG_W(TAG, "Gallery unavailable");
+            }
+            if(browse) {
+                browser_load(state);
+                view_port_update(view_port);
+            }
+            if(demo_steps >= 0) {
+                GrowthDemo* demo = demo_start(&state->params, demo_steps, kernel, state->frame->ring_steps);
+                furi_mutex_acquire(state->mutex, FuriWaitForever);
+                state->demo = demo;
+                furi_mutex_release(state->mutex);
+                view_port_update(view_port);
+            }
+            
+            // Regrow from the seed in the background with the new parameters, unless branched
+            if(params_changed && !branched) preview_restart(worker);
         }
     }
     
-    // Cleanup
+    if(recorder) {
+        snowflake_recorder_flush(recorder);
+        FURI_LOG_I(TAG, "Recorded %lu events to %s", (unsigned long)recorder->events, SESSION_PATH);
+        free(recorder);
+    }
+    snowflake_storage_close(session_file);
+    
+    demo_free(state->demo);
+    browser_free(state->browser);
+    state->browser = NULL;
+    
+    // Cleanup: stop the preview before the state it writes to goes away
+    furi_mutex_acquire(state->mutex, FuriWaitForever);
+    preview_cancel(state);
+    furi_mutex_release(state->mutex);
+    furi_thread_flags_set(furi_thread_get_id(worker->thread), PREVIEW_FLAG_EXIT);
+    furi_thread_join(worker->thread);
+    furi_thread_free(worker->thread);
+    free_grid(&worker->work);
+    free(worker);
+    
+    // Next start continues from here
+    checkpoint_save(state);
+    if(state->gallery) {
+        if(snowflake_model_get_step(state->model) > 0) {
+            gallery_store(state, state->model);
+        } else {
+            gallery_save_index(state);
+        }
+    }
+
+#ifdef FURI_DEBUG
+    // Debug builds keep the last trace of every session
+    trace_flush(state->trace);
+#endif
+
     gui_remove_view_port(gui, view_port);
     furi_record_close(RECORD_GUI);
     view_port_free(view_port);
     furi_message_queue_free(event_queue);
-    free(state->s);
-    free(state->u);
-    free(state->frozen);
+    furi_mutex_free(state->mutex);
+    free_grid(state);
+    snowflake_history_free(state->history);
+    snowflake_tiles_free(state->other_branch);
+    free(state->gallery);
+    free(state->trace);
     free(state);
     
     FURI_LOG_I(TAG, "Terminated");
@@ -0,0 +1,101 @@
+// Includes
+#include "snowflake_bench.h"
+#include "snowflake_frame.h"
+#include "snowflake_presets.h"
+#include "snowflake_profile.h"
+#include <stdio.h>          // snprintf
+#include <stdlib.h>         // malloc, free
+#include <string.h>         // strlen
+
+const int snowflake_bench_sizes[SNOWFLAKE_BENCH_SIZE_COUNT] = {16, 24, 32, 48};
+
+// ===================================================================
+// Function: Run the workload at one lattice size
+// ===================================================================
+bool snowflake_bench_run(int size, const SnowflakeKernel* kernel, SnowflakeBenchResult* result) {
+    memset(result, 0, sizeof(SnowflakeBenchResult));
+    result->size = size;
+    
+    const SnowflakePreset* preset = snowflake_preset_find(SNOWFLAKE_BENCH_PRESET);
+    SnowflakeModel* model = snowflake_model_alloc(size, &preset->params);
+    SnowflakeFrame* frame = malloc(sizeof(SnowflakeFrame));
+    if(!model || !frame) {
+        snowflake_model_free(model);
+        free(frame);
+        return false;
+    }
+    
+    snowflake_model_set_kernel(model, kernel);
+    snowflake_frame_init(frame, model);
+    snowflake_frame_reset(frame);
+    
+    for(int i = 0; i < SNOWFLAKE_BENCH_STEPS; i++) {
+        uint32_t start = snowflake_profile_now();
+        snowflake_model_step(model);
+        snowflake_frame_update_zoom(frame, false);
+        result->step_ticks += snowflake_profile_now() - start;
+    }
+    
+    for(int i = 0; i < SNOWFLAKE_BENCH_FRAMES; i++) {
+        uint32_t start = snowflake_profile_now();
+        snowflake_frame_rebuild(frame);
+        result->frame_ticks += snowflake_profile_now() - start;
+    }
+    
+    result->ok = true;
+    result->steps = SNOWFLAKE_BENCH_STEPS;
+    result->frames = SNOWFLAKE_BENCH_FRAMES;
+    result->frozen = snowflake_model_get_stats(model)->frozen_total;
+    
+    snowflake_model_free(model);
+    free(frame);
+    return true;
+}
+
+// ===================================================================
+// Function: Derived figures
+// ===================================================================
+double snowflake_bench_steps_per_sec(const SnowflakeBenchResult* result, uint32_t ticks_per_us) {
+    if(!result->step_ticks) return 0.0;
+    return (double)result->steps * ticks_per_us * 1e6 / (double)result->step_ticks;
+}
+
+double snowflake_bench_ticks_per_cell(const SnowflakeBenchResult* result) {
+    if(!result->steps) return 0.0;
+    return (double)result->step_ticks / ((double)result->steps * result->size * result->size);
+}
+
+double snowflake_bench_frame_us(const SnowflakeBenchResult* result, uint32_t ticks_per_us) {
+    if(!result->frames) return 0.0;
+    return (double)result->frame_ticks / ((double)result->frames * ticks_per_us);
+}
+
+// ===================================================================
+// Function: Write results as CSV
+// ===================================================================
+bool snowflake_bench_write(
+    const SnowflakeBenchResult* results,
+    int count,
+    const char* label,
+    const SnowflakeWriter* writer,
+    uint32_t ticks_per_us) {
+    char line[128];
+    
+    snprintf(line, sizeof(line), "# %s\n# preset %s, %lu ticks/us\n", label, SNOWFLAKE_BENCH_PRESET,
+             (unsigned long)ticks_per_us);
+    if(!snowflake_write(writer, line, strlen(line))) return false;
+    
+    const char* header = "size,steps,frozen,step_ticks,steps_per_sec,ticks_per_cell,frames,frame_us\n";
+    if(!snowflake_write(writer, header, strlen(header))) return false;
+    
+    for(int i = 0; i < count; i++) {
+        const SnowflakeBenchResult* r = &results[i];
+        if(!r->ok) continue;
+        snprintf(line, sizeof(line), "%d,%d,%d,%llu,%.1f,%.1f,%d,%.1f\n",
+                 r->size, r->steps, r->frozen, (unsigned long long)r->step_ticks,
+                 snowflake_bench_steps_per_sec(r, ticks_per_us), snowflake_bench_ticks_per_cell(r),
+                 r->frames, snowflake_bench_frame_us(r, ticks_per_us));
+        if(!snowflake_write(writer, line, strlen(line))) return false;
+    }
+    return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+// ===================================================================
+// Fixed step and render workload
+//
+// Grows the standard preset for a fixed number of steps at each of a
+// few lattice sizes, the way the app does (model step, incremental
+// frame drawing, auto zoom), then re-renders the finished frame a few
+// times. Results are in snowflake_profile_now() ticks, i.e. CPU cycles
+// on the Flipper, so runs on different firmware versions and devices
+// can be compared directly.
+// ===================================================================
+#include <stdbool.h>
+#include <stdint.h>
+#include "snowflake_io.h"
+#include "snowflake_kernels.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNOWFLAKE_BENCH_PRESET "sectored"
+#define SNOWFLAKE_BENCH_STEPS 100
+#define SNOWFLAKE_BENCH_FRAMES 20  // Full frame renders after the last step
+#define SNOWFLAKE_BENCH_SIZE_COUNT 4
+
+extern const int snowflake_bench_sizes[SNOWFLAKE_BENCH_SIZE_COUNT];
+
+typedef struct {
+    int size;
+    bool ok;              // False if the lattice did not fit into memory
+    int steps;
+    int frozen;           // Frozen cells after the last step
+    uint64_t step_ticks;  // All steps, including incremental drawing
+    int frames;
+    uint64_t frame_ticks; // All full frame renders
+} SnowflakeBenchResult;
+
+/** Run the workload at one lattice size with the given kernel */
+bool snowflake_bench_run(int size, const SnowflakeKernel* kernel, SnowflakeBenchResult* result);
+
+double snowflake_bench_steps_per_sec(const SnowflakeBenchResult* result, uint32_t ticks_per_us);
+double snowflake_bench_ticks_per_cell(const SnowflakeBenchResult* result);
+double snowflake_bench_frame_us(const SnowflakeBenchResult* result, uint32_t ticks_per_us);
+
+/** Write results as CSV. label goes into a comment line, e.g. the
+ * firmware version and device name.
+ */
+bool snowflake_bench_write(
+    const SnowflakeBenchResult* results,
+    int count,
+    const char* label,
+    const SnowflakeWriter* writer,
+    uint32_t ticks_per_us);
+
+#ifdef __cplusplus
+}
+#endif
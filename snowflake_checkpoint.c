@@ -0,0 +1,184 @@
+// Includes
+#include "snowflake_checkpoint.h"
+#include "snowflake_model_i.h"
+#include <string.h>         // memcpy, memcmp, memset
+
+#define CHUNK_BYTES 64  // Stack buffer for streaming the mask and the s field
+
+// ===================================================================
+// Streams that keep a running FNV-1a checksum
+// ===================================================================
+typedef struct {
+    const SnowflakeWriter* writer;
+    uint32_t checksum;
+} CheckpointOut;
+
+typedef struct {
+    const SnowflakeReader* reader;
+    uint32_t checksum;
+} CheckpointIn;
+
+static uint32_t fnv1a(uint32_t hash, const uint8_t* data, size_t size) {
+    for(size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool checkpoint_put(CheckpointOut* out, const uint8_t* data, size_t size) {
+    out->checksum = fnv1a(out->checksum, data, size);
+    return snowflake_write(out->writer, data, size);
+}
+
+static bool checkpoint_get(CheckpointIn* in, uint8_t* data, size_t size) {
+    if(!snowflake_read(in->reader, data, size)) return false;
+    in->checksum = fnv1a(in->checksum, data, size);
+    return true;
+}
+
+// ===================================================================
+// Function: Write a checkpoint
+// ===================================================================
+bool snowflake_checkpoint_write(const SnowflakeModel* model, const SnowflakeWriter* writer) {
+    CheckpointOut out = {.writer = writer, .checksum = 2166136261u};
+    size_t cells = (size_t)model->size * model->size;
+    uint8_t chunk[CHUNK_BYTES];
+    
+    uint32_t bits[3];
+    memcpy(&bits[0], &model->params.alpha, sizeof(uint32_t));
+    memcpy(&bits[1], &model->params.beta, sizeof(uint32_t));
+    memcpy(&bits[2], &model->params.gamma, sizeof(uint32_t));
+    
+    memcpy(chunk, "SFCK", 4);
+    snowflake_put_u16(chunk + 4, SNOWFLAKE_CHECKPOINT_VERSION);
+    snowflake_put_u16(chunk + 6, (uint16_t)model->size);
+    for(int i = 0; i < 3; i++) snowflake_put_u32(chunk + 8 + 4 * i, bits[i]);
+    snowflake_put_u32(chunk + 20, (uint32_t)model->step);
+    if(!checkpoint_put(&out, chunk, SNOWFLAKE_CHECKPOINT_HEADER_SIZE)) return false;
+    
+    // Frozen mask, 8 cells per byte
+    size_t used = 0;
+    for(size_t i = 0; i < cells; i += 8) {
+        uint8_t byte = 0;
+        for(size_t bit = 0; bit < 8 && i + bit < cells; bit++) {
+            if(model->frozen[i + bit]) byte |= (uint8_t)(1 << bit);
+        }
+        chunk[used++] = byte;
+        if(used == CHUNK_BYTES) {
+            if(!checkpoint_put(&out, chunk, used)) return false;
+            used = 0;
+        }
+    }
+    if(used && !checkpoint_put(&out, chunk, used)) return false;
+    
+    // Age map of the frozen cells
+    used = 0;
+    for(size_t i = 0; i < cells; i++) {
+        if(!model->frozen[i]) continue;
+        snowflake_put_u16(chunk + used, model->freeze_step[i]);
+        used += 2;
+        if(used == CHUNK_BYTES) {
+            if(!checkpoint_put(&out, chunk, used)) return false;
+            used = 0;
+        }
+    }
+    if(used && !checkpoint_put(&out, chunk, used)) return false;
+    
+    // Quantized s
+    used = 0;
+    for(size_t i = 0; i < cells; i++) {
+        float s = model->s[i];
+        uint16_t q = s >= 1.0f ? 65535 : (s <= 0.0f ? 0 : (uint16_t)(s * 65535.0f + 0.5f));
+        snowflake_put_u16(chunk + used, q);
+        used += 2;
+        if(used == CHUNK_BYTES) {
+            if(!checkpoint_put(&out, chunk, used)) return false;
+            used = 0;
+        }
+    }
+    if(used && !checkpoint_put(&out, chunk, used)) return false;
+    
+    snowflake_put_u32(chunk, out.checksum);
+    return snowflake_write(writer, chunk, 4);
+}
+
+// ===================================================================
+// Function: Read the payload into the model
+// ===================================================================
+static bool checkpoint_read_payload(SnowflakeModel* model, CheckpointIn* in) {
+    size_t cells = (size_t)model->size * model->size;
+    uint8_t chunk[CHUNK_BYTES];
+    
+    // Refreeze cell by cell so the statistics and the frame follow
+    memset(model->frozen, 0, cells);
+    for(size_t i = 0; i < cells; i++) model->freeze_step[i] = SNOWFLAKE_NOT_FROZEN;
+    memset(&model->stats, 0, sizeof(SnowflakeStats));
+    size_t mask_bytes = (cells + 7) / 8;
+    for(size_t offset = 0; offset < mask_bytes; offset += CHUNK_BYTES) {
+        size_t size = mask_bytes - offset < CHUNK_BYTES ? mask_bytes - offset : CHUNK_BYTES;
+        if(!checkpoint_get(in, chunk, size)) return false;
+        for(size_t i = 0; i < size * 8; i++) {
+            size_t cell = offset * 8 + i;
+            if(cell < cells && (chunk[i / 8] & (1 << (i % 8)))) {
+                snowflake_model_freeze_cell(model, (int)(cell % model->size), (int)(cell / model->size));
+            }
+        }
+    }
+    
+    // The ages follow in mask order
+    size_t frozen = (size_t)model->stats.frozen_total;
+    size_t cell = 0;
+    for(size_t offset = 0; offset < frozen; offset += CHUNK_BYTES / 2) {
+        size_t count = frozen - offset < CHUNK_BYTES / 2 ? frozen - offset : CHUNK_BYTES / 2;
+        if(!checkpoint_get(in, chunk, count * 2)) return false;
+        for(size_t i = 0; i < count; i++) {
+            // A cell cannot have frozen after the step the checkpoint was taken
+            uint16_t age = snowflake_get_u16(chunk + 2 * i);
+            if(age > model->step) return false;
+            while(!model->frozen[cell]) cell++;
+            model->freeze_step[cell++] = age;
+        }
+    }
+    
+    for(size_t offset = 0; offset < cells; offset += CHUNK_BYTES / 2) {
+        size_t count = cells - offset < CHUNK_BYTES / 2 ? cells - offset : CHUNK_BYTES / 2;
+        if(!checkpoint_get(in, chunk, count * 2)) return false;
+        for(size_t i = 0; i < count; i++) {
+            model->s[offset + i] = (float)snowflake_get_u16(chunk + 2 * i) / 65535.0f;
+            model->u[offset + i] = 0.0f;
+        }
+    }
+    
+    uint32_t expected = in->checksum;
+    return snowflake_read(in->reader, chunk, 4) && snowflake_get_u32(chunk) == expected;
+}
+
+// ===================================================================
+// Function: Restore a model from a checkpoint
+// ===================================================================
+bool snowflake_checkpoint_read(SnowflakeModel* model, const SnowflakeReader* reader) {
+    CheckpointIn in = {.reader = reader, .checksum = 2166136261u};
+    uint8_t header[SNOWFLAKE_CHECKPOINT_HEADER_SIZE];
+    if(!checkpoint_get(&in, header, sizeof(header)) || memcmp(header, "SFCK", 4) != 0 ||
+       snowflake_get_u16(header + 4) != SNOWFLAKE_CHECKPOINT_VERSION ||
+       snowflake_get_u16(header + 6) != model->size ||
+       snowflake_get_u32(header + 20) > SNOWFLAKE_NOT_FROZEN - 1) {
+        return false;
+    }
+    
+    SnowflakeParams previous = model->params;
+    uint32_t bits[3];
+    for(int i = 0; i < 3; i++) bits[i] = snowflake_get_u32(header + 8 + 4 * i);
+    memcpy(&model->params.alpha, &bits[0], sizeof(float));
+    memcpy(&model->params.beta, &bits[1], sizeof(float));
+    memcpy(&model->params.gamma, &bits[2], sizeof(float));
+    model->step = (int)snowflake_get_u32(header + 20);
+    
+    if(!checkpoint_read_payload(model, &in)) {
+        model->params = previous;
+        snowflake_model_reset(model);
+        return false;
+    }
+    return true;
+}
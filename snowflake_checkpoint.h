@@ -0,0 +1,45 @@
+#pragma once
+
+// ===================================================================
+// Binary checkpoint of a growing flake
+//
+// Everything the next step depends on, so a session can be resumed
+// with one file read instead of regrowing the flake. Written and read
+// in small chunks straight from / into the model's own arrays.
+//
+// File format (little endian):
+//   header  "SFCK", u16 version, u16 lattice size,
+//           f32 alpha, beta, gamma, u32 step
+//   mask    frozen mask, one bit per cell, row-major, LSB first
+//   ages    u16 freeze step of every frozen cell, row-major
+//   s       u16 per cell, row-major: s * 65535, clamped to [0, 1]
+//   check   u32 FNV-1a of all bytes before it
+// u is not stored: the classify phase rebuilds it from s. The s of a
+// frozen cell is >= 1 but no longer affects growth, so it is clamped.
+// The step is limited to the age map's range, 65534; no age may be
+// later than it.
+// ===================================================================
+#include <stdbool.h>
+#include "snowflake_io.h"
+#include "snowflake_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNOWFLAKE_CHECKPOINT_VERSION 2
+#define SNOWFLAKE_CHECKPOINT_HEADER_SIZE 24
+
+bool snowflake_checkpoint_write(const SnowflakeModel* model, const SnowflakeWriter* writer);
+
+/** Restore a model from a checkpoint of the same lattice size. The
+ * statistics are rebuilt and the freeze callback runs for every frozen
+ * cell. Returns false and leaves the model alone if the header doesn't
+ * match or its step is out of range; a damaged payload, ages later than
+ * the step included, resets the model to the seed.
+ */
+bool snowflake_checkpoint_read(SnowflakeModel* model, const SnowflakeReader* reader);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+
+// ===================================================================
+// App tunables shared with the host tools that mirror the app's
+// behaviour (session replay, differential tests)
+// ===================================================================
+
+#ifndef GRID_SIZE
+#define GRID_SIZE 16        // Grid is 16x16 logical hex cells
+#endif
+#define PAN_STEP 8          // Pixels the viewport moves per arrow press in view mode
+#define BACK_LONG_PRESS_MS 500 // Holding Back longer than this exits
+
+// Parameter limits
+#define ALPHA_MIN 0.5f
+#define ALPHA_MAX 5.0f
+#define ALPHA_STEP 0.1f
+#define ALPHA_INIT 1.0f     // Initial alpha value
+
+#define BETA_MIN 0.1f
+#define BETA_MAX 0.9f
+#define BETA_STEP 0.05f
+#define BETA_INIT 0.5f      // Initial beta value
+
+#define GAMMA_MIN 0.001f
+#define GAMMA_MAX 0.1f
+#define GAMMA_STEP 0.005f
+#define GAMMA_INIT 0.01f    // Initial gamma value
+
+// Live preview
+#define PREVIEW_STEPS 100   // Steps the background preview grows from the seed
@@ -0,0 +1,319 @@
+// Includes
+#include "snowflake_export.h"
+#include "snowflake_gif.h"
+#include <math.h>           // fmaxf
+#include <stdio.h>          // snprintf
+#include <stdlib.h>         // malloc, free
+#include <string.h>         // memcpy, memset, strcmp
+
+#define BMP_HEADER_SIZE 62  // File header, info header, 2-color palette
+#define FIELD_CHUNK 64      // Cells converted per write
+
+static const char* const format_extensions[SNOWFLAKE_EXPORT_FORMAT_COUNT] = {"pbm", "bmp", "png", "pgm", "raw", "gif"};
+
+// ===================================================================
+// Function: Format by file extension
+// ===================================================================
+bool snowflake_export_find_format(const char* name, SnowflakeExportFormat* format) {
+    for(int i = 0; i < SNOWFLAKE_EXPORT_FORMAT_COUNT; i++) {
+        if(strcmp(name, format_extensions[i]) == 0) {
+            *format = (SnowflakeExportFormat)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* snowflake_export_extension(SnowflakeExportFormat format) {
+    return format_extensions[format];
+}
+
+// ===================================================================
+// Function: Image size in pixels
+// ===================================================================
+bool snowflake_export_size(
+    const SnowflakeFrame* frame, const SnowflakeExportOptions* options, int* width, int* height) {
+    if(options->format >= SNOWFLAKE_EXPORT_FORMAT_COUNT || options->zoom >= snowflake_frame_zoom_count() ||
+       options->scale < 1) {
+        return false;
+    }
+    
+    if(options->format == SNOWFLAKE_EXPORT_PGM || options->format == SNOWFLAKE_EXPORT_RAW) {
+        *width = *height = snowflake_model_get_size(frame->model);
+        return true;
+    }
+    
+    SnowflakeFrameRect rect;
+    snowflake_frame_image_rect(frame, options->zoom, options->whole_lattice, &rect);
+    if(rect.width > SNOWFLAKE_EXPORT_MAX_SIDE / options->scale ||
+       rect.height > SNOWFLAKE_EXPORT_MAX_SIDE / options->scale) {
+        return false;
+    }
+    *width = rect.width * options->scale;
+    *height = rect.height * options->scale;
+    return true;
+}
+
+// ===================================================================
+// Function: Stretch a rendered row by scale, in place from the right
+// Every destination bit lies at or right of its source bit, so sources
+// still to be read are never overwritten.
+// ===================================================================
+static void row_scale(uint8_t* row, int width, int scale) {
+    if(scale == 1) return;
+    for(int x = width * scale - 1; x >= 0; x--) {
+        int src = x / scale;
+        uint8_t mask = (uint8_t)(0x80 >> (x & 7));
+        if(row[src >> 3] & (0x80 >> (src & 7))) {
+            row[x >> 3] |= mask;
+        } else {
+            row[x >> 3] &= (uint8_t)~mask;
+        }
+    }
+}
+
+// ===================================================================
+// Function: CRC-32 (PNG chunks) and Adler-32 (zlib stream)
+// Nibble table: 64 bytes instead of the usual 1 KB
+// ===================================================================
+static const uint32_t crc_nibbles[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t* data, size_t size) {
+    for(size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ crc_nibbles[crc & 0x0F];
+        crc = (crc >> 4) ^ crc_nibbles[crc & 0x0F];
+    }
+    return crc;
+}
+
+static uint32_t adler32_update(uint32_t adler, const uint8_t* data, size_t size) {
+    uint32_t a = adler & 0xFFFF, b = adler >> 16;
+    for(size_t i = 0; i < size; i++) {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+static void put_u32_be(uint8_t* dst, uint32_t value) {
+    dst[0] = (uint8_t)(value >> 24);
+    dst[1] = (uint8_t)(value >> 16);
+    dst[2] = (uint8_t)(value >> 8);
+    dst[3] = (uint8_t)value;
+}
+
+// ===================================================================
+// Function: Write a whole PNG chunk: length, type, data, CRC
+// ===================================================================
+static bool png_chunk(const SnowflakeWriter* writer, const char* type, const uint8_t* data, size_t size) {
+    uint8_t head[8], tail[4];
+    put_u32_be(head, (uint32_t)size);
+    memcpy(head + 4, type, 4);
+    put_u32_be(tail, crc32_update(crc32_update(0xFFFFFFFF, head + 4, 4), data, size) ^ 0xFFFFFFFF);
+    // No data write for empty chunks such as IEND: writers need not accept NULL
+    return snowflake_write(writer, head, 8) && (size == 0 || snowflake_write(writer, data, size)) &&
+           snowflake_write(writer, tail, 4);
+}
+
+// ===================================================================
+// Function: Headers
+// ===================================================================
+static bool write_header(const SnowflakeWriter* writer, SnowflakeExportFormat format, int width, int height) {
+    if(format == SNOWFLAKE_EXPORT_PBM) {
+        char header[32];
+        int length = snprintf(header, sizeof(header), "P4\n%d %d\n", width, height);
+        return snowflake_write(writer, header, (size_t)length);
+    }
+    
+    if(format == SNOWFLAKE_EXPORT_BMP) {
+        uint32_t row_bytes = (uint32_t)((width + 31) / 32 * 4);
+        uint8_t header[BMP_HEADER_SIZE] = {'B', 'M'};
+        snowflake_put_u32(header + 2, BMP_HEADER_SIZE + row_bytes * (uint32_t)height);
+        snowflake_put_u32(header + 10, BMP_HEADER_SIZE);
+        snowflake_put_u32(header + 14, 40);
+        snowflake_put_u32(header + 18, (uint32_t)width);
+        snowflake_put_u32(header + 22, (uint32_t)-height);  // Negative height: rows top-down
+        snowflake_put_u16(header + 26, 1);                  // Planes
+        snowflake_put_u16(header + 28, 1);                  // Bits per pixel
+        snowflake_put_u32(header + 34, row_bytes * (uint32_t)height);
+        snowflake_put_u32(header + 38, 2835);               // 72 dpi
+        snowflake_put_u32(header + 42, 2835);
+        snowflake_put_u32(header + 46, 2);                  // Palette entries
+        memset(header + 54, 0xFF, 3);                       // 0 = white, 1 = black (BGRA)
+        return snowflake_write(writer, header, BMP_HEADER_SIZE);
+    }
+    
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    static const uint8_t palette[6] = {0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00};
+    uint8_t ihdr[13];
+    put_u32_be(ihdr, (uint32_t)width);
+    put_u32_be(ihdr + 4, (uint32_t)height);
+    ihdr[8] = 1;   // Bit depth
+    ihdr[9] = 3;   // Palette color
+    ihdr[10] = 0;  // Deflate
+    ihdr[11] = 0;  // Adaptive filtering, every row uses filter 0
+    ihdr[12] = 0;  // Not interlaced
+    return snowflake_write(writer, signature, sizeof(signature)) && png_chunk(writer, "IHDR", ihdr, sizeof(ihdr)) &&
+           png_chunk(writer, "PLTE", palette, sizeof(palette));
+}
+
+// ===================================================================
+// Function: One PNG row as an IDAT chunk holding one stored block
+// The first row also carries the zlib header, the last one the final
+// block flag and the Adler-32 of all rows.
+// ===================================================================
+static bool png_row(const SnowflakeWriter* writer, const uint8_t* data, size_t size, bool first, bool last,
+                    uint32_t* adler) {
+    uint8_t head[8 + 2 + 5], tail[8];
+    size_t head_size = 8, tail_size = 0;
+    if(first) {
+        head[head_size++] = 0x78;  // Deflate, 32 KB window
+        head[head_size++] = 0x01;  // No preset dictionary, check bits
+    }
+    head[head_size++] = last ? 1 : 0;  // BFINAL, BTYPE 00 = stored
+    snowflake_put_u16(head + head_size, (uint16_t)size);
+    snowflake_put_u16(head + head_size + 2, (uint16_t)~size);
+    head_size += 4;
+    
+    *adler = adler32_update(*adler, data, size);
+    if(last) {
+        put_u32_be(tail, *adler);
+        tail_size = 4;
+    }
+    put_u32_be(head, (uint32_t)(head_size - 8 + size + tail_size));
+    memcpy(head + 4, "IDAT", 4);
+    
+    uint32_t crc = crc32_update(0xFFFFFFFF, head + 4, head_size - 4);
+    crc = crc32_update(crc, data, size);
+    crc = crc32_update(crc, tail, tail_size) ^ 0xFFFFFFFF;
+    put_u32_be(tail + tail_size, crc);
+    return snowflake_write(writer, head, head_size) && snowflake_write(writer, data, size) &&
+           snowflake_write(writer, tail, tail_size + 4);
+}
+
+// ===================================================================
+// Function: Render and stream the image
+// The row buffer starts with the PNG filter byte and is padded to the
+// 4 byte multiple BMP rows need.
+// ===================================================================
+static bool image_write(const SnowflakeFrame* frame, const SnowflakeExportOptions* options,
+                        const SnowflakeWriter* writer, int width, int height) {
+    size_t stride = (size_t)(width + 7) / 8;
+    size_t bmp_stride = (size_t)(width + 31) / 32 * 4;
+    uint8_t* buffer = malloc(1 + bmp_stride);
+    if(!buffer) return false;
+    uint8_t* row = buffer + 1;
+    
+    SnowflakeFrameRect rect;
+    snowflake_frame_image_rect(frame, options->zoom, options->whole_lattice, &rect);
+    bool ok = write_header(writer, options->format, width, height);
+    
+    uint32_t adler = 1;
+    for(int y = 0; ok && y < rect.height; y++) {
+        // Every sprite row is repeated scale times
+        snowflake_frame_render_row(frame, options->zoom, options->grid, rect.x, rect.y + y, rect.width, row);
+        row_scale(row, rect.width, options->scale);
+        if(width % 8) row[stride - 1] &= (uint8_t)(0xFF00 >> (width % 8));
+        memset(row + stride, 0, bmp_stride - stride);
+        buffer[0] = 0;  // PNG filter: none
+        
+        for(int r = 0; ok && r < options->scale; r++) {
+            if(options->format == SNOWFLAKE_EXPORT_PBM) {
+                ok = snowflake_write(writer, row, stride);
+            } else if(options->format == SNOWFLAKE_EXPORT_BMP) {
+                ok = snowflake_write(writer, row, bmp_stride);
+            } else {
+                bool first = y == 0 && r == 0;
+                bool last = y == rect.height - 1 && r == options->scale - 1;
+                ok = png_row(writer, buffer, 1 + stride, first, last, &adler);
+            }
+        }
+    }
+    if(ok && options->format == SNOWFLAKE_EXPORT_PNG) ok = png_chunk(writer, "IEND", NULL, 0);
+    
+    free(buffer);
+    return ok;
+}
+
+// ===================================================================
+// Function: Stream the s field as a 16-bit PGM or raw floats
+// Samples are converted in chunks of FIELD_CHUNK cells on the stack.
+// ===================================================================
+static bool field_write(const SnowflakeModel* model, const SnowflakeExportOptions* options,
+                        const SnowflakeWriter* writer) {
+    int size = snowflake_model_get_size(model);
+    size_t cells = (size_t)size * size;
+    const float* s = snowflake_model_get_s(model);
+    bool pgm = options->format == SNOWFLAKE_EXPORT_PGM;
+    
+    float low = options->range_min, high = options->range_max;
+    if(pgm && high <= low) {
+        low = 0.0f;
+        high = 0.0f;
+        for(size_t i = 0; i < cells; i++) high = fmaxf(high, s[i]);
+        if(high <= low) high = 1.0f;
+    }
+    
+    bool ok;
+    if(pgm) {
+        char header[32];
+        int length = snprintf(header, sizeof(header), "P5\n%d %d\n65535\n", size, size);
+        ok = snowflake_write(writer, header, (size_t)length);
+    } else {
+        const SnowflakeParams* params = snowflake_model_get_params(model);
+        uint8_t header[SNOWFLAKE_EXPORT_RAW_HEADER_SIZE];
+        uint32_t bits[3];
+        memcpy(&bits[0], &params->alpha, sizeof(uint32_t));
+        memcpy(&bits[1], &params->beta, sizeof(uint32_t));
+        memcpy(&bits[2], &params->gamma, sizeof(uint32_t));
+        memcpy(header, "SFSD", 4);
+        snowflake_put_u16(header + 4, SNOWFLAKE_EXPORT_RAW_VERSION);
+        snowflake_put_u16(header + 6, (uint16_t)size);
+        snowflake_put_u32(header + 8, bits[0]);
+        snowflake_put_u32(header + 12, bits[1]);
+        snowflake_put_u32(header + 16, bits[2]);
+        snowflake_put_u32(header + 20, (uint32_t)snowflake_model_get_step(model));
+        ok = snowflake_write(writer, header, sizeof(header));
+    }
+    
+    // PGM samples are big endian, raw floats little endian
+    float scale = 65535.0f / (high - low);
+    uint8_t chunk[FIELD_CHUNK * 4];
+    for(size_t start = 0; ok && start < cells; start += FIELD_CHUNK) {
+        size_t count = cells - start < FIELD_CHUNK ? cells - start : FIELD_CHUNK;
+        for(size_t i = 0; i < count; i++) {
+            float value = s[start + i];
+            if(pgm) {
+                float level = (value - low) * scale;
+                uint16_t q = level >= 65535.0f ? 65535 : (level <= 0.0f ? 0 : (uint16_t)(level + 0.5f));
+                chunk[2 * i] = (uint8_t)(q >> 8);
+                chunk[2 * i + 1] = (uint8_t)q;
+            } else {
+                uint32_t bits;
+                memcpy(&bits, &value, sizeof(uint32_t));
+                snowflake_put_u32(chunk + 4 * i, bits);
+            }
+        }
+        ok = snowflake_write(writer, chunk, count * (pgm ? 2 : 4));
+    }
+    return ok;
+}
+
+// ===================================================================
+// Function: Write the image or field
+// ===================================================================
+bool snowflake_export_write(
+    const SnowflakeFrame* frame, const SnowflakeExportOptions* options, const SnowflakeWriter* writer) {
+    int width, height;
+    if(!snowflake_export_size(frame, options, &width, &height)) return false;
+    
+    if(options->format == SNOWFLAKE_EXPORT_PGM || options->format == SNOWFLAKE_EXPORT_RAW) {
+        return field_write(frame->model, options, writer);
+    }
+    if(options->format == SNOWFLAKE_EXPORT_GIF) return snowflake_gif_write(frame, options, writer);
+    return image_write(frame, options, writer, width, height);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+// ===================================================================
+// Export of the rendered flake and of its s field
+//
+// Images: renders the hex lattice with the frame's sprites at any
+// zoom, scaled up by an integer factor, and streams it row by row to a
+// writer as PBM (P4), BMP (top-down, 2-color palette) or PNG (palette,
+// stored deflate blocks, no compression). Only one output row is
+// buffered, so the image can be far larger than the screen or the RAM.
+// Frozen cells are black on white; the frame's rewind step and growth
+// rings apply as on screen. GIF animates the growth up to the shown
+// step (snowflake_gif.h).
+//
+// Fields: the water content s of every cell, one sample per cell in
+// lattice order (row-major, odd columns half a cell lower in the hex
+// layout), for analysis off the device. s is the model's current one,
+// whatever step the frame shows; frozen cells hold 1.0 after a resume.
+//   PGM  16-bit P5, s mapped linearly from [range_min, range_max] to
+//        [0, 65535] and clamped
+//   RAW  header "SFSD", u16 version, u16 lattice size, f32 alpha,
+//        beta, gamma, u32 step (as a checkpoint), then f32 s per cell,
+//        all little endian
+//
+// Portable C like the model, so host tools export the same files.
+// ===================================================================
+#include <stdbool.h>
+#include <stdint.h>
+#include "snowflake_frame.h"
+#include "snowflake_io.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNOWFLAKE_EXPORT_MAX_SIDE 32768  // Pixels per image side, keeps a row within 4 KB
+#define SNOWFLAKE_EXPORT_RAW_VERSION 1
+#define SNOWFLAKE_EXPORT_RAW_HEADER_SIZE 24
+
+typedef enum {
+    SNOWFLAKE_EXPORT_PBM,
+    SNOWFLAKE_EXPORT_BMP,
+    SNOWFLAKE_EXPORT_PNG,
+    SNOWFLAKE_EXPORT_PGM,  // s field
+    SNOWFLAKE_EXPORT_RAW,  // s field
+    SNOWFLAKE_EXPORT_GIF,  // Animated growth (snowflake_gif.h)
+    SNOWFLAKE_EXPORT_FORMAT_COUNT
+} SnowflakeExportFormat;
+
+typedef struct {
+    SnowflakeExportFormat format;
+    uint8_t zoom;          // Hexagon sprite, 0 = largest (snowflake_frame_zoom_count)
+    uint8_t scale;         // Image pixels per sprite pixel in both directions, at least 1
+    bool whole_lattice;    // All cells instead of the crystal and its boundary ring
+    bool grid;             // Mark the center of empty cells, as on screen
+    float range_min;       // s shown as 0 in a PGM
+    float range_max;       // s shown as 65535; not above range_min: the largest s
+    uint16_t frame_steps;  // Steps per GIF frame, 0 = about SNOWFLAKE_GIF_FRAMES frames
+} SnowflakeExportOptions;
+
+/** Format by file extension ("pbm", "bmp", "png", "pgm", "raw", "gif").
+ * Returns false if unknown.
+ */
+bool snowflake_export_find_format(const char* name, SnowflakeExportFormat* format);
+
+const char* snowflake_export_extension(SnowflakeExportFormat format);
+
+/** Image size in pixels, the lattice size for fields. Returns false if the options are invalid or
+ * a side exceeds SNOWFLAKE_EXPORT_MAX_SIDE.
+ */
+bool snowflake_export_size(
+    const SnowflakeFrame* frame, const SnowflakeExportOptions* options, int* width, int* height);
+
+/** Write the image or field. Allocates one row; returns false if out of memory,
+ * on invalid options or when the writer fails.
+ */
+bool snowflake_export_write(
+    const SnowflakeFrame* frame, const SnowflakeExportOptions* options, const SnowflakeWriter* writer);
+
+#ifdef __cplusplus
+}
+#endif
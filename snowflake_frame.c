@@ -0,0 +1,459 @@
+// Includes
+#include "snowflake_frame.h"
+#include <stdlib.h>         // abs
+#include <string.h>         // memset, memmove
+
+// ===================================================================
+// Hex sprite atlas
+// Pre-rasterized flat-top hexagons, one row bitmask per sprite row
+// (bit 0 = leftmost pixel). Sprite width and height double as column
+// and row pitch; odd columns are offset downward by height/2.
+// Empty cells only show their center pixel (for grid visualization).
+// ===================================================================
+#define HEX_SPRITE_MAX_ROWS 7
+
+typedef struct {
+    uint8_t width;
+    uint8_t height;
+    uint8_t center_x;  // Center pixel C inside the sprite
+    uint8_t center_y;
+    uint16_t filled[HEX_SPRITE_MAX_ROWS];
+    uint16_t empty[HEX_SPRITE_MAX_ROWS];
+} HexSprite;
+
+// Ordered from the largest to the smallest zoom
+static const HexSprite hex_sprites[] = {
+    // 9x7
+    {9, 7, 4, 3,
+     {0x038, 0x07C, 0x0FE, 0x1FF, 0x0FE, 0x07C, 0x038},
+     {0x000, 0x000, 0x000, 0x010, 0x000, 0x000, 0x000}},
+    // 7x5
+    {7, 5, 3, 2,
+     {0x1C, 0x3E, 0x7F, 0x3E, 0x1C},
+     {0x00, 0x00, 0x08, 0x00, 0x00}},
+    // 5x3:  0,X,X,X,0 / X,X,C,X,X / 0,X,X,X,0
+    {5, 3, 2, 1,
+     {0x0E, 0x1F, 0x0E},
+     {0x00, 0x04, 0x00}},
+    // 3x2
+    {3, 2, 1, 0,
+     {0x7, 0x7},
+     {0x2, 0x0}},
+};
+
+#define HEX_ZOOM_COUNT (sizeof(hex_sprites) / sizeof(hex_sprites[0]))
+
+// ===================================================================
+// Function: Integer division rounding towards negative infinity
+// ===================================================================
+static inline int floor_div(int a, int b) {
+    return (a >= 0) ? (a / b) : -((-a + b - 1) / b);
+}
+
+// ===================================================================
+// Function: Map logical hex cell to its center pixel in the frame
+// The seed cell sits at the frame center, shifted by the pan offset
+// ===================================================================
+static void get_hex_center_pixel(
+    const SnowflakeViewport* view, int size, int hex_x, int hex_y, int* pixel_x, int* pixel_y) {
+    const HexSprite* sprite = &hex_sprites[view->zoom];
+    int center = size / 2;
+    *pixel_x = SNOWFLAKE_FRAME_WIDTH / 2 + (hex_x - center) * sprite->width - view->x;
+    *pixel_y = SNOWFLAKE_FRAME_HEIGHT / 2 + (hex_y - center) * sprite->height - view->y;
+    
+    // Offset odd columns downward for hexagonal packing (relative to the seed column)
+    *pixel_y += ((hex_x & 1) - (center & 1)) * (sprite->height / 2);
+}
+
+// ===================================================================
+// Function: OR one sprite row set into the frame bitmap (clipped)
+// Dithered sprites only keep the pixels of a screen-aligned checkerboard.
+// ===================================================================
+static void frame_blit_sprite(
+    uint8_t* frame_bits, int left, int top, int width, int height, const uint16_t* rows, bool dithered) {
+    if(left >= SNOWFLAKE_FRAME_WIDTH || left + width <= 0) return;
+    
+    for(int r = 0; r < height; r++) {
+        int y = top + r;
+        if(y < 0 || y >= SNOWFLAKE_FRAME_HEIGHT || rows[r] == 0) continue;
+        
+        uint32_t bits = rows[r];
+        int x = left;
+        if(x < 0) {
+            bits >>= -x;
+            x = 0;
+        }
+        if(SNOWFLAKE_FRAME_WIDTH - x < 32) bits &= (1UL << (SNOWFLAKE_FRAME_WIDTH - x)) - 1;
+        if(dithered) bits &= ((x + y) & 1) ? 0xAAAAAAAAUL : 0x55555555UL;
+        
+        bits <<= x % 8;
+        uint8_t* dst = &frame_bits[y * SNOWFLAKE_FRAME_STRIDE + x / 8];
+        for(int b = x / 8; bits && b < SNOWFLAKE_FRAME_STRIDE; b++) {
+            *dst++ |= (uint8_t)bits;
+            bits >>= 8;
+        }
+    }
+}
+
+// ===================================================================
+// Function: Whether a cell is drawn filled, and dithered as a growth ring
+// ===================================================================
+static bool cell_filled(const SnowflakeFrame* frame, uint16_t freeze_step, bool* dithered) {
+    bool filled = freeze_step != SNOWFLAKE_NOT_FROZEN &&
+                  (frame->rewind_step == SNOWFLAKE_FRAME_LIVE || freeze_step <= frame->rewind_step);
+    *dithered = filled && frame->ring_steps && (freeze_step / frame->ring_steps) % 2 == 1;
+    return filled;
+}
+
+// ===================================================================
+// Function: Draw one hexagonal cell into the cached frame bitmap
+// Frozen cells never thaw, so sprites are only ever ORed in. A rewound
+// frame draws the cells frozen after its step as empty.
+// ===================================================================
+static void frame_draw_cell(SnowflakeFrame* frame, int hex_x, int hex_y) {
+    const HexSprite* sprite = &hex_sprites[frame->view.zoom];
+    int size = snowflake_model_get_size(frame->model);
+    int center_px, center_py;
+    get_hex_center_pixel(&frame->view, size, hex_x, hex_y, &center_px, &center_py);
+    
+    uint16_t freeze_step = snowflake_model_get_freeze_steps(frame->model)[hex_y * size + hex_x];
+    bool dithered;
+    bool filled = cell_filled(frame, freeze_step, &dithered);
+    frame_blit_sprite(
+        frame->bits,
+        center_px - sprite->center_x,
+        center_py - sprite->center_y,
+        sprite->width,
+        sprite->height,
+        filled ? sprite->filled : sprite->empty,
+        dithered);
+}
+
+// ===================================================================
+// Function: Draw all cells whose sprite intersects a frame rectangle
+// The column and row ranges are culled up front, so only cells that
+// can touch [x0, x1) x [y0, y1) are visited.
+// ===================================================================
+static void frame_draw_region(SnowflakeFrame* frame, int x0, int y0, int x1, int y1) {
+    const HexSprite* sprite = &hex_sprites[frame->view.zoom];
+    int w = sprite->width;
+    int h = sprite->height;
+    int size = snowflake_model_get_size(frame->model);
+    int center = size / 2;
+    
+    // Left edge of column 0, top edge of row 0 for the upper column parity
+    int base_x = SNOWFLAKE_FRAME_WIDTH / 2 - center * w - frame->view.x - sprite->center_x;
+    int base_y = SNOWFLAKE_FRAME_HEIGHT / 2 - center * h - frame->view.y - sprite->center_y -
+                 (center & 1) * (h / 2);
+    
+    int col_min = floor_div(x0 - base_x - w, w) + 1;
+    int col_max = floor_div(x1 - base_x - 1, w);
+    int row_min = floor_div(y0 - base_y - h / 2 - h, h) + 1;
+    int row_max = floor_div(y1 - base_y - 1, h);
+    
+    if(col_min < 0) col_min = 0;
+    if(row_min < 0) row_min = 0;
+    if(col_max > size - 1) col_max = size - 1;
+    if(row_max > size - 1) row_max = size - 1;
+    
+    for(int y = row_min; y <= row_max; y++) {
+        for(int x = col_min; x <= col_max; x++) {
+            frame_draw_cell(frame, x, y);
+        }
+    }
+}
+
+// ===================================================================
+// Function: Re-render the whole frame with the current viewport
+// ===================================================================
+void snowflake_frame_rebuild(SnowflakeFrame* frame) {
+    memset(frame->bits, 0, SNOWFLAKE_FRAME_STRIDE * SNOWFLAKE_FRAME_HEIGHT);
+    frame_draw_region(frame, 0, 0, SNOWFLAKE_FRAME_WIDTH, SNOWFLAKE_FRAME_HEIGHT);
+}
+
+// ===================================================================
+// Function: Pan the viewport by (dx, dy) pixels
+// The part of the frame that stays visible is shifted in place; only
+// the exposed strips are drawn again. Dithered rings follow the screen
+// parity, so a shift by an odd dx + dy (a pan clamped at the lattice
+// edge) would put kept pixels out of phase: those redraw everything.
+// ===================================================================
+static void frame_shift(SnowflakeFrame* frame, int dx, int dy) {
+    frame->view.x += dx;
+    frame->view.y += dy;
+    
+    if(abs(dx) >= SNOWFLAKE_FRAME_WIDTH || abs(dy) >= SNOWFLAKE_FRAME_HEIGHT || ((dx + dy) & 1)) {
+        snowflake_frame_rebuild(frame);
+        return;
+    }
+    
+    uint8_t* bits = frame->bits;
+    
+    // Vertical: move whole rows, clear the exposed ones
+    if(dy > 0) {
+        memmove(bits, bits + dy * SNOWFLAKE_FRAME_STRIDE, (SNOWFLAKE_FRAME_HEIGHT - dy) * SNOWFLAKE_FRAME_STRIDE);
+        memset(bits + (SNOWFLAKE_FRAME_HEIGHT - dy) * SNOWFLAKE_FRAME_STRIDE, 0, dy * SNOWFLAKE_FRAME_STRIDE);
+    } else if(dy < 0) {
+        memmove(bits - dy * SNOWFLAKE_FRAME_STRIDE, bits, (SNOWFLAKE_FRAME_HEIGHT + dy) * SNOWFLAKE_FRAME_STRIDE);
+        memset(bits, 0, -dy * SNOWFLAKE_FRAME_STRIDE);
+    }
+    
+    // Horizontal: shift each row as a little-endian bit string
+    if(dx != 0) {
+        int byte_shift = abs(dx) / 8;
+        int bit_shift = abs(dx) % 8;
+        for(int y = 0; y < SNOWFLAKE_FRAME_HEIGHT; y++) {
+            uint8_t* row = bits + y * SNOWFLAKE_FRAME_STRIDE;
+            if(dx > 0) {
+                for(int i = 0; i < SNOWFLAKE_FRAME_STRIDE; i++) {
+                    int src = i + byte_shift;
+                    uint8_t lo = (src < SNOWFLAKE_FRAME_STRIDE) ? row[src] : 0;
+                    uint8_t hi = (src + 1 < SNOWFLAKE_FRAME_STRIDE) ? row[src + 1] : 0;
+                    row[i] = bit_shift ? (uint8_t)((lo >> bit_shift) | (hi << (8 - bit_shift))) : lo;
+                }
+            } else {
+                for(int i = SNOWFLAKE_FRAME_STRIDE - 1; i >= 0; i--) {
+                    int src = i - byte_shift;
+                    uint8_t hi = (src >= 0) ? row[src] : 0;
+                    uint8_t lo = (src - 1 >= 0) ? row[src - 1] : 0;
+                    row[i] = bit_shift ? (uint8_t)((hi << bit_shift) | (lo >> (8 - bit_shift))) : hi;
+                }
+            }
+            if(SNOWFLAKE_FRAME_WIDTH % 8) row[SNOWFLAKE_FRAME_STRIDE - 1] &= (uint8_t)((1 << (SNOWFLAKE_FRAME_WIDTH % 8)) - 1);
+        }
+    }
+    
+    // Redraw the exposed strips
+    if(dx > 0) frame_draw_region(frame, SNOWFLAKE_FRAME_WIDTH - dx, 0, SNOWFLAKE_FRAME_WIDTH, SNOWFLAKE_FRAME_HEIGHT);
+    if(dx < 0) frame_draw_region(frame, 0, 0, -dx, SNOWFLAKE_FRAME_HEIGHT);
+    if(dy > 0) frame_draw_region(frame, 0, SNOWFLAKE_FRAME_HEIGHT - dy, SNOWFLAKE_FRAME_WIDTH, SNOWFLAKE_FRAME_HEIGHT);
+    if(dy < 0) frame_draw_region(frame, 0, 0, SNOWFLAKE_FRAME_WIDTH, -dy);
+}
+
+// ===================================================================
+// Function: Pan by a step, keeping part of the lattice in view
+// ===================================================================
+void snowflake_frame_pan(SnowflakeFrame* frame, int dx, int dy) {
+    const HexSprite* sprite = &hex_sprites[frame->view.zoom];
+    int size = snowflake_model_get_size(frame->model);
+    int limit_x = size * sprite->width / 2;
+    int limit_y = size * sprite->height / 2;
+    
+    int x = frame->view.x + dx;
+    int y = frame->view.y + dy;
+    if(x > limit_x) x = limit_x;
+    if(x < -limit_x) x = -limit_x;
+    if(y > limit_y) y = limit_y;
+    if(y < -limit_y) y = -limit_y;
+    
+    frame->view.auto_zoom = false;
+    frame_shift(frame, x - frame->view.x, y - frame->view.y);
+}
+
+// ===================================================================
+// Function: Step to the next zoom level, keeping the frame center
+// on the same spot of the lattice
+// ===================================================================
+void snowflake_frame_cycle_zoom(SnowflakeFrame* frame) {
+    const HexSprite* old_sprite = &hex_sprites[frame->view.zoom];
+    frame->view.zoom = (frame->view.zoom + 1) % HEX_ZOOM_COUNT;
+    const HexSprite* new_sprite = &hex_sprites[frame->view.zoom];
+    
+    frame->view.x = frame->view.x * new_sprite->width / old_sprite->width;
+    frame->view.y = frame->view.y * new_sprite->height / old_sprite->height;
+    frame->view.auto_zoom = false;
+    snowflake_frame_rebuild(frame);
+}
+
+// ===================================================================
+// Function: Check whether the crystal plus its boundary ring fits the
+// frame at the given zoom with the seed centered
+// ===================================================================
+static bool zoom_fits(const SnowflakeStats* stats, int size, uint8_t zoom) {
+    const HexSprite* sprite = &hex_sprites[zoom];
+    SnowflakeViewport view = {.zoom = zoom, .auto_zoom = true, .x = 0, .y = 0};
+    int left, top, right, bottom, unused;
+    get_hex_center_pixel(&view, size, stats->min_x - 1, stats->min_y - 1, &left, &unused);
+    get_hex_center_pixel(&view, size, stats->max_x + 1, stats->max_y + 1, &right, &unused);
+    
+    // Rows are checked on the lower and upper envelope of both column parities
+    int center = size / 2;
+    top = SNOWFLAKE_FRAME_HEIGHT / 2 + (stats->min_y - 1 - center) * sprite->height - sprite->height / 2;
+    bottom = SNOWFLAKE_FRAME_HEIGHT / 2 + (stats->max_y + 1 - center) * sprite->height + sprite->height / 2;
+    
+    return left - sprite->center_x >= 0 &&
+           right - sprite->center_x + sprite->width <= SNOWFLAKE_FRAME_WIDTH &&
+           top - sprite->center_y >= 0 &&
+           bottom - sprite->center_y + sprite->height <= SNOWFLAKE_FRAME_HEIGHT;
+}
+
+// ===================================================================
+// Function: Pick the largest zoom that shows the whole crystal
+// The crystal only grows, so the zoom only steps down during a run and
+// the frame is rebuilt at most once per zoom level. A viewport the
+// user has zoomed or panned is left alone.
+// ===================================================================
+void snowflake_frame_update_zoom(SnowflakeFrame* frame, bool force_rebuild) {
+    if(!frame->view.auto_zoom) {
+        if(force_rebuild) snowflake_frame_rebuild(frame);
+        return;
+    }
+    
+    uint8_t zoom = HEX_ZOOM_COUNT - 1;
+    for(uint8_t i = 0; i < HEX_ZOOM_COUNT; i++) {
+        if(zoom_fits(snowflake_model_get_stats(frame->model), snowflake_model_get_size(frame->model), i)) {
+            zoom = i;
+            break;
+        }
+    }
+    
+    if(zoom != frame->view.zoom || force_rebuild) {
+        frame->view.zoom = zoom;
+        snowflake_frame_rebuild(frame);
+    }
+}
+
+// ===================================================================
+// Function: Freeze callback, draws the new cell into the frame
+// ===================================================================
+static void frame_on_freeze(void* context, int x, int y) {
+    frame_draw_cell((SnowflakeFrame*)context, x, y);
+}
+
+// ===================================================================
+// Function: Attach a frame to a model
+// ===================================================================
+void snowflake_frame_init(SnowflakeFrame* frame, SnowflakeModel* model) {
+    frame->model = model;
+    frame->rewind_step = SNOWFLAKE_FRAME_LIVE;
+    frame->rewind_frozen = 0;
+    frame->ring_steps = 0;
+    snowflake_model_set_freeze_callback(model, frame_on_freeze, frame);
+}
+
+// ===================================================================
+// Function: Auto zoom, centered, freshly rendered
+// ===================================================================
+void snowflake_frame_reset(SnowflakeFrame* frame) {
+    frame->rewind_step = SNOWFLAKE_FRAME_LIVE;
+    frame->view.zoom = 0;
+    frame->view.auto_zoom = true;
+    frame->view.x = 0;
+    frame->view.y = 0;
+    snowflake_frame_update_zoom(frame, true);
+}
+
+// ===================================================================
+// Function: Copy bitmap and viewport
+// ===================================================================
+void snowflake_frame_copy(SnowflakeFrame* dst, const SnowflakeFrame* src) {
+    memcpy(dst->bits, src->bits, SNOWFLAKE_FRAME_BYTES);
+    dst->view = src->view;
+    dst->rewind_step = src->rewind_step;
+    dst->rewind_frozen = src->rewind_frozen;
+    dst->ring_steps = src->ring_steps;
+}
+
+// ===================================================================
+// Function: Show the crystal as it was after an earlier step
+// O(cells): one pass over the age map for the count, one rebuild
+// ===================================================================
+void snowflake_frame_rewind(SnowflakeFrame* frame, int step) {
+    if(step != SNOWFLAKE_FRAME_LIVE && step >= snowflake_model_get_step(frame->model)) {
+        step = SNOWFLAKE_FRAME_LIVE;
+    }
+    if(step < SNOWFLAKE_FRAME_LIVE) step = 0;
+    if(step == frame->rewind_step) return;
+    
+    frame->rewind_step = step;
+    frame->rewind_frozen = step == SNOWFLAKE_FRAME_LIVE ? 0 : snowflake_model_count_frozen_at(frame->model, step);
+    snowflake_frame_rebuild(frame);
+}
+
+// ===================================================================
+// Function: Turn growth ring shading on or off
+// ===================================================================
+void snowflake_frame_set_rings(SnowflakeFrame* frame, uint16_t steps) {
+    if(steps == frame->ring_steps) return;
+    frame->ring_steps = steps;
+    snowflake_frame_rebuild(frame);
+}
+
+// ===================================================================
+// Function: Number of zoom levels
+// ===================================================================
+uint8_t snowflake_frame_zoom_count(void) {
+    return HEX_ZOOM_COUNT;
+}
+
+// ===================================================================
+// Function: Image rectangle of a range of cells, the crystal or the
+// whole lattice
+// Rows are taken on the envelope of both column parities.
+// ===================================================================
+void snowflake_frame_cells_rect(
+    const SnowflakeFrame* frame, uint8_t zoom, int min_x, int min_y, int max_x, int max_y, SnowflakeFrameRect* rect) {
+    const HexSprite* sprite = &hex_sprites[zoom];
+    int center = snowflake_model_get_size(frame->model) / 2;
+    rect->x = (min_x - center) * sprite->width - sprite->center_x;
+    rect->y = (min_y - center) * sprite->height - (center & 1) * (sprite->height / 2) - sprite->center_y;
+    rect->width = (max_x - min_x + 1) * sprite->width;
+    rect->height = (max_y - min_y + 1) * sprite->height + sprite->height / 2;
+}
+
+void snowflake_frame_image_rect(
+    const SnowflakeFrame* frame, uint8_t zoom, bool whole_lattice, SnowflakeFrameRect* rect) {
+    int size = snowflake_model_get_size(frame->model);
+    int min_x = 0, min_y = 0, max_x = size - 1, max_y = size - 1;
+    if(!whole_lattice) {
+        const SnowflakeStats* stats = snowflake_model_get_stats(frame->model);
+        if(stats->min_x - 1 > min_x) min_x = stats->min_x - 1;
+        if(stats->min_y - 1 > min_y) min_y = stats->min_y - 1;
+        if(stats->max_x + 1 < max_x) max_x = stats->max_x + 1;
+        if(stats->max_y + 1 < max_y) max_y = stats->max_y + 1;
+    }
+    snowflake_frame_cells_rect(frame, zoom, min_x, min_y, max_x, max_y, rect);
+}
+
+// ===================================================================
+// Function: Render one image row
+// Row pitch equals sprite height, so every column has exactly one cell
+// whose sprite crosses the row.
+// ===================================================================
+void snowflake_frame_render_row(
+    const SnowflakeFrame* frame, uint8_t zoom, bool grid, int x, int y, int width, uint8_t* row) {
+    const HexSprite* sprite = &hex_sprites[zoom];
+    int w = sprite->width;
+    int h = sprite->height;
+    int size = snowflake_model_get_size(frame->model);
+    int center = size / 2;
+    const uint16_t* freeze_steps = snowflake_model_get_freeze_steps(frame->model);
+    
+    memset(row, 0, (size_t)(width + 7) / 8);
+    
+    int col_min = floor_div(x + sprite->center_x - w, w) + 1 + center;
+    int col_max = floor_div(x + width - 1 + sprite->center_x, w) + center;
+    if(col_min < 0) col_min = 0;
+    if(col_max > size - 1) col_max = size - 1;
+    
+    for(int hex_x = col_min; hex_x <= col_max; hex_x++) {
+        int offset = ((hex_x & 1) - (center & 1)) * (h / 2);
+        int t = y + sprite->center_y - offset;
+        int k = floor_div(t, h);
+        int hex_y = center + k;
+        if(hex_y < 0 || hex_y >= size) continue;
+        
+        bool dithered;
+        bool filled = cell_filled(frame, freeze_steps[hex_y * size + hex_x], &dithered);
+        if(!filled && !grid) continue;
+        uint16_t bits = filled ? sprite->filled[t - k * h] : sprite->empty[t - k * h];
+        
+        int left = (hex_x - center) * w - sprite->center_x;
+        for(int i = 0; bits; i++, bits >>= 1) {
+            int px = left + i - x;
+            if(!(bits & 1) || px < 0 || px >= width) continue;
+            if(dithered && ((left + i + y) & 1)) continue;
+            row[px >> 3] |= (uint8_t)(0x80 >> (px & 7));
+        }
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+// ===================================================================
+// Cached 1-bit frame of the hex lattice
+//
+// The grid area right of the parameter panel is kept as an XBM bitmap
+// (LSB first) that is drawn with a single canvas_draw_xbm. Cells are
+// rendered from a pre-rasterized sprite atlas when they freeze; the
+// whole frame is only rebuilt when the zoom changes.
+//
+// Portable C like the model, so the renderer also runs in host tools.
+// ===================================================================
+#include <stdbool.h>
+#include <stdint.h>
+#include "snowflake_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNOWFLAKE_FRAME_WIDTH 80   // Covers the screen right of the parameter panel
+#define SNOWFLAKE_FRAME_HEIGHT 64
+#define SNOWFLAKE_FRAME_STRIDE ((SNOWFLAKE_FRAME_WIDTH + 7) / 8) // Bytes per bitmap row
+#define SNOWFLAKE_FRAME_BYTES (SNOWFLAKE_FRAME_STRIDE * SNOWFLAKE_FRAME_HEIGHT)
+#define SNOWFLAKE_FRAME_LIVE -1    // Rewind step of a frame that follows the model
+
+// ===================================================================
+// Viewport onto the hex lattice
+// ===================================================================
+typedef struct {
+    uint8_t zoom;    // Index into the sprite atlas, 0 = largest hexagons
+    bool auto_zoom;  // Follow the crystal size; cleared once the user zooms or pans
+    int x;           // Pan offset in pixels, relative to the seed at the frame center
+    int y;
+} SnowflakeViewport;
+
+typedef struct {
+    SnowflakeModel* model;  // Lattice the frame shows
+    SnowflakeViewport view;
+    int rewind_step;        // Shows the crystal as it was after this step, or SNOWFLAKE_FRAME_LIVE
+    int rewind_frozen;      // Frozen cells at rewind_step
+    uint16_t ring_steps;    // Every other band of this many steps is drawn dithered, 0 = no rings
+    uint8_t bits[SNOWFLAKE_FRAME_BYTES];
+} SnowflakeFrame;
+
+// Pixel rectangle in image coordinates, where the seed's center pixel is (0, 0)
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+} SnowflakeFrameRect;
+
+/** Attach a frame to a model. Installs the model's freeze callback so
+ * newly frozen cells are drawn as the step commits them.
+ */
+void snowflake_frame_init(SnowflakeFrame* frame, SnowflakeModel* model);
+
+/** Reset the viewport to auto zoom, centered, and render the frame */
+void snowflake_frame_reset(SnowflakeFrame* frame);
+
+/** Copy bitmap, viewport, rewind and rings; both frames keep their own model */
+void snowflake_frame_copy(SnowflakeFrame* dst, const SnowflakeFrame* src);
+
+/** Re-render the whole frame with the current viewport */
+void snowflake_frame_rebuild(SnowflakeFrame* frame);
+
+/** With auto zoom, switch to the largest zoom that shows the crystal.
+ * Call after every step. force_rebuild renders the frame even if the
+ * zoom stays.
+ */
+void snowflake_frame_update_zoom(SnowflakeFrame* frame, bool force_rebuild);
+
+/** Pan by (dx, dy) pixels, keeping part of the lattice in view */
+void snowflake_frame_pan(SnowflakeFrame* frame, int dx, int dy);
+
+/** Step to the next zoom level around the frame center */
+void snowflake_frame_cycle_zoom(SnowflakeFrame* frame);
+
+/** Show the crystal as it was after an earlier step, thresholded from
+ * the model's age map without simulating. A step at or past the
+ * model's, or SNOWFLAKE_FRAME_LIVE, follows the model again.
+ */
+void snowflake_frame_rewind(SnowflakeFrame* frame, int step);
+
+/** Shade growth rings: cells frozen in every other band of steps
+ * are drawn dithered. 0 draws all frozen cells solid.
+ */
+void snowflake_frame_set_rings(SnowflakeFrame* frame, uint16_t steps);
+
+/** Number of zoom levels, 0 being the largest hexagons */
+uint8_t snowflake_frame_zoom_count(void);
+
+/** Rectangle the cells [min_x, max_x] x [min_y, max_y] cover at a zoom */
+void snowflake_frame_cells_rect(
+    const SnowflakeFrame* frame, uint8_t zoom, int min_x, int min_y, int max_x, int max_y, SnowflakeFrameRect* rect);
+
+/** Rectangle an image of the lattice at a zoom covers: the crystal's
+ * bounding box plus the boundary ring, as auto zoom frames it, or all
+ * cells of the lattice.
+ */
+void snowflake_frame_image_rect(
+    const SnowflakeFrame* frame, uint8_t zoom, bool whole_lattice, SnowflakeFrameRect* rect);
+
+/** Render pixels [x, x + width) of image row y at a zoom into row,
+ * MSB first as in PBM, BMP and PNG (bit set = frozen). Honors the
+ * frame's rewind step and growth rings, not its viewport; grid marks
+ * the center of empty cells as on screen. O(columns in the row).
+ */
+void snowflake_frame_render_row(
+    const SnowflakeFrame* frame, uint8_t zoom, bool grid, int x, int y, int width, uint8_t* row);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,165 @@
+// Includes
+#include "snowflake_gallery.h"
+#include <math.h>           // lroundf
+#include <string.h>         // memcpy, memmove, memcmp
+
+#define HEADER_SIZE 12
+#define ENTRY_SIZE 26
+
+// ===================================================================
+// Function: Start an empty gallery
+// ===================================================================
+void snowflake_gallery_init(SnowflakeGallery* gallery, size_t capacity) {
+    gallery->capacity = capacity;
+    gallery->count = 0;
+    gallery->next_id = 1;
+}
+
+// ===================================================================
+// Function: Quantized key of a flake
+// ===================================================================
+SnowflakeGalleryKey snowflake_gallery_key(const SnowflakeParams* params, int size, int step) {
+    SnowflakeGalleryKey key = {
+        .alpha = (int32_t)lroundf(params->alpha * SNOWFLAKE_GALLERY_QUANTUM),
+        .beta = (int32_t)lroundf(params->beta * SNOWFLAKE_GALLERY_QUANTUM),
+        .gamma = (int32_t)lroundf(params->gamma * SNOWFLAKE_GALLERY_QUANTUM),
+        .size = (uint16_t)size,
+        .step = (uint32_t)step,
+    };
+    return key;
+}
+
+static bool key_equal(const SnowflakeGalleryKey* a, const SnowflakeGalleryKey* b) {
+    return a->alpha == b->alpha && a->beta == b->beta && a->gamma == b->gamma && a->size == b->size &&
+           a->step == b->step;
+}
+
+int snowflake_gallery_find(const SnowflakeGallery* gallery, const SnowflakeGalleryKey* key) {
+    for(int i = 0; i < gallery->count; i++) {
+        if(key_equal(&gallery->entries[i].key, key)) return i;
+    }
+    return -1;
+}
+
+int snowflake_gallery_find_id(const SnowflakeGallery* gallery, uint32_t id) {
+    for(int i = 0; i < gallery->count; i++) {
+        if(gallery->entries[i].id == id) return i;
+    }
+    return -1;
+}
+
+// ===================================================================
+// Function: Move an entry to the front
+// ===================================================================
+int snowflake_gallery_touch(SnowflakeGallery* gallery, int index) {
+    SnowflakeGalleryEntry entry = gallery->entries[index];
+    memmove(&gallery->entries[1], &gallery->entries[0], (size_t)index * sizeof(SnowflakeGalleryEntry));
+    gallery->entries[0] = entry;
+    return 0;
+}
+
+uint32_t snowflake_gallery_reserve(SnowflakeGallery* gallery) {
+    return gallery->next_id++;
+}
+
+void snowflake_gallery_remove(SnowflakeGallery* gallery, int index) {
+    gallery->count--;
+    memmove(&gallery->entries[index], &gallery->entries[index + 1],
+            (size_t)(gallery->count - index) * sizeof(SnowflakeGalleryEntry));
+}
+
+size_t snowflake_gallery_bytes(const SnowflakeGallery* gallery) {
+    size_t bytes = 0;
+    for(int i = 0; i < gallery->count; i++) bytes += gallery->entries[i].bytes;
+    return bytes;
+}
+
+// ===================================================================
+// Function: Add an entry, evicting the least recently used
+// ===================================================================
+int snowflake_gallery_add(
+    SnowflakeGallery* gallery, const SnowflakeGalleryKey* key, uint32_t id, uint32_t bytes, uint32_t* evicted) {
+    int evicted_count = 0;
+    if(bytes > gallery->capacity) {
+        evicted[evicted_count++] = id;
+        return evicted_count;
+    }
+    
+    int same = snowflake_gallery_find(gallery, key);
+    if(same >= 0) {
+        evicted[evicted_count++] = gallery->entries[same].id;
+        snowflake_gallery_remove(gallery, same);
+    }
+    
+    size_t total = snowflake_gallery_bytes(gallery) + bytes;
+    while(gallery->count > 0 && (total > gallery->capacity || gallery->count == SNOWFLAKE_GALLERY_MAX_ENTRIES)) {
+        const SnowflakeGalleryEntry* oldest = &gallery->entries[gallery->count - 1];
+        evicted[evicted_count++] = oldest->id;
+        total -= oldest->bytes;
+        gallery->count--;
+    }
+    
+    memmove(&gallery->entries[1], &gallery->entries[0], (size_t)gallery->count * sizeof(SnowflakeGalleryEntry));
+    gallery->entries[0].key = *key;
+    gallery->entries[0].id = id;
+    gallery->entries[0].bytes = bytes;
+    gallery->count++;
+    return evicted_count;
+}
+
+// ===================================================================
+// Function: Write / read the index
+// ===================================================================
+bool snowflake_gallery_write(const SnowflakeGallery* gallery, const SnowflakeWriter* writer) {
+    uint8_t buffer[HEADER_SIZE];
+    memcpy(buffer, "SFGL", 4);
+    snowflake_put_u16(buffer + 4, SNOWFLAKE_GALLERY_VERSION);
+    snowflake_put_u16(buffer + 6, (uint16_t)gallery->count);
+    snowflake_put_u32(buffer + 8, gallery->next_id);
+    if(!snowflake_write(writer, buffer, HEADER_SIZE)) return false;
+    
+    for(int i = 0; i < gallery->count; i++) {
+        const SnowflakeGalleryEntry* entry = &gallery->entries[i];
+        uint8_t record[ENTRY_SIZE];
+        snowflake_put_u32(record + 0, (uint32_t)entry->key.alpha);
+        snowflake_put_u32(record + 4, (uint32_t)entry->key.beta);
+        snowflake_put_u32(record + 8, (uint32_t)entry->key.gamma);
+        snowflake_put_u16(record + 12, entry->key.size);
+        snowflake_put_u32(record + 14, entry->key.step);
+        snowflake_put_u32(record + 18, entry->id);
+        snowflake_put_u32(record + 22, entry->bytes);
+        if(!snowflake_write(writer, record, ENTRY_SIZE)) return false;
+    }
+    return true;
+}
+
+bool snowflake_gallery_read(SnowflakeGallery* gallery, const SnowflakeReader* reader) {
+    snowflake_gallery_init(gallery, gallery->capacity);
+    
+    uint8_t buffer[HEADER_SIZE];
+    if(!snowflake_read(reader, buffer, HEADER_SIZE) || memcmp(buffer, "SFGL", 4) != 0 ||
+       snowflake_get_u16(buffer + 4) != SNOWFLAKE_GALLERY_VERSION) {
+        return false;
+    }
+    int count = snowflake_get_u16(buffer + 6);
+    uint32_t next_id = snowflake_get_u32(buffer + 8);
+    if(count > SNOWFLAKE_GALLERY_MAX_ENTRIES) return false;
+    
+    for(int i = 0; i < count; i++) {
+        SnowflakeGalleryEntry* entry = &gallery->entries[i];
+        uint8_t record[ENTRY_SIZE];
+        if(!snowflake_read(reader, record, ENTRY_SIZE)) return false;
+        entry->key.alpha = (int32_t)snowflake_get_u32(record + 0);
+        entry->key.beta = (int32_t)snowflake_get_u32(record + 4);
+        entry->key.gamma = (int32_t)snowflake_get_u32(record + 8);
+        entry->key.size = snowflake_get_u16(record + 12);
+        entry->key.step = snowflake_get_u32(record + 14);
+        entry->id = snowflake_get_u32(record + 18);
+        entry->bytes = snowflake_get_u32(record + 22);
+        if(entry->id >= next_id) return false;
+    }
+    
+    gallery->count = count;
+    gallery->next_id = next_id;
+    return true;
+}
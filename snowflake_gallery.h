@@ -0,0 +1,98 @@
+#pragma once
+
+// ===================================================================
+// Gallery: cache of grown flakes, keyed by parameters, size and step
+//
+// Each entry is a checkpoint file (snowflake_checkpoint.h) of a flake,
+// so picking it shows the flake at once and it can grow on from there.
+// This is only the index: keys, file ids and sizes, ordered from the
+// most to the least recently used. The caller stores the files (on
+// the SD card in the app, in a directory with snowflake_cli -c) and
+// deletes those the index evicts to stay within its byte budget.
+//
+// Parameters are quantized to 1/SNOWFLAKE_GALLERY_QUANTUM in the key,
+// so values that only differ by float rounding (e.g. after stepping
+// gamma up and down again) share an entry.
+//
+// Index file format (little endian):
+//   header  "SFGL", u16 version, u16 entry count, u32 next id
+//   entry   i32 alpha, beta, gamma (quantized), u16 size,
+//           u32 step, u32 id, u32 file bytes; most recent first
+// ===================================================================
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "snowflake_io.h"
+#include "snowflake_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNOWFLAKE_GALLERY_VERSION 1
+#define SNOWFLAKE_GALLERY_MAX_ENTRIES 32
+#define SNOWFLAKE_GALLERY_QUANTUM 10000
+
+typedef struct {
+    int32_t alpha, beta, gamma; // Parameters times SNOWFLAKE_GALLERY_QUANTUM, rounded
+    uint16_t size;
+    uint32_t step;
+} SnowflakeGalleryKey;
+
+typedef struct {
+    SnowflakeGalleryKey key;
+    uint32_t id;    // Names the entry's file
+    uint32_t bytes; // Size of the file
+} SnowflakeGalleryEntry;
+
+typedef struct {
+    size_t capacity; // Byte budget of all files together
+    int count;
+    uint32_t next_id;
+    SnowflakeGalleryEntry entries[SNOWFLAKE_GALLERY_MAX_ENTRIES]; // Most recently used first
+} SnowflakeGallery;
+
+/** Start an empty gallery with a budget of capacity bytes */
+void snowflake_gallery_init(SnowflakeGallery* gallery, size_t capacity);
+
+SnowflakeGalleryKey snowflake_gallery_key(const SnowflakeParams* params, int size, int step);
+
+/** Index of the entry with this key, -1 if there is none */
+int snowflake_gallery_find(const SnowflakeGallery* gallery, const SnowflakeGalleryKey* key);
+
+/** Index of the entry with this file id, -1 if there is none */
+int snowflake_gallery_find_id(const SnowflakeGallery* gallery, uint32_t id);
+
+/** Mark an entry as just used. Returns its new index (0). */
+int snowflake_gallery_touch(SnowflakeGallery* gallery, int index);
+
+/** Id for the file of an entry about to be added */
+uint32_t snowflake_gallery_reserve(SnowflakeGallery* gallery);
+
+/** Add an entry whose file has been written, as the most recent one.
+ * An entry with the same key is replaced, then the least recently used
+ * are evicted until the files fit the budget. The ids of all files to
+ * delete go to evicted (room for SNOWFLAKE_GALLERY_MAX_ENTRIES + 1);
+ * returns their number. A file larger than the whole budget is not
+ * added and its own id is among them.
+ */
+int snowflake_gallery_add(
+    SnowflakeGallery* gallery, const SnowflakeGalleryKey* key, uint32_t id, uint32_t bytes, uint32_t* evicted);
+
+/** Drop an entry, e.g. when its file turns out to be unreadable */
+void snowflake_gallery_remove(SnowflakeGallery* gallery, int index);
+
+/** Bytes of all files together */
+size_t snowflake_gallery_bytes(const SnowflakeGallery* gallery);
+
+bool snowflake_gallery_write(const SnowflakeGallery* gallery, const SnowflakeWriter* writer);
+
+/** Read an index, keeping the gallery's capacity. Entries beyond the
+ * budget are not evicted until the next add. Returns false and leaves
+ * the gallery empty if the file is not a valid index.
+ */
+bool snowflake_gallery_read(SnowflakeGallery* gallery, const SnowflakeReader* reader);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,268 @@
+// Includes
+#include "snowflake_gif.h"
+#include <stdlib.h>         // malloc, free
+#include <string.h>         // memcpy, memset
+
+#define GIF_MIN_CODE_SIZE 2  // Smallest GIF allows, enough for 2 colors
+#define GIF_TRANSPARENT 2    // Pixel that keeps the previous frame's
+#define GIF_PIXELS 3         // White, black and transparent
+#define GIF_CLEAR 4
+#define GIF_END 5
+#define GIF_FIRST_CODE 6
+
+typedef struct {
+    const SnowflakeWriter* writer;
+    bool ok;
+    
+    // LZW dictionary: code of a string followed by each pixel, 0 = none yet
+    uint16_t child[SNOWFLAKE_GIF_DICT][GIF_PIXELS];
+    uint16_t next_code;
+    uint8_t code_bits;
+    int prefix;           // Code of the pending string, -1 at the start of an image
+    
+    uint32_t bits;        // Output bits not yet in the block, LSB first
+    int bit_count;
+    uint8_t block[256];   // Data sub-block: length byte, then up to 255 bytes
+} GifEncoder;
+
+static void gif_write(GifEncoder* gif, const void* data, size_t size) {
+    if(gif->ok) gif->ok = snowflake_write(gif->writer, data, size);
+}
+
+// ===================================================================
+// Function: Pack codes into 255 byte data sub-blocks
+// ===================================================================
+static void block_byte(GifEncoder* gif, uint8_t byte) {
+    gif->block[++gif->block[0]] = byte;
+    if(gif->block[0] == 255) {
+        gif_write(gif, gif->block, 256);
+        gif->block[0] = 0;
+    }
+}
+
+static void put_code(GifEncoder* gif, uint16_t code) {
+    gif->bits |= (uint32_t)code << gif->bit_count;
+    gif->bit_count += gif->code_bits;
+    while(gif->bit_count >= 8) {
+        block_byte(gif, (uint8_t)gif->bits);
+        gif->bits >>= 8;
+        gif->bit_count -= 8;
+    }
+}
+
+// ===================================================================
+// Function: LZW over the pixels of one image
+// The decoder adds each entry one code later than the encoder, so the
+// code size grows once next_code passes the next power of two. A full
+// dictionary is cleared instead of growing to 12 bits.
+// ===================================================================
+static void lzw_reset(GifEncoder* gif) {
+    memset(gif->child, 0, sizeof(gif->child));
+    gif->next_code = GIF_FIRST_CODE;
+    gif->code_bits = GIF_MIN_CODE_SIZE + 1;
+}
+
+static void lzw_begin(GifEncoder* gif) {
+    uint8_t min_code_size = GIF_MIN_CODE_SIZE;
+    gif_write(gif, &min_code_size, 1);
+    gif->bits = 0;
+    gif->bit_count = 0;
+    gif->block[0] = 0;
+    lzw_reset(gif);
+    put_code(gif, GIF_CLEAR);
+    gif->prefix = -1;
+}
+
+static void lzw_add(GifEncoder* gif) {
+    gif->next_code++;
+    if(gif->next_code > (1 << gif->code_bits)) gif->code_bits++;
+}
+
+static void lzw_pixel(GifEncoder* gif, uint8_t pixel) {
+    if(gif->prefix < 0) {
+        gif->prefix = pixel;
+        return;
+    }
+    
+    uint16_t code = gif->child[gif->prefix][pixel];
+    if(code) {
+        gif->prefix = code;
+        return;
+    }
+    
+    put_code(gif, (uint16_t)gif->prefix);
+    gif->child[gif->prefix][pixel] = gif->next_code;
+    lzw_add(gif);
+    if(gif->next_code == SNOWFLAKE_GIF_DICT) {
+        put_code(gif, GIF_CLEAR);
+        lzw_reset(gif);
+    }
+    gif->prefix = pixel;
+}
+
+static void lzw_end(GifEncoder* gif) {
+    if(gif->prefix >= 0) {
+        put_code(gif, (uint16_t)gif->prefix);
+        // The decoder adds an entry for this code too, which may widen the end code
+        if(gif->next_code > GIF_FIRST_CODE) lzw_add(gif);
+    }
+    put_code(gif, GIF_END);
+    if(gif->bit_count > 0) block_byte(gif, (uint8_t)gif->bits);
+    if(gif->block[0]) gif_write(gif, gif->block, gif->block[0] + 1u);
+    uint8_t terminator = 0;
+    gif_write(gif, &terminator, 1);
+}
+
+// ===================================================================
+// Function: Header, palette (0 = white, 1 = black, 2 = transparent)
+// and endless loop
+// ===================================================================
+static void gif_header(GifEncoder* gif, int width, int height) {
+    uint8_t header[6 + 7 + 12 + 19] = {'G', 'I', 'F', '8', '9', 'a'};
+    snowflake_put_u16(header + 6, (uint16_t)width);
+    snowflake_put_u16(header + 8, (uint16_t)height);
+    header[10] = 0x81;  // Global color table of 4 entries
+    memset(header + 13, 0xFF, 3);
+    memset(header + 19, 0xFF, 6);
+    static const uint8_t loop[19] = {
+        0x21, 0xFF, 11, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 3, 1, 0, 0, 0};
+    memcpy(header + 25, loop, sizeof(loop));
+    gif_write(gif, header, sizeof(header));
+}
+
+// ===================================================================
+// Function: One frame: the box of the canvas that changed
+// Each row is rendered once and its pixels are repeated scale times
+// across and down. Pixels that match the previous frame (before, NULL
+// for the first) are transparent, which LZW turns into long runs.
+// ===================================================================
+static void gif_image(GifEncoder* gif, const SnowflakeFrame* shown, const SnowflakeFrame* before,
+                      const SnowflakeExportOptions* options, const SnowflakeFrameRect* canvas,
+                      const SnowflakeFrameRect* box, uint16_t delay, uint8_t* row, uint8_t* before_row) {
+    int scale = options->scale;
+    // Graphic control: keep the frame below, transparent pixels
+    uint8_t head[8 + 10] = {0x21, 0xF9, 4, (1 << 2) | 1, 0, 0, GIF_TRANSPARENT};
+    snowflake_put_u16(head + 4, delay);
+    head[8] = 0x2C;
+    snowflake_put_u16(head + 9, (uint16_t)((box->x - canvas->x) * scale));
+    snowflake_put_u16(head + 11, (uint16_t)((box->y - canvas->y) * scale));
+    snowflake_put_u16(head + 13, (uint16_t)(box->width * scale));
+    snowflake_put_u16(head + 15, (uint16_t)(box->height * scale));
+    gif_write(gif, head, sizeof(head));
+    
+    lzw_begin(gif);
+    for(int y = 0; gif->ok && y < box->height; y++) {
+        snowflake_frame_render_row(shown, options->zoom, options->grid, box->x, box->y + y, box->width, row);
+        if(before) {
+            snowflake_frame_render_row(
+                before, options->zoom, options->grid, box->x, box->y + y, box->width, before_row);
+        }
+        for(int r = 0; r < scale; r++) {
+            for(int x = 0; x < box->width * scale; x++) {
+                int src = x / scale;
+                uint8_t pixel = (row[src >> 3] >> (7 - (src & 7))) & 1;
+                if(before && pixel == ((before_row[src >> 3] >> (7 - (src & 7))) & 1)) pixel = GIF_TRANSPARENT;
+                lzw_pixel(gif, pixel);
+            }
+        }
+    }
+    lzw_end(gif);
+}
+
+// ===================================================================
+// Function: Box of the cells that froze in (after, until], clipped to
+// the canvas; a single pixel if none did
+// ===================================================================
+static void changed_box(const SnowflakeFrame* frame, uint8_t zoom, int after, int until,
+                        const SnowflakeFrameRect* canvas, SnowflakeFrameRect* box) {
+    int size = snowflake_model_get_size(frame->model);
+    const uint16_t* freeze_steps = snowflake_model_get_freeze_steps(frame->model);
+    int min_x = size, min_y = size, max_x = -1, max_y = -1;
+    for(int y = 0; y < size; y++) {
+        for(int x = 0; x < size; x++) {
+            uint16_t step = freeze_steps[y * size + x];
+            if(step == SNOWFLAKE_NOT_FROZEN || (int)step <= after || (int)step > until) continue;
+            if(x < min_x) min_x = x;
+            if(x > max_x) max_x = x;
+            if(y < min_y) min_y = y;
+            if(y > max_y) max_y = y;
+        }
+    }
+    
+    *box = (SnowflakeFrameRect){.x = canvas->x, .y = canvas->y, .width = 1, .height = 1};
+    if(max_x < 0) return;
+    
+    SnowflakeFrameRect cells;
+    snowflake_frame_cells_rect(frame, zoom, min_x, min_y, max_x, max_y, &cells);
+    int left = cells.x > canvas->x ? cells.x : canvas->x;
+    int top = cells.y > canvas->y ? cells.y : canvas->y;
+    int right = cells.x + cells.width < canvas->x + canvas->width ? cells.x + cells.width : canvas->x + canvas->width;
+    int bottom =
+        cells.y + cells.height < canvas->y + canvas->height ? cells.y + cells.height : canvas->y + canvas->height;
+    if(right > left && bottom > top) {
+        *box = (SnowflakeFrameRect){.x = left, .y = top, .width = right - left, .height = bottom - top};
+    }
+}
+
+// ===================================================================
+// Function: Write the animation
+// ===================================================================
+bool snowflake_gif_write(
+    const SnowflakeFrame* frame, const SnowflakeExportOptions* options, const SnowflakeWriter* writer) {
+    SnowflakeExportOptions image = *options;
+    image.format = SNOWFLAKE_EXPORT_PBM;  // Same canvas as a still image
+    int width, height;
+    if(!snowflake_export_size(frame, &image, &width, &height)) return false;
+    
+    SnowflakeFrameRect canvas;
+    snowflake_frame_image_rect(frame, options->zoom, options->whole_lattice, &canvas);
+    size_t stride = (size_t)(canvas.width + 7) / 8;
+    GifEncoder* gif = malloc(sizeof(GifEncoder));
+    uint8_t* rows = malloc(2 * stride);
+    
+    // Detached copies that only render the current and the previous
+    // frame's step: no freeze callback, bitmaps unused
+    SnowflakeFrame* shown = malloc(2 * sizeof(SnowflakeFrame));
+    if(!gif || !rows || !shown) {
+        free(gif);
+        free(rows);
+        free(shown);
+        return false;
+    }
+    for(int i = 0; i < 2; i++) {
+        shown[i].model = frame->model;
+        shown[i].ring_steps = frame->ring_steps;
+    }
+    
+    int last = frame->rewind_step == SNOWFLAKE_FRAME_LIVE ? snowflake_model_get_step(frame->model) :
+                                                             frame->rewind_step;
+    int frame_steps = options->frame_steps ? options->frame_steps :
+                                             (last + SNOWFLAKE_GIF_FRAMES - 1) / SNOWFLAKE_GIF_FRAMES;
+    if(frame_steps < 1) frame_steps = 1;
+    
+    gif->writer = writer;
+    gif->ok = true;
+    gif_header(gif, width, height);
+    
+    // The first frame is the seed on the whole canvas, then only what grew
+    int previous = -1;
+    for(int step = 0; gif->ok; step += frame_steps) {
+        if(step > last) step = last;
+        shown[0].rewind_step = step;
+        shown[1].rewind_step = previous;
+        SnowflakeFrameRect box = canvas;
+        if(previous >= 0) changed_box(frame, options->zoom, previous, step, &canvas, &box);
+        gif_image(gif, &shown[0], previous >= 0 ? &shown[1] : NULL, options, &canvas, &box,
+                  step == last ? SNOWFLAKE_GIF_HOLD_CS : SNOWFLAKE_GIF_DELAY_CS, rows, rows + stride);
+        previous = step;
+        if(step == last) break;
+    }
+    
+    uint8_t trailer = 0x3B;
+    gif_write(gif, &trailer, 1);
+    bool ok = gif->ok;
+    free(gif);
+    free(rows);
+    free(shown);
+    return ok;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+// ===================================================================
+// Animated GIF of a flake's growth
+//
+// The frames are thresholded from the model's age map, as the step
+// counter rewinds, so the growth up to the shown step is replayed
+// without simulating it again. Every frame after the first only holds
+// the bounding box of the cells that froze since the previous one and
+// is drawn over it, with the pixels that did not change transparent.
+// Rows are rendered one at a time and fed straight into an LZW encoder
+// with a fixed dictionary of SNOWFLAKE_GIF_DICT codes (cleared when
+// full), so the encoder needs about 3.5 KB plus two rows, whatever the
+// image size.
+//
+// Portable C like the model, so host tools write the same animations.
+// ===================================================================
+#include <stdbool.h>
+#include "snowflake_export.h"
+#include "snowflake_frame.h"
+#include "snowflake_io.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNOWFLAKE_GIF_DICT_BITS 9
+#define SNOWFLAKE_GIF_DICT (1 << SNOWFLAKE_GIF_DICT_BITS)  // Codes incl. the 4 roots, clear and end
+#define SNOWFLAKE_GIF_FRAMES 60      // Frames when frame_steps is 0
+#define SNOWFLAKE_GIF_DELAY_CS 8     // Per frame, in 1/100 s
+#define SNOWFLAKE_GIF_HOLD_CS 200    // On the last frame before the loop restarts
+
+/** Write the growth from the seed to the frame's shown step with the
+ * image options (zoom, scale, whole_lattice, grid, frame_steps); the
+ * canvas is the one snowflake_export_size reports. Returns false if
+ * out of memory, on invalid options or when the writer fails.
+ */
+bool snowflake_gif_write(
+    const SnowflakeFrame* frame, const SnowflakeExportOptions* options, const SnowflakeWriter* writer);
+
+#ifdef __cplusplus
+}
+#endif
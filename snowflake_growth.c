@@ -0,0 +1,148 @@
+// Includes
+#include "snowflake_growth.h"
+#include "snowflake_model_i.h"
+#include <string.h>         // memcpy, memcmp, memset
+
+// ===================================================================
+// Function: Write out the recorder's buffer
+// ===================================================================
+static void recorder_flush(SnowflakeGrowthRecorder* recorder) {
+    if(!recorder->failed && recorder->used > 0) {
+        recorder->failed = !snowflake_write(&recorder->writer, recorder->buffer, recorder->used);
+    }
+    recorder->used = 0;
+}
+
+static void recorder_put_varint(SnowflakeGrowthRecorder* recorder, uint32_t value) {
+    if(recorder->used + SNOWFLAKE_VARINT_MAX > SNOWFLAKE_GROWTH_BUFFER) recorder_flush(recorder);
+    recorder->used += snowflake_put_varint(recorder->buffer + recorder->used, value);
+}
+
+// ===================================================================
+// Function: Freeze callback, records the cell and chains on
+// ===================================================================
+static void recorder_on_freeze(void* context, int x, int y) {
+    SnowflakeGrowthRecorder* recorder = context;
+    int32_t index = snowflake_model_index(recorder->model, x, y);
+    recorder_put_varint(recorder, (uint32_t)(index - recorder->previous));
+    recorder->previous = index;
+    recorder->cells++;
+    
+    if(recorder->next_callback) recorder->next_callback(recorder->next_context, x, y);
+}
+
+// ===================================================================
+// Function: Start recording
+// ===================================================================
+bool snowflake_growth_recorder_begin(
+    SnowflakeGrowthRecorder* recorder,
+    const SnowflakeWriter* writer,
+    SnowflakeModel* model) {
+    memset(recorder, 0, sizeof(SnowflakeGrowthRecorder));
+    recorder->writer = *writer;
+    recorder->model = model;
+    recorder->previous = -1;
+    
+    uint8_t data[SNOWFLAKE_GROWTH_HEADER_SIZE];
+    uint32_t bits[3];
+    memcpy(&bits[0], &model->params.alpha, sizeof(uint32_t));
+    memcpy(&bits[1], &model->params.beta, sizeof(uint32_t));
+    memcpy(&bits[2], &model->params.gamma, sizeof(uint32_t));
+    
+    memcpy(data, "SFGR", 4);
+    snowflake_put_u16(data + 4, SNOWFLAKE_GROWTH_VERSION);
+    snowflake_put_u16(data + 6, (uint16_t)model->size);
+    for(int i = 0; i < 3; i++) snowflake_put_u32(data + 8 + 4 * i, bits[i]);
+    recorder->failed = !snowflake_write(writer, data, sizeof(data));
+    
+    recorder->next_callback = model->freeze_callback;
+    recorder->next_context = model->freeze_context;
+    snowflake_model_set_freeze_callback(model, recorder_on_freeze, recorder);
+    return !recorder->failed;
+}
+
+// ===================================================================
+// Function: End the current step
+// ===================================================================
+void snowflake_growth_recorder_step(SnowflakeGrowthRecorder* recorder) {
+    recorder_put_varint(recorder, 0);
+    recorder->previous = -1;
+    recorder->steps++;
+}
+
+// ===================================================================
+// Function: Stop recording
+// ===================================================================
+bool snowflake_growth_recorder_end(SnowflakeGrowthRecorder* recorder) {
+    recorder_flush(recorder);
+    snowflake_model_set_freeze_callback(recorder->model, recorder->next_callback, recorder->next_context);
+    return !recorder->failed;
+}
+
+// ===================================================================
+// Function: Read one varint through the player's buffer
+// ===================================================================
+static bool player_read_varint(SnowflakeGrowthPlayer* player, uint32_t* value) {
+    *value = 0;
+    for(int shift = 0; shift < 7 * SNOWFLAKE_VARINT_MAX; shift += 7) {
+        if(player->used == player->length) {
+            player->length = player->reader.read(player->reader.context, player->buffer, SNOWFLAKE_GROWTH_BUFFER);
+            player->used = 0;
+            if(player->length == 0) return false;
+        }
+        uint8_t byte = player->buffer[player->used++];
+        *value |= (uint32_t)(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// ===================================================================
+// Function: Start playback
+// ===================================================================
+bool snowflake_growth_player_begin(
+    SnowflakeGrowthPlayer* player,
+    const SnowflakeReader* reader,
+    SnowflakeGrowthHeader* header) {
+    memset(player, 0, sizeof(SnowflakeGrowthPlayer));
+    player->reader = *reader;
+    
+    uint8_t data[SNOWFLAKE_GROWTH_HEADER_SIZE];
+    if(!snowflake_read(reader, data, sizeof(data))) return false;
+    if(memcmp(data, "SFGR", 4) != 0 || snowflake_get_u16(data + 4) != SNOWFLAKE_GROWTH_VERSION) return false;
+    
+    header->size = snowflake_get_u16(data + 6);
+    uint32_t bits[3];
+    for(int i = 0; i < 3; i++) bits[i] = snowflake_get_u32(data + 8 + 4 * i);
+    memcpy(&header->params.alpha, &bits[0], sizeof(float));
+    memcpy(&header->params.beta, &bits[1], sizeof(float));
+    memcpy(&header->params.gamma, &bits[2], sizeof(float));
+    player->size = header->size;
+    return true;
+}
+
+// ===================================================================
+// Function: Replay the next step
+// ===================================================================
+int snowflake_growth_play_step(SnowflakeGrowthPlayer* player, SnowflakeModel* model) {
+    int32_t cells = model->size * model->size;
+    int32_t index = -1;
+    int count = 0;
+    
+    while(true) {
+        uint32_t delta;
+        if(!player_read_varint(player, &delta)) return -1;
+        if(delta == 0) break;
+        
+        // Checked before adding, so a damaged delta can neither wrap nor overflow
+        if(delta > (uint32_t)(cells - 1 - index)) return -1;
+        index += (int32_t)delta;
+        int x = index % model->size;
+        int y = index / model->size;
+        if(!model->frozen[index]) snowflake_model_freeze_cell(model, x, y);
+        count++;
+    }
+    
+    model->step++;
+    return count;
+}
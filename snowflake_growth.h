@@ -0,0 +1,87 @@
+#pragma once
+
+// ===================================================================
+// Growth recording
+//
+// A run from the seed, stored as the cells that froze in every step,
+// so it can be played back without simulating: playback only freezes
+// cells, at whatever rate the display wants. Cells of a step freeze in
+// row-major order, so their indices are stored as small deltas.
+//
+// File format (little endian):
+//   header  "SFGR", u16 version, u16 lattice size, f32 alpha, beta, gamma
+//   steps   per step: varint (index - previous index) for every cell
+//           that froze, the previous index starting at -1 so deltas
+//           are >= 1, then a 0 byte that ends the step
+// ===================================================================
+#include <stdbool.h>
+#include <stdint.h>
+#include "snowflake_io.h"
+#include "snowflake_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNOWFLAKE_GROWTH_VERSION 1
+#define SNOWFLAKE_GROWTH_HEADER_SIZE 20
+#define SNOWFLAKE_GROWTH_BUFFER 64  // Bytes buffered before a write / per read
+
+typedef struct {
+    int size;
+    SnowflakeParams params;
+} SnowflakeGrowthHeader;
+
+typedef struct {
+    SnowflakeWriter writer;
+    SnowflakeModel* model;
+    SnowflakeFreezeCallback next_callback;  // Freeze callback installed before, still called
+    void* next_context;
+    int32_t previous;  // Index of the last cell frozen in this step, -1 at the start of a step
+    uint8_t buffer[SNOWFLAKE_GROWTH_BUFFER];
+    size_t used;
+    uint32_t steps;
+    uint32_t cells;
+    bool failed;  // A write came up short; the rest is dropped
+} SnowflakeGrowthRecorder;
+
+typedef struct {
+    SnowflakeReader reader;
+    int size;
+    uint8_t buffer[SNOWFLAKE_GROWTH_BUFFER];
+    size_t used;
+    size_t length;
+} SnowflakeGrowthPlayer;
+
+/** Start recording a model that was just reset to the seed. Chains
+ * into the model's freeze callback, so attach after the frame.
+ */
+bool snowflake_growth_recorder_begin(
+    SnowflakeGrowthRecorder* recorder,
+    const SnowflakeWriter* writer,
+    SnowflakeModel* model);
+
+/** End the current step; call after every snowflake_model_step() */
+void snowflake_growth_recorder_step(SnowflakeGrowthRecorder* recorder);
+
+/** Write out the buffer and give the freeze callback back to the
+ * previous owner. Returns false if any write failed.
+ */
+bool snowflake_growth_recorder_end(SnowflakeGrowthRecorder* recorder);
+
+/** Read the header and prepare playback */
+bool snowflake_growth_player_begin(
+    SnowflakeGrowthPlayer* player,
+    const SnowflakeReader* reader,
+    SnowflakeGrowthHeader* header);
+
+/** Freeze the cells of the next recorded step in model, which must have
+ * the recorded size and start from the seed. Advances the model's step
+ * without simulating. Returns the number of cells, or -1 at the end of
+ * the recording or on damaged data.
+ */
+int snowflake_growth_play_step(SnowflakeGrowthPlayer* player, SnowflakeModel* model);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,262 @@
+// Includes
+#include "snowflake_history.h"
+#include "snowflake_io.h"
+#include "snowflake_model_i.h"
+#include <stdlib.h>         // malloc, free
+#include <string.h>         // memcpy
+
+typedef struct {
+    int step;
+    SnowflakeParams params;
+    SnowflakeStats stats;
+    bool seed;      // Restored by a model reset, no payload
+    size_t offset;  // Payload in the arena
+    size_t length;
+} SnowflakeKeyframe;
+
+// Keyframes are a FIFO ring; their payloads follow each other through
+// the arena in the same order, wrapping to the start when one could
+// run past the end.
+struct SnowflakeHistory {
+    uint8_t* arena;
+    size_t capacity;
+    size_t tail;      // Where the next payload goes
+    int interval;
+    SnowflakeKeyframe keyframes[SNOWFLAKE_HISTORY_MAX_KEYFRAMES];
+    int first;        // Oldest keyframe
+    int count;
+};
+
+// ===================================================================
+// Function: Keyframe i, counted from the oldest
+// ===================================================================
+static SnowflakeKeyframe* keyframe_at(SnowflakeHistory* history, int i) {
+    return &history->keyframes[(history->first + i) % SNOWFLAKE_HISTORY_MAX_KEYFRAMES];
+}
+
+static void drop_oldest(SnowflakeHistory* history) {
+    history->first = (history->first + 1) % SNOWFLAKE_HISTORY_MAX_KEYFRAMES;
+    history->count--;
+}
+
+// ===================================================================
+// Function: Drop the newest keyframes down to the given step
+// ===================================================================
+static void drop_after(SnowflakeHistory* history, int step) {
+    while(history->count > 0 && keyframe_at(history, history->count - 1)->step > step) {
+        history->count--;
+    }
+    
+    // The next payload follows the newest one still kept
+    history->tail = 0;
+    for(int i = history->count - 1; i >= 0; i--) {
+        SnowflakeKeyframe* keyframe = keyframe_at(history, i);
+        if(!keyframe->seed) {
+            history->tail = keyframe->offset + keyframe->length;
+            break;
+        }
+    }
+}
+
+// ===================================================================
+// Function: Allocate / free
+// ===================================================================
+SnowflakeHistory* snowflake_history_alloc(size_t budget, int interval) {
+    SnowflakeHistory* history = malloc(sizeof(SnowflakeHistory));
+    if(!history) return NULL;
+    
+    history->arena = malloc(budget);
+    if(!history->arena) {
+        free(history);
+        return NULL;
+    }
+    history->capacity = budget;
+    history->interval = interval > 0 ? interval : 1;
+    snowflake_history_clear(history);
+    return history;
+}
+
+void snowflake_history_free(SnowflakeHistory* history) {
+    if(!history) return;
+    free(history->arena);
+    free(history);
+}
+
+void snowflake_history_clear(SnowflakeHistory* history) {
+    history->first = 0;
+    history->count = 0;
+    history->tail = 0;
+}
+
+// ===================================================================
+// Function: Start over from the seed
+// ===================================================================
+void snowflake_history_seed(SnowflakeHistory* history, const SnowflakeParams* params) {
+    snowflake_history_clear(history);
+    SnowflakeKeyframe* keyframe = keyframe_at(history, 0);
+    keyframe->step = 0;
+    keyframe->params = *params;
+    memset(&keyframe->stats, 0, sizeof(SnowflakeStats));
+    keyframe->seed = true;
+    keyframe->offset = 0;
+    keyframe->length = 0;
+    history->count = 1;
+}
+
+// ===================================================================
+// Function: End of the free space starting at offset
+// That is the nearest payload at or after it, or the end of the arena.
+// ===================================================================
+static size_t room_end(SnowflakeHistory* history, size_t offset) {
+    size_t end = history->capacity;
+    for(int i = 0; i < history->count; i++) {
+        const SnowflakeKeyframe* keyframe = keyframe_at(history, i);
+        if(!keyframe->seed && keyframe->length && keyframe->offset >= offset && keyframe->offset < end) {
+            end = keyframe->offset;
+        }
+    }
+    return end;
+}
+
+// ===================================================================
+// Function: Encode s of the liquid cells into the arena at offset
+// Drops the oldest keyframe whenever the payload runs into an older
+// one. Returns false if it runs into the end of the arena.
+// ===================================================================
+static bool keyframe_encode(SnowflakeHistory* history, const SnowflakeModel* model, size_t offset, size_t* length) {
+    size_t cells = (size_t)model->size * model->size;
+    size_t end = room_end(history, offset);
+    uint32_t previous = 0;
+    
+    *length = 0;
+    for(size_t i = 0; i < cells; i++) {
+        if(model->frozen[i]) continue;
+        
+        while(offset + *length + SNOWFLAKE_VARINT_MAX > end) {
+            if(end == history->capacity) return false;
+            drop_oldest(history);
+            end = room_end(history, offset);
+        }
+        
+        uint32_t bits;
+        memcpy(&bits, &model->s[i], sizeof(uint32_t));
+        *length += snowflake_put_varint(history->arena + offset + *length, bits ^ previous);
+        previous = bits;
+    }
+    return true;
+}
+
+// ===================================================================
+// Function: Store a keyframe of the model
+// The payload goes after the newest one, or to the start of the arena
+// if it doesn't fit before the end.
+// ===================================================================
+bool snowflake_history_record(SnowflakeHistory* history, const SnowflakeModel* model, bool force) {
+    drop_after(history, force ? model->step - 1 : model->step);
+    if(history->count > 0) {
+        int last = keyframe_at(history, history->count - 1)->step;
+        if(!force && model->step - last < history->interval) return true;
+    }
+    if(history->count == SNOWFLAKE_HISTORY_MAX_KEYFRAMES) drop_oldest(history);
+    
+    size_t offset = history->tail;
+    size_t length;
+    if(!keyframe_encode(history, model, offset, &length)) {
+        offset = 0;
+        if(!keyframe_encode(history, model, offset, &length)) return false;  // Larger than the whole budget
+    }
+    
+    SnowflakeKeyframe* keyframe = keyframe_at(history, history->count);
+    keyframe->step = model->step;
+    keyframe->params = model->params;
+    keyframe->stats = model->stats;
+    keyframe->seed = false;
+    keyframe->offset = offset;
+    keyframe->length = length;
+    history->count++;
+    history->tail = offset + length;
+    return true;
+}
+
+// ===================================================================
+// Function: Load a keyframe into the model
+// Cells that froze after the keyframe thaw again; s of the frozen
+// cells is not stored and never feeds back into growth.
+// ===================================================================
+static void keyframe_load(const SnowflakeHistory* history, const SnowflakeKeyframe* keyframe, SnowflakeModel* model) {
+    size_t cells = (size_t)model->size * model->size;
+    const uint8_t* data = history->arena + keyframe->offset;
+    const uint8_t* end = data + keyframe->length;
+    uint32_t previous = 0;
+    
+    for(size_t i = 0; i < cells; i++) {
+        model->u[i] = 0.0f;
+        if(model->freeze_step[i] <= keyframe->step) {
+            model->frozen[i] = 1;
+            model->s[i] = 1.0f;
+            continue;
+        }
+        
+        model->frozen[i] = 0;
+        model->freeze_step[i] = SNOWFLAKE_NOT_FROZEN;
+        
+        uint32_t delta = 0;
+        for(int shift = 0; data < end; shift += 7) {
+            uint8_t byte = *data++;
+            delta |= (uint32_t)(byte & 0x7F) << shift;
+            if(!(byte & 0x80)) break;
+        }
+        previous ^= delta;
+        memcpy(&model->s[i], &previous, sizeof(float));
+    }
+    
+    model->step = keyframe->step;
+    model->params = keyframe->params;
+    model->stats = keyframe->stats;
+}
+
+// ===================================================================
+// Function: Bring the model back to an earlier step
+// ===================================================================
+bool snowflake_history_restore(SnowflakeHistory* history, SnowflakeModel* model, int step) {
+    int found = -1;
+    for(int i = history->count - 1; i >= 0; i--) {
+        if(keyframe_at(history, i)->step <= step) {
+            found = i;
+            break;
+        }
+    }
+    if(found < 0 || step > model->step) return false;
+    
+    const SnowflakeKeyframe* keyframe = keyframe_at(history, found);
+    if(keyframe->seed) {
+        model->params = keyframe->params;
+        snowflake_model_reset(model);
+    } else {
+        keyframe_load(history, keyframe, model);
+    }
+    
+    drop_after(history, step);
+    while(model->step < step) snowflake_model_step(model);
+    return true;
+}
+
+// ===================================================================
+// Getters
+// ===================================================================
+int snowflake_history_oldest_step(const SnowflakeHistory* history) {
+    return history->count > 0 ? history->keyframes[history->first].step : -1;
+}
+
+int snowflake_history_count(const SnowflakeHistory* history) {
+    return history->count;
+}
+
+size_t snowflake_history_bytes(const SnowflakeHistory* history) {
+    size_t bytes = 0;
+    for(int i = 0; i < history->count; i++) {
+        const SnowflakeKeyframe* keyframe = &history->keyframes[(history->first + i) % SNOWFLAKE_HISTORY_MAX_KEYFRAMES];
+        bytes += keyframe->length;
+    }
+    return bytes;
+}
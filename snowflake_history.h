@@ -0,0 +1,75 @@
+#pragma once
+
+// ===================================================================
+// Undo history: full-state keyframes plus re-simulation
+//
+// Every `interval` steps the state the next step depends on (s of the
+// liquid cells, statistics, parameters) is stored as a compressed
+// keyframe in a fixed RAM budget; the oldest keyframes are dropped when
+// it runs out. Restoring step t loads the newest keyframe at or before
+// t and simulates forward from there, at most `interval` steps.
+//
+// The frozen mask is not stored: it is the set of cells whose freeze
+// step (the model's age map) is at or before the keyframe, so restoring
+// only works along the model's current line of growth. Restoring drops
+// the keyframes after the restored step, so growing on from there
+// branches off.
+//
+// Payload: s of every liquid cell in row-major order, each as a varint
+// of its bits XORed with the previous one; neighbours share sign,
+// exponent and the high mantissa bits, so most take 1 to 3 bytes.
+// ===================================================================
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "snowflake_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNOWFLAKE_HISTORY_MAX_KEYFRAMES 64  // Oldest keyframes are dropped beyond this, whatever the budget
+
+typedef struct SnowflakeHistory SnowflakeHistory;
+
+/** Allocate a history with budget bytes for keyframe payloads and a
+ * keyframe every interval steps. Returns NULL if out of memory.
+ */
+SnowflakeHistory* snowflake_history_alloc(size_t budget, int interval);
+
+void snowflake_history_free(SnowflakeHistory* history);
+
+/** Drop all keyframes */
+void snowflake_history_clear(SnowflakeHistory* history);
+
+/** Drop all keyframes and start over from the seed with the given
+ * parameters. Costs no payload.
+ */
+void snowflake_history_seed(SnowflakeHistory* history, const SnowflakeParams* params);
+
+/** Call after the model advanced. Keyframes past the model's step are
+ * dropped; a new one is stored if there is none yet, if the last one
+ * is interval steps old, or if force is set (e.g. the parameters just
+ * changed). Returns false if the model doesn't fit the budget at all.
+ */
+bool snowflake_history_record(SnowflakeHistory* history, const SnowflakeModel* model, bool force);
+
+/** Bring the model back to step from the newest keyframe at or before
+ * it, re-simulating the rest with the keyframe's parameters. The
+ * freeze callback runs for the re-simulated cells only; redraw after.
+ * Returns false and leaves the model alone if no keyframe reaches
+ * back that far.
+ */
+bool snowflake_history_restore(SnowflakeHistory* history, SnowflakeModel* model, int step);
+
+/** Earliest step that can be restored, -1 if the history is empty */
+int snowflake_history_oldest_step(const SnowflakeHistory* history);
+
+int snowflake_history_count(const SnowflakeHistory* history);
+
+/** Keyframe payload bytes in use */
+size_t snowflake_history_bytes(const SnowflakeHistory* history);
+
+#ifdef __cplusplus
+}
+#endif
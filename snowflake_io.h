@@ -0,0 +1,103 @@
+#pragma once
+
+// ===================================================================
+// Byte sinks and sources for the portable file formats
+//
+// The writers and readers of traces, recordings, checkpoints and
+// exports only see these callbacks: on the device they wrap a Storage
+// File (snowflake_storage.c), on the host a stdio FILE. All multi-byte
+// fields are stored little endian, independent of the CPU. Scratch
+// files that are only read back by the same build, like the tiles of
+// an out-of-core lattice, use a block file in native byte order.
+// ===================================================================
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    /** Write size bytes, return the number written */
+    size_t (*write)(void* context, const void* data, size_t size);
+    void* context;
+} SnowflakeWriter;
+
+typedef struct {
+    /** Read up to size bytes, return the number read (0 at the end) */
+    size_t (*read)(void* context, void* data, size_t size);
+    void* context;
+} SnowflakeReader;
+
+// Random access to a scratch file
+typedef struct {
+    /** Read / write size bytes at offset, return false on failure */
+    bool (*read)(void* context, uint64_t offset, void* data, size_t size);
+    bool (*write)(void* context, uint64_t offset, const void* data, size_t size);
+    void* context;
+} SnowflakeBlockFile;
+
+static inline bool snowflake_write(const SnowflakeWriter* writer, const void* data, size_t size) {
+    return writer->write(writer->context, data, size) == size;
+}
+
+static inline bool snowflake_read(const SnowflakeReader* reader, void* data, size_t size) {
+    return reader->read(reader->context, data, size) == size;
+}
+
+// ===================================================================
+// Little endian field packing
+// ===================================================================
+static inline void snowflake_put_u16(uint8_t* dst, uint16_t value) {
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8);
+}
+
+static inline void snowflake_put_u32(uint8_t* dst, uint32_t value) {
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8);
+    dst[2] = (uint8_t)(value >> 16);
+    dst[3] = (uint8_t)(value >> 24);
+}
+
+static inline uint16_t snowflake_get_u16(const uint8_t* src) {
+    return (uint16_t)(src[0] | (src[1] << 8));
+}
+
+static inline uint32_t snowflake_get_u32(const uint8_t* src) {
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) |
+           ((uint32_t)src[3] << 24);
+}
+
+// ===================================================================
+// LEB128 varints: 7 bits per byte, high bit set on all but the last
+// ===================================================================
+#define SNOWFLAKE_VARINT_MAX 5 // Bytes of the longest uint32_t
+
+/** Encode value into dst, returns the number of bytes used */
+static inline size_t snowflake_put_varint(uint8_t* dst, uint32_t value) {
+    size_t length = 0;
+    while(value >= 0x80) {
+        dst[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    dst[length++] = (uint8_t)value;
+    return length;
+}
+
+/** Read one varint; false at the end of the data or on overlong input */
+static inline bool snowflake_read_varint(const SnowflakeReader* reader, uint32_t* value) {
+    *value = 0;
+    for(int shift = 0; shift < 7 * SNOWFLAKE_VARINT_MAX; shift += 7) {
+        uint8_t byte;
+        if(!snowflake_read(reader, &byte, 1)) return false;
+        *value |= (uint32_t)(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+#ifdef __cplusplus
+}
+#endif
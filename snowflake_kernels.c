@@ -0,0 +1,290 @@
+// Includes
+#include "snowflake_kernels.h"
+#include "snowflake_model_i.h"
+#include <string.h>         // memcpy, memset, strcmp
+
+// ===================================================================
+// Shared helpers of the fast kernels
+//
+// Interior cells (outside the 2-cell border band) always have all six
+// neighbours, so the fast kernels skip the bounds checks of the
+// reference and address neighbours by fixed index offsets, one set per
+// column parity (odd-q layout, order N, NE, SE, S, SW, NW):
+//   even x: -size, -size+1, +1, +size, -1, -size-1
+//   odd x:  -size, +1, +size+1, +size, +size-1, -1
+// Sums are accumulated in the same neighbour order as the reference so
+// the float results stay bit-identical.
+// ===================================================================
+
+typedef struct {
+    int x0, y0, x1, y1;
+} KernelRect;
+
+// ===================================================================
+// Function: Swap two float buffers instead of copying one into the other
+// ===================================================================
+static inline void swap_buffers(float** a, float** b) {
+    float* tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+// ===================================================================
+// Function: Interior rectangle that can hold receptive cells
+// Receptive cells are frozen or touch a frozen cell, so they all lie
+// within the crystal's bounding box grown by one.
+// ===================================================================
+static KernelRect receptive_rect(const SnowflakeModel* model) {
+    const SnowflakeStats* stats = &model->stats;
+    int size = model->size;
+    KernelRect rect = {2, 2, size - 3, size - 3};
+    if(stats->frozen_total == 0) {
+        rect.x1 = rect.x0 - 1;  // Empty
+        return rect;
+    }
+    if(stats->min_x - 1 > rect.x0) rect.x0 = stats->min_x - 1;
+    if(stats->min_y - 1 > rect.y0) rect.y0 = stats->min_y - 1;
+    if(stats->max_x + 1 < rect.x1) rect.x1 = stats->max_x + 1;
+    if(stats->max_y + 1 < rect.y1) rect.y1 = stats->max_y + 1;
+    return rect;
+}
+
+// ===================================================================
+// Function: Mark receptive cells of one interior row segment
+// ===================================================================
+static inline void mark_receptive_row(SnowflakeModel* model, int y, int x0, int x1) {
+    int size = model->size;
+    const uint8_t* frozen = model->frozen;
+    uint8_t* receptive = model->receptive;
+    
+    for(int x = x0; x <= x1; x++) {
+        int idx = y * size + x;
+        const uint8_t* f = frozen + idx;
+        if(x & 1) {
+            receptive[idx] = f[0] | f[-size] | f[1] | f[size + 1] | f[size] | f[size - 1] | f[-1];
+        } else {
+            receptive[idx] = f[0] | f[-size] | f[-size + 1] | f[1] | f[size] | f[-1] | f[-size - 1];
+        }
+    }
+}
+
+// ===================================================================
+// Function: Write beta into the border band of a buffer
+// ===================================================================
+static void fill_border(float* buffer, int size, float beta) {
+    for(int y = 0; y < size; y++) {
+        float* row = buffer + y * size;
+        if(y < 2 || y >= size - 2) {
+            for(int x = 0; x < size; x++) row[x] = beta;
+        } else {
+            row[0] = row[1] = beta;
+            row[size - 2] = row[size - 1] = beta;
+        }
+    }
+}
+
+// ===================================================================
+// Function: Diffusion with fixed neighbour offsets
+// ===================================================================
+static void offsets_diffuse(SnowflakeModel* model) {
+    int size = model->size;
+    const float half_alpha = model->params.alpha / 2.0f;
+    const float* u = model->u;
+    float* u_new = model->u_new;
+    
+    fill_border(u_new, size, model->params.beta);
+    for(int y = 2; y < size - 2; y++) {
+        int row = y * size;
+        // Even columns
+        for(int x = 2; x < size - 2; x += 2) {
+            const float* c = u + row + x;
+            float sum = 0.0f;
+            sum += c[-size];
+            sum += c[-size + 1];
+            sum += c[1];
+            sum += c[size];
+            sum += c[-1];
+            sum += c[-size - 1];
+            float avg = sum / 6;
+            u_new[row + x] = c[0] + half_alpha * (avg - c[0]);
+        }
+        // Odd columns
+        for(int x = 3; x < size - 2; x += 2) {
+            const float* c = u + row + x;
+            float sum = 0.0f;
+            sum += c[-size];
+            sum += c[1];
+            sum += c[size + 1];
+            sum += c[size];
+            sum += c[size - 1];
+            sum += c[-1];
+            float avg = sum / 6;
+            u_new[row + x] = c[0] + half_alpha * (avg - c[0]);
+        }
+    }
+    
+    swap_buffers(&model->u, &model->u_new);
+}
+
+// ===================================================================
+// Function: Receptive update of one interior row segment
+// Returns the number of cells marked to freeze.
+// ===================================================================
+static inline int update_receptive_row(SnowflakeModel* model, int y, int x0, int x1) {
+    int row = y * model->size;
+    const float gamma = model->params.gamma;
+    const float* u = model->u + row;
+    const float* s = model->s + row;
+    const uint8_t* frozen = model->frozen + row;
+    const uint8_t* receptive = model->receptive + row;
+    float* s_new = model->s_new + row;
+    uint8_t* frozen_new = model->frozen_new + row;
+    int frozen_count = 0;
+    
+    for(int x = x0; x <= x1; x++) {
+        if(!receptive[x]) continue;
+        s_new[x] = u[x] + s[x] + gamma;
+        if(!frozen[x] && s_new[x] >= 1.0f) {
+            frozen_new[x] = 1;
+            frozen_count++;
+        }
+    }
+    return frozen_count;
+}
+
+// ===================================================================
+// Kernel "offsets": full-lattice passes with fixed neighbour offsets,
+// the receptive mask computed once per step, buffer swaps instead of
+// copies, and the freeze scan limited to the crystal's neighbourhood
+// ===================================================================
+static void offsets_classify(SnowflakeModel* model) {
+    int size = model->size;
+    const float* s = model->s;
+    float* u = model->u;
+    
+    memset(model->receptive, 0, (size_t)size * size);
+    for(int y = 2; y < size - 2; y++) {
+        mark_receptive_row(model, y, 2, size - 3);
+    }
+    for(int i = 0; i < size * size; i++) {
+        u[i] = model->receptive[i] ? 0.0f : s[i];
+    }
+}
+
+static int offsets_update(SnowflakeModel* model) {
+    int size = model->size;
+    
+    // Non-receptive cells take the diffused value, the border stays at beta
+    memcpy(model->s_new, model->u, (size_t)size * size * sizeof(float));
+    fill_border(model->s_new, size, model->params.beta);
+    memcpy(model->frozen_new, model->frozen, (size_t)size * size);
+    
+    int frozen_count = 0;
+    for(int y = 2; y < size - 2; y++) {
+        frozen_count += update_receptive_row(model, y, 2, size - 3);
+    }
+    
+    KernelRect rect = receptive_rect(model);
+    swap_buffers(&model->s, &model->s_new);
+    snowflake_model_commit(model, rect.x0, rect.y0, rect.x1, rect.y1);
+    return frozen_count;
+}
+
+// ===================================================================
+// Kernel "bbox": like "offsets", but the receptive mask and the
+// receptive update only cover the crystal's bounding box grown by one.
+// Everything outside it is a plain copy, which wins once the lattice
+// is large compared to the crystal.
+// ===================================================================
+static void bbox_classify(SnowflakeModel* model) {
+    int size = model->size;
+    KernelRect rect = receptive_rect(model);
+    
+    memcpy(model->u, model->s, (size_t)size * size * sizeof(float));
+    for(int y = rect.y0; y <= rect.y1; y++) {
+        mark_receptive_row(model, y, rect.x0, rect.x1);
+        const uint8_t* receptive = model->receptive + y * size;
+        float* u = model->u + y * size;
+        for(int x = rect.x0; x <= rect.x1; x++) {
+            if(receptive[x]) u[x] = 0.0f;
+        }
+    }
+}
+
+static int bbox_update(SnowflakeModel* model) {
+    int size = model->size;
+    KernelRect rect = receptive_rect(model);  // Same as in classify, nothing froze since
+    
+    memcpy(model->s_new, model->u, (size_t)size * size * sizeof(float));
+    fill_border(model->s_new, size, model->params.beta);
+    for(int y = rect.y0; y <= rect.y1; y++) {
+        memset(model->frozen_new + y * size + rect.x0, 0, rect.x1 - rect.x0 + 1);
+    }
+    
+    int frozen_count = 0;
+    for(int y = rect.y0; y <= rect.y1; y++) {
+        frozen_count += update_receptive_row(model, y, rect.x0, rect.x1);
+    }
+    
+    swap_buffers(&model->s, &model->s_new);
+    snowflake_model_commit(model, rect.x0, rect.y0, rect.x1, rect.y1);
+    return frozen_count;
+}
+
+// ===================================================================
+// Registry
+// ===================================================================
+const SnowflakeKernel snowflake_kernels[] = {
+    {"reference", snowflake_model_classify, snowflake_model_diffuse, snowflake_model_update},
+    {"offsets", offsets_classify, offsets_diffuse, offsets_update},
+    {"bbox", bbox_classify, offsets_diffuse, bbox_update},
+};
+
+const int snowflake_kernel_count = sizeof(snowflake_kernels) / sizeof(snowflake_kernels[0]);
+
+const SnowflakeKernel* snowflake_kernel_default(void) {
+    return &snowflake_kernels[0];
+}
+
+const SnowflakeKernel* snowflake_kernel_find(const char* name) {
+    for(int i = 0; i < snowflake_kernel_count; i++) {
+        if(strcmp(snowflake_kernels[i].name, name) == 0) return &snowflake_kernels[i];
+    }
+    return NULL;
+}
+
+// ===================================================================
+// Function: Time the kernels and return the fastest
+// ===================================================================
+const SnowflakeKernel* snowflake_kernel_autotune(
+    int size, const SnowflakeParams* params, int warmup_steps, int timed_steps) {
+    const SnowflakeKernel* best = snowflake_kernel_default();
+    SnowflakeModel* base = snowflake_model_alloc(size, params);
+    SnowflakeModel* trial = snowflake_model_alloc(size, params);
+    if(!base || !trial) {
+        snowflake_model_free(base);
+        snowflake_model_free(trial);
+        return best;
+    }
+    
+    for(int i = 0; i < warmup_steps; i++) snowflake_model_step(base);
+    
+    uint32_t best_ticks = UINT32_MAX;
+    for(int k = 0; k < snowflake_kernel_count; k++) {
+        const SnowflakeKernel* kernel = &snowflake_kernels[k];
+        snowflake_model_copy(trial, base);
+        snowflake_model_set_kernel(trial, kernel);
+        uint32_t start = snowflake_profile_now();
+        for(int i = 0; i < timed_steps; i++) snowflake_model_step(trial);
+        uint32_t ticks = snowflake_profile_now() - start;
+        
+        if(ticks < best_ticks) {
+            best_ticks = ticks;
+            best = kernel;
+        }
+    }
+    
+    snowflake_model_free(base);
+    snowflake_model_free(trial);
+    return best;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+// ===================================================================
+// Step kernel registry
+//
+// Interchangeable implementations of the three step phases. All of them
+// produce bit-identical results (checked by host/diff_kernels.c); they
+// only differ in speed, which depends on the lattice size and on how
+// much of it the crystal covers. snowflake_kernel_autotune() times all
+// kernels on a grown crystal and picks the fastest, so the choice can
+// be cached per lattice size. Every kernel handles every lattice the
+// model does, down to 5x5.
+// ===================================================================
+#include <stdbool.h>
+#include <stdint.h>
+#include "snowflake_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct SnowflakeKernel {
+    const char* name;
+    
+    /** Step 1: u = 0 for receptive cells, u = s otherwise */
+    void (*classify)(SnowflakeModel* model);
+    /** Step 2: diffuse u over the hex neighbourhood */
+    void (*diffuse)(SnowflakeModel* model);
+    /** Step 3: update s, freeze cells, advance the step; returns the cells frozen */
+    int (*update)(SnowflakeModel* model);
+} SnowflakeKernel;
+
+extern const SnowflakeKernel snowflake_kernels[];
+extern const int snowflake_kernel_count;
+
+/** The kernel models use unless told otherwise */
+const SnowflakeKernel* snowflake_kernel_default(void);
+
+/** Look a kernel up by name, NULL if unknown */
+const SnowflakeKernel* snowflake_kernel_find(const char* name);
+
+/** Grow a crystal for warmup_steps, then time timed_steps of every
+ * kernel from that state and return the fastest. Returns the
+ * default kernel if memory for the trial models is short.
+ */
+const SnowflakeKernel* snowflake_kernel_autotune(
+    int size, const SnowflakeParams* params, int warmup_steps, int timed_steps);
+
+#ifdef __cplusplus
+}
+#endif
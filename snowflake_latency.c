@@ -0,0 +1,87 @@
+// Includes
+#include "snowflake_latency.h"
+#include <string.h>         // memset, memcpy
+
+static const char* const stage_names[SNOWFLAKE_LATENCY_STAGE_COUNT] = {
+    "queue",
+    "handle",
+    "draw",
+    "total",
+};
+
+// ===================================================================
+// Function: Drop all pending events and samples
+// ===================================================================
+void snowflake_latency_reset(SnowflakeLatency* latency) {
+    memset(latency, 0, sizeof(SnowflakeLatency));
+}
+
+// ===================================================================
+// Function: Remember a committed event until the next draw
+// If the GUI falls behind, the oldest pending event is dropped.
+// ===================================================================
+void snowflake_latency_commit(
+    SnowflakeLatency* latency, uint32_t arrival, uint32_t dequeue, uint32_t commit) {
+    if(latency->pending_count == SNOWFLAKE_LATENCY_PENDING) {
+        memmove(&latency->pending[0], &latency->pending[1],
+                (SNOWFLAKE_LATENCY_PENDING - 1) * sizeof(SnowflakeLatencyPending));
+        latency->pending_count--;
+        latency->dropped++;
+    }
+    
+    SnowflakeLatencyPending* pending = &latency->pending[latency->pending_count++];
+    pending->arrival = arrival;
+    pending->dequeue = dequeue;
+    pending->commit = commit;
+}
+
+// ===================================================================
+// Function: Close all pending events with the draw completion time
+// ===================================================================
+void snowflake_latency_draw_done(SnowflakeLatency* latency, uint32_t now) {
+    for(int i = 0; i < latency->pending_count; i++) {
+        const SnowflakeLatencyPending* pending = &latency->pending[i];
+        uint8_t slot = latency->head;
+        latency->samples[SNOWFLAKE_LATENCY_QUEUE][slot] = pending->dequeue - pending->arrival;
+        latency->samples[SNOWFLAKE_LATENCY_HANDLE][slot] = pending->commit - pending->dequeue;
+        latency->samples[SNOWFLAKE_LATENCY_DRAW][slot] = now - pending->commit;
+        latency->samples[SNOWFLAKE_LATENCY_TOTAL][slot] = now - pending->arrival;
+        
+        latency->head = (slot + 1) % SNOWFLAKE_LATENCY_WINDOW;
+        if(latency->count < SNOWFLAKE_LATENCY_WINDOW) latency->count++;
+    }
+    latency->pending_count = 0;
+}
+
+// ===================================================================
+// Function: Nearest-rank percentiles over the window
+// ===================================================================
+void snowflake_latency_get_stats(
+    const SnowflakeLatency* latency, SnowflakeLatencyStage stage, SnowflakeLatencyStats* stats) {
+    memset(stats, 0, sizeof(SnowflakeLatencyStats));
+    int count = latency->count;
+    if(count == 0) return;
+    
+    // Insertion sort of a copy, the window is small
+    uint32_t sorted[SNOWFLAKE_LATENCY_WINDOW];
+    memcpy(sorted, latency->samples[stage], count * sizeof(uint32_t));
+    for(int i = 1; i < count; i++) {
+        uint32_t value = sorted[i];
+        int j = i - 1;
+        while(j >= 0 && sorted[j] > value) {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = value;
+    }
+    
+    stats->p50 = sorted[(count * 50 + 99) / 100 - 1];
+    stats->p90 = sorted[(count * 90 + 99) / 100 - 1];
+    stats->p99 = sorted[(count * 99 + 99) / 100 - 1];
+    stats->max = sorted[count - 1];
+    stats->count = count;
+}
+
+const char* snowflake_latency_stage_name(SnowflakeLatencyStage stage) {
+    return (stage < SNOWFLAKE_LATENCY_STAGE_COUNT) ? stage_names[stage] : "?";
+}
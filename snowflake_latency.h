@@ -0,0 +1,74 @@
+#pragma once
+
+// ===================================================================
+// Press-to-pixel latency of input events
+//
+// Every event that leads to a redraw is timestamped when the input
+// callback receives it, when the main loop dequeues it and when its
+// change is committed (right before view_port_update). The next
+// completed draw callback closes all pending events. Percentiles of
+// each stage are kept over the last SNOWFLAKE_LATENCY_WINDOW events.
+//
+// Timestamps are snowflake_profile_now() ticks, but the tracker only
+// takes them as arguments so simulations can feed their own clock.
+// ===================================================================
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNOWFLAKE_LATENCY_WINDOW 64  // Completed events the percentiles are taken over
+#define SNOWFLAKE_LATENCY_PENDING 8  // Committed events waiting for a draw
+
+typedef enum {
+    SNOWFLAKE_LATENCY_QUEUE,   // Input callback -> dequeued by the main loop
+    SNOWFLAKE_LATENCY_HANDLE,  // Dequeued -> committed (step done, view_port_update)
+    SNOWFLAKE_LATENCY_DRAW,    // Committed -> draw callback finished
+    SNOWFLAKE_LATENCY_TOTAL,   // Input callback -> draw callback finished
+    SNOWFLAKE_LATENCY_STAGE_COUNT
+} SnowflakeLatencyStage;
+
+typedef struct {
+    uint32_t arrival;
+    uint32_t dequeue;
+    uint32_t commit;
+} SnowflakeLatencyPending;
+
+typedef struct {
+    SnowflakeLatencyPending pending[SNOWFLAKE_LATENCY_PENDING];
+    uint8_t pending_count;
+    
+    uint32_t samples[SNOWFLAKE_LATENCY_STAGE_COUNT][SNOWFLAKE_LATENCY_WINDOW];
+    uint8_t head;     // Next slot to write
+    uint8_t count;    // Valid samples per stage
+    uint32_t dropped; // Events that never saw a draw because the pending list was full
+} SnowflakeLatency;
+
+typedef struct {
+    uint32_t p50; // Ticks
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t max;
+    uint8_t count; // Events the figures are taken over, 0 if none yet
+} SnowflakeLatencyStats;
+
+void snowflake_latency_reset(SnowflakeLatency* latency);
+
+/** An event was handled and its result committed for drawing */
+void snowflake_latency_commit(
+    SnowflakeLatency* latency, uint32_t arrival, uint32_t dequeue, uint32_t commit);
+
+/** A draw callback finished; completes every pending event */
+void snowflake_latency_draw_done(SnowflakeLatency* latency, uint32_t now);
+
+/** Percentiles of one stage over the window */
+void snowflake_latency_get_stats(
+    const SnowflakeLatency* latency, SnowflakeLatencyStage stage, SnowflakeLatencyStats* stats);
+
+/** Short stage name for overlays and logs */
+const char* snowflake_latency_stage_name(SnowflakeLatencyStage stage);
+
+#ifdef __cplusplus
+}
+#endif
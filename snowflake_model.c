@@ -0,0 +1,430 @@
+// Includes
+#include "snowflake_model_i.h"
+#include <stdlib.h>         // Standard library functions (malloc, calloc, etc.)
+#include <string.h>         // Memory and string manipulation functions
+
+// ===================================================================
+// Function: Get hexagonal neighbors for flat-top hexagons
+// Using "odd-q" vertical layout (odd columns shifted down)
+// ===================================================================
+static void get_hex_neighbors(int x, int y, int neighbors_x[6], int neighbors_y[6]) {
+    if(x % 2 == 0) {
+        // Even columns
+        neighbors_x[0] = x;      neighbors_y[0] = y - 1;  // N
+        neighbors_x[1] = x + 1;  neighbors_y[1] = y - 1;  // NE
+        neighbors_x[2] = x + 1;  neighbors_y[2] = y;      // SE
+        neighbors_x[3] = x;      neighbors_y[3] = y + 1;  // S
+        neighbors_x[4] = x - 1;  neighbors_y[4] = y;      // SW
+        neighbors_x[5] = x - 1;  neighbors_y[5] = y - 1;  // NW
+    } else {
+        // Odd columns (offset down)
+        neighbors_x[0] = x;      neighbors_y[0] = y - 1;  // N
+        neighbors_x[1] = x + 1;  neighbors_y[1] = y;      // NE
+        neighbors_x[2] = x + 1;  neighbors_y[2] = y + 1;  // SE
+        neighbors_x[3] = x;      neighbors_y[3] = y + 1;  // S
+        neighbors_x[4] = x - 1;  neighbors_y[4] = y + 1;  // SW
+        neighbors_x[5] = x - 1;  neighbors_y[5] = y;      // NW
+    }
+}
+
+// ===================================================================
+// Function: Check if cell is inside the lattice
+// ===================================================================
+static inline bool in_lattice(const SnowflakeModel* model, int x, int y) {
+    return x >= 0 && x < model->size && y >= 0 && y < model->size;
+}
+
+// ===================================================================
+// Function: Check if cell is boundary cell
+// ===================================================================
+static bool is_boundary_cell(const SnowflakeModel* model, int x, int y) {
+    if(model->frozen[snowflake_model_index(model, x, y)]) return false;
+    
+    // Border cells (2 cells from edge) can never be boundary cells
+    if(snowflake_model_is_border(model, x, y)) return false;
+    
+    int neighbors_x[6], neighbors_y[6];
+    get_hex_neighbors(x, y, neighbors_x, neighbors_y);
+    
+    for(int i = 0; i < 6; i++) {
+        int nx = neighbors_x[i];
+        int ny = neighbors_y[i];
+        
+        if(in_lattice(model, nx, ny)) {
+            if(model->frozen[snowflake_model_index(model, nx, ny)]) {
+                return true;
+            }
+        }
+    }
+    
+    return false;
+}
+
+// ===================================================================
+// Function: Hex distance of a cell from the seed
+// Converts odd-q offset coordinates to cube coordinates
+// ===================================================================
+static int hex_distance_from_center(const SnowflakeModel* model, int x, int y) {
+    int center = model->size / 2;
+    int dq = x - center;
+    int dr = (y - (x - (x & 1)) / 2) - (center - (center - (center & 1)) / 2);
+    int ds = -dq - dr;
+    int d = abs(dq);
+    if(abs(dr) > d) d = abs(dr);
+    if(abs(ds) > d) d = abs(ds);
+    return d;
+}
+
+// ===================================================================
+// Function: Freeze a single cell and update the running statistics
+// The perimeter changes only around the new cell, so only its
+// neighbours are re-examined.
+// ===================================================================
+void snowflake_model_freeze_cell(SnowflakeModel* model, int x, int y) {
+    SnowflakeStats* stats = &model->stats;
+    int neighbors_x[6], neighbors_y[6];
+    bool was_boundary[6];
+    get_hex_neighbors(x, y, neighbors_x, neighbors_y);
+    
+    if(is_boundary_cell(model, x, y)) stats->perimeter--;
+    for(int i = 0; i < 6; i++) {
+        was_boundary[i] = in_lattice(model, neighbors_x[i], neighbors_y[i]) &&
+                          is_boundary_cell(model, neighbors_x[i], neighbors_y[i]);
+    }
+    
+    int idx = snowflake_model_index(model, x, y);
+    model->frozen[idx] = 1;
+    model->freeze_step[idx] = model->step < SNOWFLAKE_NOT_FROZEN - 1 ? (uint16_t)(model->step + 1)
+                                                                      : SNOWFLAKE_NOT_FROZEN - 1;
+    
+    for(int i = 0; i < 6; i++) {
+        if(in_lattice(model, neighbors_x[i], neighbors_y[i]) && !was_boundary[i] &&
+           is_boundary_cell(model, neighbors_x[i], neighbors_y[i])) {
+            stats->perimeter++;
+        }
+    }
+    
+    if(stats->frozen_total == 0) {
+        stats->min_x = stats->max_x = x;
+        stats->min_y = stats->max_y = y;
+    } else {
+        if(x < stats->min_x) stats->min_x = x;
+        if(x > stats->max_x) stats->max_x = x;
+        if(y < stats->min_y) stats->min_y = y;
+        if(y > stats->max_y) stats->max_y = y;
+    }
+    stats->frozen_total++;
+    
+    int distance = hex_distance_from_center(model, x, y);
+    if(distance > stats->radius) stats->radius = distance;
+    
+    if(model->freeze_callback) {
+        model->freeze_callback(model->freeze_context, x, y);
+    }
+}
+
+// ===================================================================
+// Function: Allocate model
+// ===================================================================
+SnowflakeModel* snowflake_model_alloc(int size, const SnowflakeParams* params) {
+    SnowflakeModel* model = calloc(1, sizeof(SnowflakeModel));
+    if(!model) return NULL;
+    
+    size_t cells = (size_t)size * size;
+    model->size = size;
+    model->params = *params;
+    model->s = (float*)malloc(cells * sizeof(float));
+    model->u = (float*)malloc(cells * sizeof(float));
+    model->frozen = (uint8_t*)malloc(cells * sizeof(uint8_t));
+    model->freeze_step = (uint16_t*)malloc(cells * sizeof(uint16_t));
+    model->u_new = (float*)malloc(cells * sizeof(float));
+    model->s_new = (float*)malloc(cells * sizeof(float));
+    model->frozen_new = (uint8_t*)malloc(cells * sizeof(uint8_t));
+    model->receptive = (uint8_t*)malloc(cells * sizeof(uint8_t));
+    model->kernel = snowflake_kernel_default();
+    
+    if(!model->s || !model->u || !model->frozen || !model->freeze_step || !model->u_new || !model->s_new ||
+       !model->frozen_new || !model->receptive) {
+        snowflake_model_free(model);
+        return NULL;
+    }
+    
+    snowflake_model_reset(model);
+    return model;
+}
+
+// ===================================================================
+// Function: Free model
+// ===================================================================
+void snowflake_model_free(SnowflakeModel* model) {
+    if(!model) return;
+    free(model->s);
+    free(model->u);
+    free(model->frozen);
+    free(model->freeze_step);
+    free(model->u_new);
+    free(model->s_new);
+    free(model->frozen_new);
+    free(model->receptive);
+    free(model);
+}
+
+// ===================================================================
+// Function: Copy model state
+// ===================================================================
+void snowflake_model_copy(SnowflakeModel* dst, const SnowflakeModel* src) {
+    size_t cells = (size_t)src->size * src->size;
+    memcpy(dst->s, src->s, cells * sizeof(float));
+    memcpy(dst->u, src->u, cells * sizeof(float));
+    memcpy(dst->frozen, src->frozen, cells * sizeof(uint8_t));
+    memcpy(dst->freeze_step, src->freeze_step, cells * sizeof(uint16_t));
+    dst->step = src->step;
+    dst->params = src->params;
+    dst->stats = src->stats;
+}
+
+// ===================================================================
+// Function: Reset to the seed
+// ===================================================================
+void snowflake_model_reset(SnowflakeModel* model) {
+    int cells = model->size * model->size;
+    
+    // Initialize all cells
+    for(int i = 0; i < cells; i++) {
+        model->s[i] = model->params.beta;
+        model->u[i] = 0.0f;
+        model->frozen[i] = 0;
+        model->freeze_step[i] = SNOWFLAKE_NOT_FROZEN;
+    }
+    
+    memset(&model->stats, 0, sizeof(SnowflakeStats));
+    
+    // Freeze center cell; cells freeze in the step after model->step, so
+    // the seed gets freeze step 0
+    int center = model->size / 2;
+    model->step = -1;
+    model->s[snowflake_model_index(model, center, center)] = 1.0f;
+    snowflake_model_freeze_cell(model, center, center);
+    
+    model->step = 0;
+}
+
+// ===================================================================
+// Function: Step 1 - Classify cells and set u values
+// ===================================================================
+void snowflake_model_classify(SnowflakeModel* model) {
+    int size = model->size;
+    
+    for(int y = 0; y < size; y++) {
+        for(int x = 0; x < size; x++) {
+            int idx = snowflake_model_index(model, x, y);
+            bool is_receptive = model->frozen[idx] || is_boundary_cell(model, x, y);
+            
+            if(is_receptive) {
+                model->u[idx] = 0.0f;
+            } else {
+                model->u[idx] = model->s[idx];
+            }
+        }
+    }
+}
+
+// ===================================================================
+// Function: Step 2 - Diffusion
+// ===================================================================
+void snowflake_model_diffuse(SnowflakeModel* model) {
+    int size = model->size;
+    const SnowflakeParams* params = &model->params;
+    float* u_new = model->u_new;
+    
+    for(int y = 0; y < size; y++) {
+        for(int x = 0; x < size; x++) {
+            int idx = snowflake_model_index(model, x, y);
+            
+            // Border cells (2 from edge) maintain beta level
+            if(snowflake_model_is_border(model, x, y)) {
+                u_new[idx] = params->beta;
+                continue;
+            }
+            
+            // Get hex neighbors with proper offset
+            int neighbors_x[6], neighbors_y[6];
+            get_hex_neighbors(x, y, neighbors_x, neighbors_y);
+            
+            float sum = 0.0f;
+            int count = 0;
+            
+            for(int i = 0; i < 6; i++) {
+                int nx = neighbors_x[i];
+                int ny = neighbors_y[i];
+                
+                if(in_lattice(model, nx, ny)) {
+                    sum += model->u[snowflake_model_index(model, nx, ny)];
+                    count++;
+                }
+            }
+            
+            float avg = (count > 0) ? (sum / count) : model->u[idx];
+            u_new[idx] = model->u[idx] + (params->alpha / 2.0f) * (avg - model->u[idx]);
+        }
+    }
+    
+    memcpy(model->u, u_new, (size_t)size * size * sizeof(float));
+}
+
+// ===================================================================
+// Function: Step 3 - Add background vapor and update s = u + (v + gamma)
+// Use two-phase update to avoid directional bias
+// ===================================================================
+int snowflake_model_update(SnowflakeModel* model) {
+    int size = model->size;
+    int cells = size * size;
+    const SnowflakeParams* params = &model->params;
+    float* s_new = model->s_new;
+    uint8_t* frozen_new = model->frozen_new;
+    
+    // Copy current frozen state
+    memcpy(frozen_new, model->frozen, cells * sizeof(uint8_t));
+    
+    int frozen_count = 0;
+    
+    // Phase 1: Calculate new s values and determine which cells should freeze
+    // using the CURRENT (unchanged) frozen state
+    for(int y = 0; y < size; y++) {
+        for(int x = 0; x < size; x++) {
+            int idx = snowflake_model_index(model, x, y);
+            
+            // Border cells (2 from edge): always maintain beta, never freeze
+            if(snowflake_model_is_border(model, x, y)) {
+                s_new[idx] = params->beta;
+                frozen_new[idx] = 0;
+                continue;
+            }
+            
+            // Use OLD frozen state for receptiveness check
+            bool is_receptive = model->frozen[idx] || is_boundary_cell(model, x, y);
+            
+            if(is_receptive) {
+                // Receptive: s_new = u_new + (s_old + gamma)
+                s_new[idx] = model->u[idx] + model->s[idx] + params->gamma;
+                
+                // Mark for freezing if threshold reached
+                if(!model->frozen[idx] && s_new[idx] >= 1.0f) {
+                    frozen_new[idx] = 1;
+                    frozen_count++;
+                }
+            } else {
+                // Non-receptive: s = u (v=0 for non-receptive)
+                s_new[idx] = model->u[idx];
+            }
+        }
+    }
+    
+    // Phase 2: Commit all changes atomically
+    memcpy(model->s, s_new, cells * sizeof(float));
+    snowflake_model_commit(model, 0, 0, size - 1, size - 1);
+    return frozen_count;
+}
+
+// ===================================================================
+// Function: Freeze the marked cells of a region and advance the step
+// ===================================================================
+void snowflake_model_commit(SnowflakeModel* model, int x0, int y0, int x1, int y1) {
+    const uint8_t* frozen_new = model->frozen_new;
+    for(int y = y0; y <= y1; y++) {
+        for(int x = x0; x <= x1; x++) {
+            int idx = snowflake_model_index(model, x, y);
+            if(frozen_new[idx] && !model->frozen[idx]) {
+                snowflake_model_freeze_cell(model, x, y);
+            }
+        }
+    }
+    
+    model->step++;
+}
+
+// ===================================================================
+// Function: Grow Snowflake (Reiter's model)
+// ===================================================================
+int snowflake_model_step(SnowflakeModel* model) {
+    const SnowflakeKernel* kernel = model->kernel;
+    SNOWFLAKE_PROFILE_START(stamp);
+    kernel->classify(model);
+    SNOWFLAKE_PROFILE_LAP(model->profile, SNOWFLAKE_PHASE_CLASSIFY, stamp);
+    kernel->diffuse(model);
+    SNOWFLAKE_PROFILE_LAP(model->profile, SNOWFLAKE_PHASE_DIFFUSE, stamp);
+    int frozen_count = kernel->update(model);
+    SNOWFLAKE_PROFILE_LAP(model->profile, SNOWFLAKE_PHASE_UPDATE, stamp);
+    return frozen_count;
+}
+
+// ===================================================================
+// Setters and getters
+// ===================================================================
+void snowflake_model_set_params(SnowflakeModel* model, const SnowflakeParams* params) {
+    model->params = *params;
+}
+
+void snowflake_model_set_freeze_callback(
+    SnowflakeModel* model, SnowflakeFreezeCallback callback, void* context) {
+    model->freeze_callback = callback;
+    model->freeze_context = context;
+}
+
+void snowflake_model_set_profile(SnowflakeModel* model, SnowflakeProfile* profile) {
+    model->profile = profile;
+}
+
+void snowflake_model_set_kernel(SnowflakeModel* model, const SnowflakeKernel* kernel) {
+    model->kernel = kernel;
+}
+
+const SnowflakeKernel* snowflake_model_get_kernel(const SnowflakeModel* model) {
+    return model->kernel;
+}
+
+int snowflake_model_get_size(const SnowflakeModel* model) {
+    return model->size;
+}
+
+int snowflake_model_get_step(const SnowflakeModel* model) {
+    return model->step;
+}
+
+const SnowflakeParams* snowflake_model_get_params(const SnowflakeModel* model) {
+    return &model->params;
+}
+
+const SnowflakeStats* snowflake_model_get_stats(const SnowflakeModel* model) {
+    return &model->stats;
+}
+
+const float* snowflake_model_get_s(const SnowflakeModel* model) {
+    return model->s;
+}
+
+const uint8_t* snowflake_model_get_frozen(const SnowflakeModel* model) {
+    return model->frozen;
+}
+
+bool snowflake_model_is_frozen(const SnowflakeModel* model, int x, int y) {
+    return model->frozen[snowflake_model_index(model, x, y)];
+}
+
+const uint16_t* snowflake_model_get_freeze_steps(const SnowflakeModel* model) {
+    return model->freeze_step;
+}
+
+// ===================================================================
+// Function: Count the cells of the crystal as it was after a step
+// ===================================================================
+int snowflake_model_count_frozen_at(const SnowflakeModel* model, int step) {
+    if(step >= model->step) return model->stats.frozen_total;
+    
+    int cells = model->size * model->size;
+    int count = 0;
+    for(int i = 0; i < cells; i++) {
+        if(model->freeze_step[i] <= step) count++;
+    }
+    return count;
+}
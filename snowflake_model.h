@@ -0,0 +1,122 @@
+#pragma once
+
+// ===================================================================
+// Snowflake model: Reiter's local cellular model for snow crystal
+// growth on a hexagonal lattice.
+//
+// Portable C, no Furi dependencies: the same sources build into the
+// Flipper app and into the host tools (see Makefile).
+// ===================================================================
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct SnowflakeModel SnowflakeModel;
+struct SnowflakeProfile; // snowflake_profile.h
+struct SnowflakeKernel;  // snowflake_kernels.h
+
+// ===================================================================
+// Model parameters
+// ===================================================================
+typedef struct {
+    float alpha; // Diffusion constant
+    float beta;  // Boundary vapor level
+    float gamma; // Background vapor addition
+} SnowflakeParams;
+
+// ===================================================================
+// Running statistics, maintained incrementally by the step
+// ===================================================================
+typedef struct {
+    int frozen_total; // Number of frozen cells
+    int radius;       // Largest hex distance of a frozen cell from the seed
+    int perimeter;    // Number of boundary cells (unfrozen, next to the crystal)
+    int min_x, max_x; // Bounding box of the frozen cells
+    int min_y, max_y;
+} SnowflakeStats;
+
+// Freeze step of a cell that hasn't frozen; larger than any real one
+#define SNOWFLAKE_NOT_FROZEN 0xFFFF
+
+// Called once for every cell that freezes, in row-major order within a step
+typedef void (*SnowflakeFreezeCallback)(void* context, int x, int y);
+
+// ===================================================================
+// Lifecycle
+// ===================================================================
+
+/** Allocate a size x size lattice. Returns NULL if out of memory.
+ * The model starts reset with the given parameters.
+ */
+SnowflakeModel* snowflake_model_alloc(int size, const SnowflakeParams* params);
+
+void snowflake_model_free(SnowflakeModel* model);
+
+/** Copy fields, step, parameters and statistics of src into dst.
+ * Both models must have the same size. The freeze callback, profile and
+ * kernel are not copied.
+ */
+void snowflake_model_copy(SnowflakeModel* dst, const SnowflakeModel* src);
+
+// ===================================================================
+// Simulation
+// ===================================================================
+
+/** Reset to the seed: all cells at beta, the center cell frozen */
+void snowflake_model_reset(SnowflakeModel* model);
+
+/** Advance one step. Returns the number of cells that froze. */
+int snowflake_model_step(SnowflakeModel* model);
+
+void snowflake_model_set_params(SnowflakeModel* model, const SnowflakeParams* params);
+
+void snowflake_model_set_freeze_callback(
+    SnowflakeModel* model, SnowflakeFreezeCallback callback, void* context);
+
+/** Record the time of every step phase into profile (see snowflake_profile.h).
+ * Pass NULL to stop profiling. Not copied by snowflake_model_copy().
+ */
+void snowflake_model_set_profile(SnowflakeModel* model, struct SnowflakeProfile* profile);
+
+/** Run the step with another kernel from snowflake_kernels.h.
+ * Not copied by snowflake_model_copy().
+ */
+void snowflake_model_set_kernel(SnowflakeModel* model, const struct SnowflakeKernel* kernel);
+
+const struct SnowflakeKernel* snowflake_model_get_kernel(const SnowflakeModel* model);
+
+// ===================================================================
+// Read access
+// ===================================================================
+int snowflake_model_get_size(const SnowflakeModel* model);
+
+int snowflake_model_get_step(const SnowflakeModel* model);
+
+const SnowflakeParams* snowflake_model_get_params(const SnowflakeModel* model);
+
+const SnowflakeStats* snowflake_model_get_stats(const SnowflakeModel* model);
+
+/** Row-major water content field, size * size values */
+const float* snowflake_model_get_s(const SnowflakeModel* model);
+
+/** Row-major frozen mask, size * size values of 0 or 1 */
+const uint8_t* snowflake_model_get_frozen(const SnowflakeModel* model);
+
+bool snowflake_model_is_frozen(const SnowflakeModel* model, int x, int y);
+
+/** Row-major age map: the step after which each cell is frozen (0 for
+ * the seed), SNOWFLAKE_NOT_FROZEN for the others. Steps past 65534
+ * are stored as 65534. The crystal as it was after step t is the set
+ * of cells with a freeze step <= t.
+ */
+const uint16_t* snowflake_model_get_freeze_steps(const SnowflakeModel* model);
+
+/** Number of frozen cells after the given step, from the age map */
+int snowflake_model_count_frozen_at(const SnowflakeModel* model, int step);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,73 @@
+#pragma once
+
+// ===================================================================
+// Snowflake model internals, shared by the model sources only
+// ===================================================================
+#include "snowflake_model.h"
+#include "snowflake_profile.h"
+#include "snowflake_kernels.h"
+
+struct SnowflakeModel {
+    int size;        // Lattice is size x size logical hex cells
+    float* s;        // State values (water content)
+    float* u;        // Non-frozen diffusing water
+    uint8_t* frozen; // Boolean: is cell frozen?
+    uint16_t* freeze_step; // Step each cell froze in, SNOWFLAKE_NOT_FROZEN if it hasn't
+    int step;
+    
+    SnowflakeParams params;
+    SnowflakeStats stats;
+    
+    // Step scratch buffers, allocated once with the model
+    float* u_new;
+    float* s_new;
+    uint8_t* frozen_new;
+    uint8_t* receptive;  // Receptive mask, shared by the classify and update phase of a kernel
+    
+    SnowflakeFreezeCallback freeze_callback;
+    void* freeze_context;
+    
+    SnowflakeProfile* profile; // Phase timings of the step, NULL if not profiled
+    const SnowflakeKernel* kernel; // Step implementation
+};
+
+// ===================================================================
+// Function: Get array index
+// ===================================================================
+static inline int snowflake_model_index(const SnowflakeModel* model, int x, int y) {
+    return y * model->size + x;
+}
+
+// ===================================================================
+// Function: Check whether a cell lies in the border band
+// Border cells (2 cells from edge) maintain beta and never freeze
+// ===================================================================
+static inline bool snowflake_model_is_border(const SnowflakeModel* model, int x, int y) {
+    return x < 2 || x >= model->size - 2 || y < 2 || y >= model->size - 2;
+}
+
+// ===================================================================
+// Step phases of the reference kernel, run in this order by
+// snowflake_model_step(). Exposed separately so host tools can time
+// them one by one.
+// ===================================================================
+
+/** Step 1: u = 0 for receptive cells, u = s otherwise */
+void snowflake_model_classify(SnowflakeModel* model);
+
+/** Step 2: diffuse u over the hex neighbourhood */
+void snowflake_model_diffuse(SnowflakeModel* model);
+
+/** Step 3: update s, freeze cells reaching 1 and advance the step.
+ * Returns the number of cells that froze.
+ */
+int snowflake_model_update(SnowflakeModel* model);
+
+/** Freeze one cell, update the statistics and call the freeze callback */
+void snowflake_model_freeze_cell(SnowflakeModel* model, int x, int y);
+
+/** Phase 2 of every update: freeze the cells marked in frozen_new within
+ * columns x0..x1 and rows y0..y1 (inclusive), in row-major order, and
+ * advance the step. s must already hold the new values.
+ */
+void snowflake_model_commit(SnowflakeModel* model, int x0, int y0, int x1, int y1);
@@ -0,0 +1,558 @@
+// Includes
+#include "snowflake_paged.h"
+#include "snowflake_model_i.h"
+#include <stdlib.h>         // malloc, calloc, free, abs
+#include <string.h>         // memcpy, memset
+
+#define TILE SNOWFLAKE_PAGED_TILE
+#define TILE_CELLS (TILE * TILE)
+#define LINE_TILES SNOWFLAKE_PAGED_LINE_TILES
+#define HALO 3                    // Cells around a tile that its step reads
+#define WINDOW (TILE + 2 * HALO)  // Edge of a tile with its halo
+#define WINDOW_CELLS (WINDOW * WINDOW)
+
+// A tile as stored in the file and in the cache
+typedef struct {
+    float s[TILE_CELLS];
+    uint16_t freeze_step[TILE_CELLS];
+} PagedTile;
+
+typedef struct {
+    int64_t key;       // (copy * tiles per column + tile row) * lines per row + line, -1 = empty
+    int next;          // Next line in the same hash bucket, -1 = last
+    uint64_t used;     // Clock of the last lookup; the smallest is evicted first
+    bool kept;         // Written this step and kept for the next, never evicted
+    PagedTile* tiles;  // LINE_TILES neighbouring tiles of a tile row
+} PagedLine;
+
+struct SnowflakePaged {
+    int size;
+    int tiles_x;   // Tiles per row and column
+    int lines_x;   // Lines per tile row
+    int current;   // Copy in the file holding the state, 0 or 1
+    int step;
+    SnowflakeParams params;
+    SnowflakeStats stats;
+    SnowflakeBlockFile file;
+    SnowflakePagedIo io;
+    
+    PagedLine* lines;
+    int line_count;
+    int keep_lines;  // Lines of a sweep kept for the next, the rest serve the sweep
+    int kept;        // Lines kept so far in this sweep
+    int* buckets;    // First line of each hash bucket, -1 = none
+    int bucket_mask;
+    uint64_t clock;
+    PagedTile* out;  // Line of the next state being filled
+    
+    // One tile with its halo, WINDOW cells per row
+    float s[WINDOW_CELLS];
+    uint8_t frozen[WINDOW_CELLS];
+    uint8_t receptive[WINDOW_CELLS];
+    float u[WINDOW_CELLS];
+    float s_new[WINDOW_CELLS];
+    uint8_t frozen_new[WINDOW_CELLS];
+    uint16_t freeze_step[TILE_CELLS];  // Age map of the tile itself
+};
+
+// Neighbour offsets (dx, dy) per column parity, odd-q layout, N NE SE S SW NW
+static const int8_t hex_neighbors[2][6][2] = {
+    {{0, -1}, {1, -1}, {1, 0}, {0, 1}, {-1, 0}, {-1, -1}},
+    {{0, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}},
+};
+
+static inline bool is_interior(int size, int x, int y) {
+    return x >= 2 && x < size - 2 && y >= 2 && y < size - 2;
+}
+
+// ===================================================================
+// Function: Hex distance of a cell from the seed, as in the model
+// ===================================================================
+static int hex_distance_from_center(int size, int x, int y) {
+    int center = size / 2;
+    int dq = x - center;
+    int dr = (y - (x - (x & 1)) / 2) - (center - (center - (center & 1)) / 2);
+    int ds = -dq - dr;
+    int d = abs(dq);
+    if(abs(dr) > d) d = abs(dr);
+    if(abs(ds) > d) d = abs(ds);
+    return d;
+}
+
+// ===================================================================
+// Function: Where a line lives in the file
+// ===================================================================
+static int64_t line_key(const SnowflakePaged* paged, int copy, int ty, int lx) {
+    return ((int64_t)copy * paged->tiles_x + ty) * paged->lines_x + lx;
+}
+
+static uint64_t line_offset(const SnowflakePaged* paged, int copy, int ty, int lx) {
+    uint64_t tiles = (uint64_t)paged->tiles_x * paged->tiles_x;
+    uint64_t tile = (uint64_t)copy * tiles + (uint64_t)ty * paged->tiles_x + (uint64_t)lx * LINE_TILES;
+    return tile * sizeof(PagedTile);
+}
+
+static size_t line_bytes(const SnowflakePaged* paged, int lx) {
+    int tiles = paged->tiles_x - lx * LINE_TILES;
+    return (size_t)(tiles < LINE_TILES ? tiles : LINE_TILES) * sizeof(PagedTile);
+}
+
+// ===================================================================
+// Function: Cache lines by key, hashed into buckets
+// ===================================================================
+static PagedLine* cache_find(SnowflakePaged* paged, int64_t key) {
+    for(int i = paged->buckets[key & paged->bucket_mask]; i >= 0; i = paged->lines[i].next) {
+        if(paged->lines[i].key == key) return &paged->lines[i];
+    }
+    return NULL;
+}
+
+static void cache_unlink(SnowflakePaged* paged, PagedLine* line) {
+    if(line->key < 0) return;
+    int index = (int)(line - paged->lines);
+    int* link = &paged->buckets[line->key & paged->bucket_mask];
+    while(*link != index) link = &paged->lines[*link].next;
+    *link = line->next;
+    line->key = -1;
+}
+
+static void cache_link(SnowflakePaged* paged, PagedLine* line, int64_t key) {
+    int* head = &paged->buckets[key & paged->bucket_mask];
+    line->key = key;
+    line->next = *head;
+    *head = (int)(line - paged->lines);
+    line->used = ++paged->clock;
+}
+
+static void cache_clear(SnowflakePaged* paged) {
+    for(int i = 0; i < paged->line_count; i++) paged->lines[i].key = -1;
+    memset(paged->buckets, 0xFF, (size_t)(paged->bucket_mask + 1) * sizeof(int));
+}
+
+// Lines kept by the last sweep become ordinary ones for the next
+static void cache_release(SnowflakePaged* paged) {
+    for(int i = 0; i < paged->line_count; i++) paged->lines[i].kept = false;
+    paged->kept = 0;
+}
+
+// ===================================================================
+// Function: Line to replace: an empty one if there is any, otherwise
+// the least recently used one that is not kept
+// ===================================================================
+static PagedLine* cache_victim(SnowflakePaged* paged) {
+    PagedLine* victim = NULL;
+    for(int i = 0; i < paged->line_count; i++) {
+        PagedLine* line = &paged->lines[i];
+        if(line->key < 0) return line;
+        if(!line->kept && (!victim || line->used < victim->used)) victim = line;
+    }
+    return victim;
+}
+
+// ===================================================================
+// Function: Tile of a copy, through the cache; NULL on a read failure
+// A miss reads the whole line, i.e. the next tiles of the sweep too.
+// ===================================================================
+static const PagedTile* paged_tile(SnowflakePaged* paged, int copy, int tx, int ty) {
+    int lx = tx / LINE_TILES;
+    int64_t key = line_key(paged, copy, ty, lx);
+    PagedLine* line = cache_find(paged, key);
+    if(line) {
+        paged->io.hits++;
+        line->used = ++paged->clock;
+    } else {
+        line = cache_victim(paged);
+        cache_unlink(paged, line);
+        size_t bytes = line_bytes(paged, lx);
+        if(!paged->file.read(paged->file.context, line_offset(paged, copy, ty, lx), line->tiles, bytes)) return NULL;
+        paged->io.misses++;
+        paged->io.bytes_read += bytes;
+        cache_link(paged, line, key);
+    }
+    return &line->tiles[tx % LINE_TILES];
+}
+
+// ===================================================================
+// Function: Write the filled out line to a copy
+// The first keep_lines lines of a sweep stay cached for the next one,
+// which starts on them: the out buffer takes the place of a cached
+// line, which becomes the next out buffer. Under plain LRU the sweep's
+// reads would evict every written line before the next sweep got to
+// it. An older version of the line is dropped either way.
+// ===================================================================
+static bool paged_write_line(SnowflakePaged* paged, int copy, int ty, int lx) {
+    size_t bytes = line_bytes(paged, lx);
+    if(!paged->file.write(paged->file.context, line_offset(paged, copy, ty, lx), paged->out, bytes)) return false;
+    paged->io.bytes_written += bytes;
+    
+    int64_t key = line_key(paged, copy, ty, lx);
+    PagedLine* line = cache_find(paged, key);
+    if(line) cache_unlink(paged, line);
+    if(paged->kept >= paged->keep_lines) return true;
+    
+    line = cache_victim(paged);
+    cache_unlink(paged, line);
+    PagedTile* tiles = line->tiles;
+    line->tiles = paged->out;
+    paged->out = tiles;
+    cache_link(paged, line, key);
+    line->kept = true;
+    paged->kept++;
+    return true;
+}
+
+// ===================================================================
+// Function: Gather a tile and its halo from the 3x3 tiles around it
+// Cells past the lattice edge read as empty vapor-free cells.
+// ===================================================================
+static bool paged_gather(SnowflakePaged* paged, int copy, int tx, int ty) {
+    int size = paged->size;
+    int x0 = tx * TILE - HALO, y0 = ty * TILE - HALO;
+    memset(paged->s, 0, sizeof(paged->s));
+    memset(paged->frozen, 0, sizeof(paged->frozen));
+    
+    for(int nty = ty - 1; nty <= ty + 1; nty++) {
+        if(nty < 0 || nty >= paged->tiles_x) continue;
+        for(int ntx = tx - 1; ntx <= tx + 1; ntx++) {
+            if(ntx < 0 || ntx >= paged->tiles_x) continue;
+            const PagedTile* tile = paged_tile(paged, copy, ntx, nty);
+            if(!tile) return false;
+            
+            // Overlap of the tile, the window and the lattice
+            int left = ntx * TILE > x0 ? ntx * TILE : x0;
+            int top = nty * TILE > y0 ? nty * TILE : y0;
+            int right = ntx * TILE + TILE < x0 + WINDOW ? ntx * TILE + TILE : x0 + WINDOW;
+            int bottom = nty * TILE + TILE < y0 + WINDOW ? nty * TILE + TILE : y0 + WINDOW;
+            if(right > size) right = size;
+            if(bottom > size) bottom = size;
+            for(int y = top; y < bottom; y++) {
+                int src = (y - nty * TILE) * TILE - ntx * TILE;
+                int dst = (y - y0) * WINDOW - x0;
+                for(int x = left; x < right; x++) {
+                    paged->s[dst + x] = tile->s[src + x];
+                    paged->frozen[dst + x] = tile->freeze_step[src + x] != SNOWFLAKE_NOT_FROZEN;
+                }
+            }
+            if(ntx == tx && nty == ty) memcpy(paged->freeze_step, tile->freeze_step, sizeof(paged->freeze_step));
+        }
+    }
+    return true;
+}
+
+// ===================================================================
+// Function: Step the gathered tile into out
+// The reference phases with the same float operations, over shrinking
+// rings of the window: the receptive mask and u on all but the outer
+// ring, new s and freezing on all but two, so the new frozen mask is
+// known one cell around the tile for its perimeter. Returns the number
+// of cells of the tile that froze and adds them to stats.
+// ===================================================================
+static int paged_tile_step(SnowflakePaged* paged, int tx, int ty, SnowflakeStats* stats, PagedTile* out) {
+    int size = paged->size;
+    int x0 = tx * TILE - HALO, y0 = ty * TILE - HALO;
+    const float beta = paged->params.beta;
+    const float gamma = paged->params.gamma;
+    const float half_alpha = paged->params.alpha / 2.0f;
+    const float* s = paged->s;
+    const uint8_t* frozen = paged->frozen;
+    uint8_t* receptive = paged->receptive;
+    float* u = paged->u;
+    float* s_new = paged->s_new;
+    uint8_t* frozen_new = paged->frozen_new;
+    
+    // Step 1: receptive cells are frozen or next to a frozen one, never in the border band
+    for(int wy = 1; wy < WINDOW - 1; wy++) {
+        for(int wx = 1; wx < WINDOW - 1; wx++) {
+            int i = wy * WINDOW + wx;
+            int x = x0 + wx;
+            uint8_t is_receptive = 0;
+            if(is_interior(size, x, y0 + wy)) {
+                const uint8_t* f = frozen + i;
+                if(x & 1) {
+                    is_receptive = f[0] | f[-WINDOW] | f[1] | f[WINDOW + 1] | f[WINDOW] | f[WINDOW - 1] | f[-1];
+                } else {
+                    is_receptive = f[0] | f[-WINDOW] | f[-WINDOW + 1] | f[1] | f[WINDOW] | f[-1] | f[-WINDOW - 1];
+                }
+            }
+            receptive[i] = is_receptive;
+            u[i] = is_receptive ? 0.0f : s[i];
+        }
+    }
+    
+    // Steps 2 and 3: diffuse, then update s and mark the cells that freeze
+    for(int wy = 2; wy < WINDOW - 2; wy++) {
+        for(int wx = 2; wx < WINDOW - 2; wx++) {
+            int i = wy * WINDOW + wx;
+            int x = x0 + wx;
+            frozen_new[i] = frozen[i];
+            if(!is_interior(size, x, y0 + wy)) {
+                s_new[i] = beta;
+                continue;
+            }
+            
+            const float* c = u + i;
+            float sum = 0.0f;
+            if(x & 1) {
+                sum += c[-WINDOW];
+                sum += c[1];
+                sum += c[WINDOW + 1];
+                sum += c[WINDOW];
+                sum += c[WINDOW - 1];
+                sum += c[-1];
+            } else {
+                sum += c[-WINDOW];
+                sum += c[-WINDOW + 1];
+                sum += c[1];
+                sum += c[WINDOW];
+                sum += c[-1];
+                sum += c[-WINDOW - 1];
+            }
+            float avg = sum / 6;
+            float u_new = c[0] + half_alpha * (avg - c[0]);
+            
+            if(receptive[i]) {
+                s_new[i] = u_new + s[i] + gamma;
+                if(!frozen[i] && s_new[i] >= 1.0f) frozen_new[i] = 1;
+            } else {
+                s_new[i] = u_new;
+            }
+        }
+    }
+    
+    // The tile's own cells: new state, statistics and the new perimeter
+    int frozen_count = 0;
+    uint16_t freeze_step = paged->step < SNOWFLAKE_NOT_FROZEN - 1 ? (uint16_t)(paged->step + 1) :
+                                                                   SNOWFLAKE_NOT_FROZEN - 1;
+    for(int cy = 0; cy < TILE; cy++) {
+        for(int cx = 0; cx < TILE; cx++) {
+            int cell = cy * TILE + cx;
+            int x = tx * TILE + cx, y = ty * TILE + cy;
+            if(x >= size || y >= size) {
+                out->s[cell] = 0.0f;
+                out->freeze_step[cell] = SNOWFLAKE_NOT_FROZEN;
+                continue;
+            }
+            
+            int i = (cy + HALO) * WINDOW + cx + HALO;
+            out->s[cell] = s_new[i];
+            out->freeze_step[cell] = paged->freeze_step[cell];
+            if(frozen_new[i] && !frozen[i]) {
+                out->freeze_step[cell] = freeze_step;
+                frozen_count++;
+                if(x < stats->min_x) stats->min_x = x;
+                if(x > stats->max_x) stats->max_x = x;
+                if(y < stats->min_y) stats->min_y = y;
+                if(y > stats->max_y) stats->max_y = y;
+                int distance = hex_distance_from_center(size, x, y);
+                if(distance > stats->radius) stats->radius = distance;
+            }
+            
+            if(!frozen_new[i] && is_interior(size, x, y)) {
+                for(int n = 0; n < 6; n++) {
+                    const int8_t* offset = hex_neighbors[x & 1][n];
+                    if(frozen_new[i + offset[1] * WINDOW + offset[0]]) {
+                        stats->perimeter++;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    stats->frozen_total += frozen_count;
+    return frozen_count;
+}
+
+// ===================================================================
+// Function: Allocate / free
+// ===================================================================
+SnowflakePaged* snowflake_paged_alloc(
+    int size, const SnowflakeParams* params, const SnowflakeBlockFile* file, size_t cache_bytes) {
+    if(size < 5) return NULL;
+    SnowflakePaged* paged = calloc(1, sizeof(SnowflakePaged));
+    if(!paged) return NULL;
+    
+    paged->size = size;
+    paged->tiles_x = (size + TILE - 1) / TILE;
+    paged->lines_x = (paged->tiles_x + LINE_TILES - 1) / LINE_TILES;
+    paged->params = *params;
+    paged->file = *file;
+    
+    // Never more lines than both copies have
+    size_t lines = cache_bytes / SNOWFLAKE_PAGED_LINE_BYTES;
+    size_t all_lines = 2 * (size_t)paged->tiles_x * paged->lines_x;
+    if(lines > all_lines) lines = all_lines;
+    if(lines < SNOWFLAKE_PAGED_MIN_LINES) lines = SNOWFLAKE_PAGED_MIN_LINES;
+    paged->line_count = (int)lines;
+    
+    // A sweep reads each line once if the three tile rows it spans are left to it
+    paged->keep_lines = paged->line_count - 3 * paged->lines_x;
+    if(paged->keep_lines < 0) paged->keep_lines = 0;
+    int buckets = 1;
+    while(buckets < paged->line_count) buckets *= 2;
+    paged->bucket_mask = buckets - 1;
+    
+    paged->lines = calloc(lines, sizeof(PagedLine));
+    paged->buckets = malloc((size_t)buckets * sizeof(int));
+    paged->out = malloc(SNOWFLAKE_PAGED_LINE_BYTES);
+    bool ok = paged->lines && paged->buckets && paged->out;
+    for(int i = 0; ok && i < paged->line_count; i++) {
+        paged->lines[i].tiles = malloc(SNOWFLAKE_PAGED_LINE_BYTES);
+        ok = paged->lines[i].tiles != NULL;
+    }
+    
+    if(!ok || !snowflake_paged_reset(paged)) {
+        snowflake_paged_free(paged);
+        return NULL;
+    }
+    return paged;
+}
+
+void snowflake_paged_free(SnowflakePaged* paged) {
+    if(!paged) return;
+    if(paged->lines) {
+        for(int i = 0; i < paged->line_count; i++) free(paged->lines[i].tiles);
+    }
+    free(paged->lines);
+    free(paged->buckets);
+    free(paged->out);
+    free(paged);
+}
+
+// ===================================================================
+// Function: Reset to the seed
+// Both copies are written as a step would, the current one last so
+// that it is the one cached.
+// ===================================================================
+bool snowflake_paged_reset(SnowflakePaged* paged) {
+    int size = paged->size;
+    int center = size / 2;
+    cache_clear(paged);
+    
+    for(int copy = 1; copy >= 0; copy--) {
+        cache_release(paged);
+        for(int ty = 0; ty < paged->tiles_x; ty++) {
+            for(int tx = 0; tx < paged->tiles_x; tx++) {
+                PagedTile* tile = &paged->out[tx % LINE_TILES];
+                for(int cell = 0; cell < TILE_CELLS; cell++) {
+                    int x = tx * TILE + cell % TILE, y = ty * TILE + cell / TILE;
+                    bool inside = x < size && y < size;
+                    bool seed = x == center && y == center;
+                    tile->s[cell] = seed ? 1.0f : (inside ? paged->params.beta : 0.0f);
+                    tile->freeze_step[cell] = seed ? 0 : SNOWFLAKE_NOT_FROZEN;
+                }
+                if(tx % LINE_TILES == LINE_TILES - 1 || tx == paged->tiles_x - 1) {
+                    if(!paged_write_line(paged, copy, ty, tx / LINE_TILES)) return false;
+                }
+            }
+        }
+    }
+    
+    memset(&paged->stats, 0, sizeof(SnowflakeStats));
+    paged->stats.frozen_total = 1;
+    paged->stats.min_x = paged->stats.max_x = center;
+    paged->stats.min_y = paged->stats.max_y = center;
+    for(int n = 0; n < 6; n++) {
+        const int8_t* offset = hex_neighbors[center & 1][n];
+        if(is_interior(size, center + offset[0], center + offset[1])) paged->stats.perimeter++;
+    }
+    paged->current = 0;
+    paged->step = 0;
+    return true;
+}
+
+// ===================================================================
+// Function: One step as a sweep over the tile rows
+// The next state goes to the other copy, so a failure keeps this one.
+// ===================================================================
+int snowflake_paged_step(SnowflakePaged* paged) {
+    int source = paged->current;
+    int target = source ^ 1;
+    SnowflakeStats stats = paged->stats;
+    stats.perimeter = 0;
+    int frozen_count = 0;
+    cache_release(paged);
+    
+    for(int ty = 0; ty < paged->tiles_x; ty++) {
+        for(int tx = 0; tx < paged->tiles_x; tx++) {
+            if(!paged_gather(paged, source, tx, ty)) return -1;
+            frozen_count += paged_tile_step(paged, tx, ty, &stats, &paged->out[tx % LINE_TILES]);
+            if(tx % LINE_TILES == LINE_TILES - 1 || tx == paged->tiles_x - 1) {
+                if(!paged_write_line(paged, target, ty, tx / LINE_TILES)) return -1;
+            }
+        }
+        
+        // The tile row above was read for the last time this step
+        for(int lx = 0; ty > 0 && lx < paged->lines_x; lx++) {
+            PagedLine* line = cache_find(paged, line_key(paged, source, ty - 1, lx));
+            if(line) cache_unlink(paged, line);
+        }
+    }
+    
+    paged->stats = stats;
+    paged->current = target;
+    paged->step++;
+    return frozen_count;
+}
+
+// ===================================================================
+// Function: Copy the state into a model
+// ===================================================================
+bool snowflake_paged_load(SnowflakePaged* paged, SnowflakeModel* model) {
+    int size = model->size;
+    for(int ty = 0; ty < paged->tiles_x; ty++) {
+        for(int tx = 0; tx < paged->tiles_x; tx++) {
+            const PagedTile* tile = paged_tile(paged, paged->current, tx, ty);
+            if(!tile) return false;
+            int x0 = tx * TILE, y0 = ty * TILE;
+            int width = size - x0 < TILE ? size - x0 : TILE;
+            int height = size - y0 < TILE ? size - y0 : TILE;
+            
+            for(int y = 0; y < height; y++) {
+                int idx = (y0 + y) * size + x0;
+                int cell = y * TILE;
+                memcpy(&model->s[idx], &tile->s[cell], (size_t)width * sizeof(float));
+                memcpy(&model->freeze_step[idx], &tile->freeze_step[cell], (size_t)width * sizeof(uint16_t));
+                for(int x = 0; x < width; x++) {
+                    model->frozen[idx + x] = tile->freeze_step[cell + x] != SNOWFLAKE_NOT_FROZEN;
+                    model->u[idx + x] = 0.0f;
+                }
+            }
+        }
+    }
+    
+    model->step = paged->step;
+    model->params = paged->params;
+    model->stats = paged->stats;
+    return true;
+}
+
+// ===================================================================
+// Setters and getters
+// ===================================================================
+void snowflake_paged_set_params(SnowflakePaged* paged, const SnowflakeParams* params) {
+    paged->params = *params;
+}
+
+int snowflake_paged_get_size(const SnowflakePaged* paged) {
+    return paged->size;
+}
+
+int snowflake_paged_get_step(const SnowflakePaged* paged) {
+    return paged->step;
+}
+
+const SnowflakeParams* snowflake_paged_get_params(const SnowflakePaged* paged) {
+    return &paged->params;
+}
+
+const SnowflakeStats* snowflake_paged_get_stats(const SnowflakePaged* paged) {
+    return &paged->stats;
+}
+
+int snowflake_paged_get_cache_lines(const SnowflakePaged* paged) {
+    return paged->line_count;
+}
+
+const SnowflakePagedIo* snowflake_paged_get_io(const SnowflakePaged* paged) {
+    return &paged->io;
+}
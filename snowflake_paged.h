@@ -0,0 +1,99 @@
+#pragma once
+
+// ===================================================================
+// Out-of-core lattice: the model's fields in tiles on SD
+//
+// For lattices whose arrays do not fit in RAM. s and the age map live
+// in a scratch block file (a file on the SD card, a plain file on the
+// host) as tiles of SNOWFLAKE_PAGED_TILE x SNOWFLAKE_PAGED_TILE cells,
+// in row-major tile order. The file holds two copies of the lattice:
+// a step reads the current one and writes the next, so it never
+// overwrites cells a later tile still needs, and a step that fails on
+// I/O leaves the state as it was.
+//
+// The step sweeps the lattice in bands of one tile row, left to right.
+// Each tile is computed from its cells and a halo of three (receptive
+// cells two away feed the diffusion, one more ring gives the new
+// perimeter), gathered from the 3x3 tiles around it. Tiles are read
+// through a small LRU cache in lines of SNOWFLAKE_PAGED_LINE_TILES
+// neighbouring tiles, so a miss also fetches the next tiles of the
+// sweep, and written a line at a time: file I/O streams along the
+// tile rows. With room for three tile rows, each line is read once
+// per step, otherwise up to three times. Room beyond that keeps the
+// first lines written for the next step, so reads shrink with the
+// cache until one copy and three tile rows need none.
+//
+// Results are bit-identical to the in-RAM model, statistics included.
+// There is no freeze callback; snowflake_paged_load copies the state
+// into a model when it fits, to draw, export or keep growing it.
+//
+// Portable C like the model, so host tools run the same code.
+// ===================================================================
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "snowflake_io.h"
+#include "snowflake_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNOWFLAKE_PAGED_TILE 16       // Tile edge in cells
+#define SNOWFLAKE_PAGED_LINE_TILES 2  // Tiles of a tile row read or written at once
+#define SNOWFLAKE_PAGED_TILE_BYTES (SNOWFLAKE_PAGED_TILE * SNOWFLAKE_PAGED_TILE * (sizeof(float) + sizeof(uint16_t)))
+#define SNOWFLAKE_PAGED_LINE_BYTES (SNOWFLAKE_PAGED_LINE_TILES * SNOWFLAKE_PAGED_TILE_BYTES)
+#define SNOWFLAKE_PAGED_MIN_LINES 7   // Lines a tile's neighbourhood can span and the one written
+
+typedef struct SnowflakePaged SnowflakePaged;
+
+typedef struct {
+    uint64_t hits;           // Tile lookups served from the cache
+    uint64_t misses;         // Lookups that read a line from the file
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+} SnowflakePagedIo;
+
+/** Out-of-core lattice of size x size cells in file, with a tile cache
+ * of about cache_bytes (at least SNOWFLAKE_PAGED_MIN_LINES lines). The
+ * RAM taken does not depend on the lattice size. Writes both copies of
+ * the seed state, so a file that cannot hold them fails here rather
+ * than mid-run. Returns NULL if out of memory or on a write failure.
+ */
+SnowflakePaged* snowflake_paged_alloc(
+    int size, const SnowflakeParams* params, const SnowflakeBlockFile* file, size_t cache_bytes);
+
+void snowflake_paged_free(SnowflakePaged* paged);
+
+/** Reset to the seed, as snowflake_model_reset. Returns false on a write failure. */
+bool snowflake_paged_reset(SnowflakePaged* paged);
+
+/** Advance one step. Returns the number of cells that froze, or -1 on
+ * I/O failure, in which case the state is unchanged.
+ */
+int snowflake_paged_step(SnowflakePaged* paged);
+
+void snowflake_paged_set_params(SnowflakePaged* paged, const SnowflakeParams* params);
+
+/** Copy the state into a model of the same size, as snowflake_tiles_load.
+ * Returns false on a read failure.
+ */
+bool snowflake_paged_load(SnowflakePaged* paged, SnowflakeModel* model);
+
+int snowflake_paged_get_size(const SnowflakePaged* paged);
+
+int snowflake_paged_get_step(const SnowflakePaged* paged);
+
+const SnowflakeParams* snowflake_paged_get_params(const SnowflakePaged* paged);
+
+const SnowflakeStats* snowflake_paged_get_stats(const SnowflakePaged* paged);
+
+/** Cache lines allocated, each SNOWFLAKE_PAGED_LINE_BYTES */
+int snowflake_paged_get_cache_lines(const SnowflakePaged* paged);
+
+/** File traffic since the lattice was allocated */
+const SnowflakePagedIo* snowflake_paged_get_io(const SnowflakePaged* paged);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,26 @@
+// Includes
+#include "snowflake_presets.h"
+#include <string.h>         // strcmp
+
+// ===================================================================
+// Presets
+// High vapor gives compact plates, the app defaults give sectored
+// plates, low vapor with little background addition gives dendrites.
+// ===================================================================
+const SnowflakePreset snowflake_presets[] = {
+    {"plate", {.alpha = 2.0f, .beta = 0.8f, .gamma = 0.01f}},
+    {"sectored", {.alpha = 1.0f, .beta = 0.5f, .gamma = 0.01f}},
+    {"dendritic", {.alpha = 1.0f, .beta = 0.4f, .gamma = 0.001f}},
+};
+
+const size_t snowflake_preset_count = sizeof(snowflake_presets) / sizeof(snowflake_presets[0]);
+
+// ===================================================================
+// Function: Find preset by name
+// ===================================================================
+const SnowflakePreset* snowflake_preset_find(const char* name) {
+    for(size_t i = 0; i < snowflake_preset_count; i++) {
+        if(strcmp(snowflake_presets[i].name, name) == 0) return &snowflake_presets[i];
+    }
+    return NULL;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+// ===================================================================
+// Parameter presets covering the main growth regimes of the model
+// Shared by the app and the host tools so benchmarks and tests run
+// the same workloads everywhere.
+// ===================================================================
+#include <stddef.h>
+#include "snowflake_model.h"
+
+typedef struct {
+    const char* name;
+    SnowflakeParams params;
+} SnowflakePreset;
+
+extern const SnowflakePreset snowflake_presets[];
+extern const size_t snowflake_preset_count;
+
+/** Preset by name, or NULL if unknown */
+const SnowflakePreset* snowflake_preset_find(const char* name);
@@ -0,0 +1,63 @@
+// Includes
+#include "snowflake_profile.h"
+#include <string.h>         // memset
+
+static const char* const phase_names[SNOWFLAKE_PHASE_COUNT] = {
+    "classify",
+    "diffuse",
+    "update",
+    "draw",
+};
+
+// ===================================================================
+// Function: Drop all samples
+// ===================================================================
+void snowflake_profile_reset(SnowflakeProfile* profile) {
+    memset(profile, 0, sizeof(SnowflakeProfile));
+}
+
+// ===================================================================
+// Function: Add a sample, overwriting the oldest once the window is full
+// ===================================================================
+void snowflake_profile_add(SnowflakeProfile* profile, SnowflakePhase phase, uint32_t ticks) {
+    SnowflakeProfileWindow* window = &profile->phases[phase];
+    window->samples[window->head] = ticks;
+    window->head = (window->head + 1) % SNOWFLAKE_PROFILE_WINDOW;
+    if(window->count < SNOWFLAKE_PROFILE_WINDOW) window->count++;
+}
+
+// ===================================================================
+// Function: Min / avg / max over the window
+// ===================================================================
+void snowflake_profile_get_stats(
+    const SnowflakeProfile* profile, SnowflakePhase phase, SnowflakeProfileStats* stats) {
+    const SnowflakeProfileWindow* window = &profile->phases[phase];
+    memset(stats, 0, sizeof(SnowflakeProfileStats));
+    if(window->count == 0) return;
+    
+    uint64_t sum = 0;
+    stats->min = UINT32_MAX;
+    for(int i = 0; i < window->count; i++) {
+        uint32_t sample = window->samples[i];
+        if(sample < stats->min) stats->min = sample;
+        if(sample > stats->max) stats->max = sample;
+        sum += sample;
+    }
+    stats->avg = (uint32_t)(sum / window->count);
+    stats->count = window->count;
+}
+
+// ===================================================================
+// Function: Tick rate of snowflake_profile_now()
+// ===================================================================
+uint32_t snowflake_profile_ticks_per_us(void) {
+#ifdef SNOWFLAKE_HOST
+    return 1000;
+#else
+    return furi_hal_cortex_instructions_per_microsecond();
+#endif
+}
+
+const char* snowflake_profile_phase_name(SnowflakePhase phase) {
+    return (phase < SNOWFLAKE_PHASE_COUNT) ? phase_names[phase] : "?";
+}
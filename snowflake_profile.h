@@ -0,0 +1,113 @@
+#pragma once
+
+// ===================================================================
+// Step and draw profiling
+//
+// On the device, timestamps come from the Cortex-M4 DWT cycle counter
+// (CYCCNT, one tick per CPU cycle). Host builds (SNOWFLAKE_HOST, set by
+// the Makefile) use clock_gettime with one tick per nanosecond instead,
+// so the same instrumentation runs in the host tools.
+//
+// Each phase keeps a rolling window of the last SNOWFLAKE_PROFILE_WINDOW
+// samples. Build with SNOWFLAKE_PROFILE=0 to compile the timing out.
+// ===================================================================
+#include <stdint.h>
+
+#ifdef SNOWFLAKE_HOST
+#include <time.h>           // clock_gettime
+#else
+#include <furi_hal.h>       // DWT cycle counter
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SNOWFLAKE_PROFILE
+#define SNOWFLAKE_PROFILE 1
+#endif
+
+#define SNOWFLAKE_PROFILE_WINDOW 32 // Samples per phase in the rolling window
+
+typedef enum {
+    SNOWFLAKE_PHASE_CLASSIFY,
+    SNOWFLAKE_PHASE_DIFFUSE,
+    SNOWFLAKE_PHASE_UPDATE,
+    SNOWFLAKE_PHASE_DRAW,
+    SNOWFLAKE_PHASE_COUNT
+} SnowflakePhase;
+
+typedef struct {
+    uint32_t samples[SNOWFLAKE_PROFILE_WINDOW]; // Ticks, oldest overwritten first
+    uint8_t head;                               // Next slot to write
+    uint8_t count;                              // Valid samples, up to the window size
+} SnowflakeProfileWindow;
+
+typedef struct SnowflakeProfile {
+    SnowflakeProfileWindow phases[SNOWFLAKE_PHASE_COUNT];
+} SnowflakeProfile;
+
+typedef struct {
+    uint32_t min; // Ticks
+    uint32_t avg;
+    uint32_t max;
+    uint8_t count; // Samples the figures are taken over, 0 if none yet
+} SnowflakeProfileStats;
+
+// ===================================================================
+// Function: Current timestamp in ticks, wraps around
+// ===================================================================
+static inline uint32_t snowflake_profile_now(void) {
+#ifdef SNOWFLAKE_HOST
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+#else
+    return DWT->CYCCNT;
+#endif
+}
+
+#if SNOWFLAKE_PROFILE
+/** Declare a timestamp variable and start timing */
+#define SNOWFLAKE_PROFILE_START(stamp) uint32_t stamp = snowflake_profile_now()
+
+/** Record the ticks since stamp for a phase and restart stamp.
+ * Does nothing if profile is NULL.
+ */
+#define SNOWFLAKE_PROFILE_LAP(profile, phase, stamp)                          \
+    do {                                                                      \
+        if(profile) {                                                         \
+            uint32_t snowflake_profile_now_ = snowflake_profile_now();        \
+            snowflake_profile_add((profile), (phase), snowflake_profile_now_ - (stamp)); \
+            (stamp) = snowflake_profile_now_;                                 \
+        }                                                                     \
+    } while(0)
+#else
+#define SNOWFLAKE_PROFILE_START(stamp) \
+    do {                               \
+    } while(0)
+#define SNOWFLAKE_PROFILE_LAP(profile, phase, stamp) \
+    do {                                             \
+        (void)(profile);                             \
+    } while(0)
+#endif
+
+/** Drop all samples */
+void snowflake_profile_reset(SnowflakeProfile* profile);
+
+/** Add one sample to the rolling window of a phase */
+void snowflake_profile_add(SnowflakeProfile* profile, SnowflakePhase phase, uint32_t ticks);
+
+/** Min, average and max over the current window of a phase */
+void snowflake_profile_get_stats(
+    const SnowflakeProfile* profile, SnowflakePhase phase, SnowflakeProfileStats* stats);
+
+/** Ticks per microsecond: CPU clock in MHz on the device, 1000 on the host */
+uint32_t snowflake_profile_ticks_per_us(void);
+
+/** Short phase name for overlays and logs */
+const char* snowflake_profile_phase_name(SnowflakePhase phase);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,92 @@
+// Includes
+#include "snowflake_recording.h"
+#include <string.h>         // memcpy, memcmp
+
+// ===================================================================
+// Function: Start a recording
+// ===================================================================
+bool snowflake_recorder_begin(
+    SnowflakeRecorder* recorder,
+    const SnowflakeWriter* writer,
+    const SnowflakeRecordingHeader* header,
+    uint32_t start_tick) {
+    memset(recorder, 0, sizeof(SnowflakeRecorder));
+    recorder->writer = *writer;
+    recorder->start_tick = start_tick;
+    recorder->last_tick = start_tick;
+    
+    uint8_t data[SNOWFLAKE_RECORDING_HEADER_SIZE];
+    uint32_t bits[3];
+    memcpy(&bits[0], &header->params.alpha, sizeof(uint32_t));
+    memcpy(&bits[1], &header->params.beta, sizeof(uint32_t));
+    memcpy(&bits[2], &header->params.gamma, sizeof(uint32_t));
+    
+    memcpy(data, "SFRC", 4);
+    snowflake_put_u16(data + 4, SNOWFLAKE_RECORDING_VERSION);
+    snowflake_put_u16(data + 6, (uint16_t)header->grid_size);
+    for(int i = 0; i < 3; i++) snowflake_put_u32(data + 8 + 4 * i, bits[i]);
+    
+    recorder->failed = !snowflake_write(writer, data, sizeof(data));
+    return !recorder->failed;
+}
+
+// ===================================================================
+// Function: Buffer one event
+// ===================================================================
+void snowflake_recorder_add(SnowflakeRecorder* recorder, uint8_t key, uint8_t type, uint32_t tick) {
+    if(recorder->failed) return;
+    if(recorder->used + 1 + SNOWFLAKE_VARINT_MAX > SNOWFLAKE_RECORDING_BUFFER) {
+        snowflake_recorder_flush(recorder);
+    }
+    
+    uint8_t* dst = recorder->buffer + recorder->used;
+    dst[0] = (uint8_t)((key << 4) | (type & 0x0F));
+    recorder->used += 1 + snowflake_put_varint(dst + 1, tick - recorder->last_tick);
+    recorder->last_tick = tick;
+    recorder->events++;
+}
+
+// ===================================================================
+// Function: Write out the buffer
+// ===================================================================
+bool snowflake_recorder_flush(SnowflakeRecorder* recorder) {
+    if(!recorder->failed && recorder->used > 0) {
+        recorder->failed = !snowflake_write(&recorder->writer, recorder->buffer, recorder->used);
+    }
+    recorder->used = 0;
+    return !recorder->failed;
+}
+
+// ===================================================================
+// Function: Read the header
+// ===================================================================
+bool snowflake_recording_read_header(const SnowflakeReader* reader, SnowflakeRecordingHeader* header) {
+    uint8_t data[SNOWFLAKE_RECORDING_HEADER_SIZE];
+    if(!snowflake_read(reader, data, sizeof(data))) return false;
+    if(memcmp(data, "SFRC", 4) != 0 || snowflake_get_u16(data + 4) != SNOWFLAKE_RECORDING_VERSION) {
+        return false;
+    }
+    
+    header->grid_size = snowflake_get_u16(data + 6);
+    uint32_t bits[3];
+    for(int i = 0; i < 3; i++) bits[i] = snowflake_get_u32(data + 8 + 4 * i);
+    memcpy(&header->params.alpha, &bits[0], sizeof(float));
+    memcpy(&header->params.beta, &bits[1], sizeof(float));
+    memcpy(&header->params.gamma, &bits[2], sizeof(float));
+    return true;
+}
+
+// ===================================================================
+// Function: Read the next event
+// ===================================================================
+bool snowflake_recording_read_event(const SnowflakeReader* reader, SnowflakeRecordedEvent* event) {
+    uint8_t packed;
+    uint32_t delta;
+    if(!snowflake_read(reader, &packed, 1)) return false;
+    if(!snowflake_read_varint(reader, &delta)) return false;
+    
+    event->key = packed >> 4;
+    event->type = packed & 0x0F;
+    event->tick += delta;
+    return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+// ===================================================================
+// Session input recording
+//
+// The app can log every input event it handles, so host tools can
+// replay real sessions (see host/replay_session.c). Events are buffered
+// and streamed out in small blocks.
+//
+// File format (little endian):
+//   header  "SFRC", u16 version, u16 grid size, f32 alpha, beta, gamma
+//           (the parameters at the start of the session)
+//   events  u8 key << 4 | type, varint ticks since the previous event
+//           (ms; the first event counts from the start of the session)
+// Key and type use the values of the firmware's InputKey / InputType.
+// ===================================================================
+#include <stdint.h>
+#include "snowflake_io.h"
+#include "snowflake_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNOWFLAKE_RECORDING_VERSION 1
+#define SNOWFLAKE_RECORDING_HEADER_SIZE 20
+#define SNOWFLAKE_RECORDING_BUFFER 64  // Bytes buffered before a write
+
+// Same values as InputKey in input/input.h
+typedef enum {
+    SNOWFLAKE_KEY_UP,
+    SNOWFLAKE_KEY_DOWN,
+    SNOWFLAKE_KEY_RIGHT,
+    SNOWFLAKE_KEY_LEFT,
+    SNOWFLAKE_KEY_OK,
+    SNOWFLAKE_KEY_BACK,
+} SnowflakeKey;
+
+// Same values as InputType in input/input.h
+typedef enum {
+    SNOWFLAKE_INPUT_PRESS,
+    SNOWFLAKE_INPUT_RELEASE,
+    SNOWFLAKE_INPUT_SHORT,
+    SNOWFLAKE_INPUT_LONG,
+    SNOWFLAKE_INPUT_REPEAT,
+} SnowflakeInputType;
+
+typedef struct {
+    uint8_t key;    // SnowflakeKey
+    uint8_t type;   // SnowflakeInputType
+    uint32_t tick;  // ms since the start of the session
+} SnowflakeRecordedEvent;
+
+typedef struct {
+    int grid_size;
+    SnowflakeParams params;
+} SnowflakeRecordingHeader;
+
+typedef struct {
+    SnowflakeWriter writer;
+    uint32_t start_tick;
+    uint32_t last_tick;
+    uint8_t buffer[SNOWFLAKE_RECORDING_BUFFER];
+    size_t used;
+    uint32_t events;
+    bool failed;  // A write came up short; later events are dropped
+} SnowflakeRecorder;
+
+/** Write the header; ticks of later events are taken relative to start_tick */
+bool snowflake_recorder_begin(
+    SnowflakeRecorder* recorder,
+    const SnowflakeWriter* writer,
+    const SnowflakeRecordingHeader* header,
+    uint32_t start_tick);
+
+/** Buffer one event, writing out the buffer when it is full */
+void snowflake_recorder_add(SnowflakeRecorder* recorder, uint8_t key, uint8_t type, uint32_t tick);
+
+/** Write out buffered events. Returns false if any write failed. */
+bool snowflake_recorder_flush(SnowflakeRecorder* recorder);
+
+/** Read and check the header */
+bool snowflake_recording_read_header(const SnowflakeReader* reader, SnowflakeRecordingHeader* header);
+
+/** Read the next event; tick must hold the previous event's tick (0 first).
+ * Returns false at the end of the recording.
+ */
+bool snowflake_recording_read_event(const SnowflakeReader* reader, SnowflakeRecordedEvent* event);
+
+#ifdef __cplusplus
+}
+#endif
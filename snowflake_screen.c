@@ -0,0 +1,75 @@
+// Includes
+#include "snowflake_screen.h"
+#include <gui/elements.h>   // GUI elements library for button hints and UI components
+#include <stdio.h>          // snprintf
+#include "mitzi_snowflake_icons.h"
+
+static const char* const tool_names[TOOL_COUNT] = {
+    [TOOL_VIEW] = "view",
+    [TOOL_GALLERY] = "gallery",
+    [TOOL_SWAP] = "swap",
+    [TOOL_DEMO] = "demo",
+    [TOOL_TRACE] = "trace",
+    [TOOL_DEBUG] = "debug",
+    [TOOL_BENCH] = "bench",
+};
+
+// ===================================================================
+// Function: Draw the main screen
+// ===================================================================
+void snowflake_screen_draw(Canvas* canvas, const SnowflakeScreen* screen) {
+    const SnowflakeParams* params = screen->params;
+    const SnowflakeModel* model = screen->frame->model;
+    
+    canvas_clear(canvas);
+    canvas_set_color(canvas, ColorBlack);
+    
+    // Draw header with icon and title
+    canvas_set_font(canvas, FontPrimary);
+    canvas_draw_icon(canvas, 1, 1, &I_icon_10x10);    
+    canvas_draw_str_aligned(canvas, 13, 1, AlignLeft, AlignTop, "Snowflake");
+    canvas_set_font(canvas, FontSecondary);
+    
+    // Draw parameter info on left side
+    char alpha_str[32];
+    snprintf(alpha_str, sizeof(alpha_str), "%s alpha:%.1f", 
+             (screen->selected_param == PARAM_ALPHA) ? ">" : " ", (double)params->alpha);
+    canvas_draw_str(canvas, 2, 18, alpha_str);
+    
+    char beta_str[32];
+    snprintf(beta_str, sizeof(beta_str), "%s beta:%.2f", 
+             (screen->selected_param == PARAM_BETA) ? ">" : " ", (double)params->beta);
+    canvas_draw_str(canvas, 2, 26, beta_str);
+    
+    char gamma_str[32];
+    snprintf(gamma_str, sizeof(gamma_str), "%s gam:%.3f", 
+             (screen->selected_param == PARAM_GAMMA) ? ">" : " ", (double)params->gamma);
+    canvas_draw_str(canvas, 2, 34, gamma_str);
+    
+    // Draw step counter, of the shown step if rewound
+    const SnowflakeFrame* frame = screen->frame;
+    bool rewound = frame->rewind_step != SNOWFLAKE_FRAME_LIVE;
+    char buffer[42];
+    snprintf(buffer, sizeof(buffer), "%sStep %d: %d frozen",
+             (screen->selected_param == PARAM_STEP) ? ">" : "",
+             rewound ? frame->rewind_step : snowflake_model_get_step(model),
+             rewound ? frame->rewind_frozen : snowflake_model_get_stats(model)->frozen_total);
+    canvas_draw_str(canvas, 2, 42, buffer);
+    
+    // Draw the tool that a short OK on the tool row runs
+    char tool_str[32];
+    snprintf(tool_str, sizeof(tool_str), "%s tool:%s",
+             (screen->selected_param == PARAM_TOOL) ? ">" : " ", tool_names[screen->selected_tool]);
+    canvas_draw_str(canvas, 2, 50, tool_str);
+    
+    // Draw the cached hex grid in one blit
+    canvas_draw_xbm(
+        canvas, SNOWFLAKE_SCREEN_GRID_X, SNOWFLAKE_SCREEN_GRID_Y, SNOWFLAKE_FRAME_WIDTH, SNOWFLAKE_FRAME_HEIGHT,
+        screen->frame->bits);
+    
+    // Draw UI hints
+    canvas_draw_icon(canvas, 1, 55, &I_back);
+    canvas_draw_str_aligned(canvas, 11, 62, AlignLeft, AlignBottom, "Hold: Exit");
+    elements_button_center(
+        canvas, screen->view_mode ? "Zoom" : (screen->selected_param == PARAM_TOOL ? "Run" : "OK"));
+}
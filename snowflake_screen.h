@@ -0,0 +1,58 @@
+#pragma once
+
+// ===================================================================
+// Main screen: parameters, step counter, the cached grid bitmap and
+// the button hints. Kept apart from the app so host tools can draw it
+// against the stub Canvas in host/stub (see host/render_bench.c).
+// ===================================================================
+#include <stdbool.h>
+#include <gui/canvas.h>
+#include "snowflake_frame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNOWFLAKE_SCREEN_GRID_X 48  // Grid bitmap on the right side of the screen
+#define SNOWFLAKE_SCREEN_GRID_Y 0
+
+// ===================================================================
+// Parameter selection
+// ===================================================================
+typedef enum {
+    PARAM_ALPHA,
+    PARAM_BETA,
+    PARAM_GAMMA,
+    PARAM_STEP,  // Step counter: Left/Right scrub back and forth through the growth
+    PARAM_TOOL,  // Tool row: Left/Right pick a tool, a short OK runs it
+    PARAM_COUNT
+} ParamType;
+
+// ===================================================================
+// Tools on the tool row. They run on the release of a short OK, so no
+// held key can start one by accident.
+// ===================================================================
+typedef enum {
+    TOOL_VIEW,     // View mode: arrows pan, OK zooms
+    TOOL_GALLERY,  // Browse the flakes cached on the SD card
+    TOOL_SWAP,     // Swap to the flake the last branch left behind
+    TOOL_DEMO,     // Record the growth and play it back in a loop
+    TOOL_TRACE,    // Write the trace ring buffer to trace.bin
+    TOOL_DEBUG,    // Cycle through the debug overlay pages
+    TOOL_BENCH,    // Benchmark screen, results also go to bench.csv
+    TOOL_COUNT
+} ToolType;
+
+typedef struct {
+    const SnowflakeParams* params;  // Shown values, may differ from the model's while a preview runs
+    ParamType selected_param;
+    ToolType selected_tool;
+    bool view_mode;
+    const SnowflakeFrame* frame;    // Grid bitmap; step and frozen count come from its model or its rewind
+} SnowflakeScreen;
+
+void snowflake_screen_draw(Canvas* canvas, const SnowflakeScreen* screen);
+
+#ifdef __cplusplus
+}
+#endif
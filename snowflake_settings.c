@@ -0,0 +1,114 @@
+// Includes
+#include "snowflake_settings.h"
+#include <furi.h>           // Furi OS core functionality
+#include <stdio.h>          // snprintf
+#include <storage/storage.h> // SD card access
+#include <flipper_format/flipper_format.h> // Key-value text files
+
+#define TAG "Snowflake"
+
+#define SETTINGS_FILETYPE "Snowflake settings"
+#define SETTINGS_VERSION 2  // 2: autotune, history, gallery and export keys
+
+// ===================================================================
+// Function: Load settings
+// Files of an older version are read as well; a file that lacks any
+// key is written back with the defaults filled in, so new keys show
+// up for editing.
+// ===================================================================
+void snowflake_settings_load(SnowflakeSettings* settings) {
+    settings->record_sessions = false;
+    settings->kernel_size = 0;
+    settings->kernel[0] = '\0';
+    settings->growth_rings = 0;
+    settings->history_kb = SNOWFLAKE_SETTINGS_HISTORY_KB;
+    settings->gallery_kb = SNOWFLAKE_SETTINGS_GALLERY_KB;
+    snprintf(settings->export_format, sizeof(settings->export_format), "%s", SNOWFLAKE_SETTINGS_EXPORT_FORMAT);
+    settings->export_scale = 1;
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* file = flipper_format_file_alloc(storage);
+    FuriString* filetype = furi_string_alloc();
+    uint32_t version = 0;
+    
+    bool exists = flipper_format_file_open_existing(file, SNOWFLAKE_SETTINGS_PATH);
+    bool valid = exists && flipper_format_read_header(file, filetype, &version) &&
+                 furi_string_equal_str(filetype, SETTINGS_FILETYPE) && version >= 1 && version <= SETTINGS_VERSION;
+    bool complete = false;
+    if(valid) {
+        // Reads only search forward from the last key; rewind before each one so a
+        // missing key does not hide the ones after it
+        complete = version == SETTINGS_VERSION;
+        flipper_format_rewind(file);
+        if(!flipper_format_read_bool(file, "Record sessions", &settings->record_sessions, 1)) complete = false;
+        
+        FuriString* kernel = furi_string_alloc();
+        flipper_format_rewind(file);
+        if(flipper_format_read_uint32(file, "Kernel size", &settings->kernel_size, 1) &&
+           flipper_format_rewind(file) && flipper_format_read_string(file, "Kernel", kernel)) {
+            snprintf(settings->kernel, sizeof(settings->kernel), "%s", furi_string_get_cstr(kernel));
+        } else {
+            settings->kernel_size = 0;
+            complete = false;
+        }
+        furi_string_free(kernel);
+        
+        flipper_format_rewind(file);
+        if(!flipper_format_read_uint32(file, "Growth rings", &settings->growth_rings, 1)) complete = false;
+        flipper_format_rewind(file);
+        if(!flipper_format_read_uint32(file, "History KB", &settings->history_kb, 1)) complete = false;
+        flipper_format_rewind(file);
+        if(!flipper_format_read_uint32(file, "Gallery KB", &settings->gallery_kb, 1)) complete = false;
+        
+        FuriString* format = furi_string_alloc();
+        flipper_format_rewind(file);
+        if(flipper_format_read_string(file, "Export format", format)) {
+            snprintf(settings->export_format, sizeof(settings->export_format), "%s", furi_string_get_cstr(format));
+        } else {
+            complete = false;
+        }
+        furi_string_free(format);
+        flipper_format_rewind(file);
+        if(!flipper_format_read_uint32(file, "Export scale", &settings->export_scale, 1)) complete = false;
+        if(!complete) FURI_LOG_I(TAG, "Adding missing keys to %s", SNOWFLAKE_SETTINGS_PATH);
+    } else if(exists) {
+        FURI_LOG_W(TAG, "Ignoring %s", SNOWFLAKE_SETTINGS_PATH);
+    }
+    
+    furi_string_free(filetype);
+    flipper_format_free(file);
+    furi_record_close(RECORD_STORAGE);
+    
+    if(!exists || (valid && !complete)) snowflake_settings_save(settings);
+}
+
+// ===================================================================
+// Function: Save settings
+// ===================================================================
+bool snowflake_settings_save(const SnowflakeSettings* settings) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* file = flipper_format_file_alloc(storage);
+    
+    bool ok = flipper_format_file_open_always(file, SNOWFLAKE_SETTINGS_PATH) &&
+              flipper_format_write_header_cstr(file, SETTINGS_FILETYPE, SETTINGS_VERSION) &&
+              flipper_format_write_comment_cstr(file, "Write every input event to session.rec") &&
+              flipper_format_write_bool(file, "Record sessions", &settings->record_sessions, 1) &&
+              flipper_format_write_comment_cstr(file, "Fastest step kernel, picked at startup for this size") &&
+              flipper_format_write_uint32(file, "Kernel size", &settings->kernel_size, 1) &&
+              flipper_format_write_string_cstr(file, "Kernel", settings->kernel) &&
+              flipper_format_write_comment_cstr(file, "Steps per dithered growth ring, 0 = off") &&
+              flipper_format_write_uint32(file, "Growth rings", &settings->growth_rings, 1) &&
+              flipper_format_write_comment_cstr(file, "RAM for going back to an earlier step, 0 = off") &&
+              flipper_format_write_uint32(file, "History KB", &settings->history_kb, 1) &&
+              flipper_format_write_comment_cstr(file, "SD space for flakes grown before, 0 = off") &&
+              flipper_format_write_uint32(file, "Gallery KB", &settings->gallery_kb, 1) &&
+              flipper_format_write_comment_cstr(file, "Saved by long OK in view mode: pbm, bmp, png image, pgm, raw s field or gif growth") &&
+              flipper_format_write_string_cstr(file, "Export format", settings->export_format) &&
+              flipper_format_write_comment_cstr(file, "Image pixels per screen pixel") &&
+              flipper_format_write_uint32(file, "Export scale", &settings->export_scale, 1);
+    if(!ok) FURI_LOG_E(TAG, "Failed to write %s", SNOWFLAKE_SETTINGS_PATH);
+    
+    flipper_format_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return ok;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// ===================================================================
+// App settings, kept as a FlipperFormat text file on the SD card so
+// they can also be edited from qFlipper
+// ===================================================================
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SNOWFLAKE_SETTINGS_PATH APP_DATA_PATH("settings.txt")
+#define SNOWFLAKE_SETTINGS_HISTORY_KB 16
+#define SNOWFLAKE_SETTINGS_GALLERY_KB 64
+#define SNOWFLAKE_SETTINGS_EXPORT_FORMAT "png"
+
+typedef struct {
+    bool record_sessions;  // Log all input events of a session to session.rec
+    uint32_t kernel_size;  // Lattice size the kernel was autotuned for, 0 = not tuned
+    char kernel[16];       // Name of the fastest step kernel (snowflake_kernels.h)
+    uint32_t growth_rings; // Steps per shaded growth ring, 0 = off
+    uint32_t history_kb;   // RAM for undo keyframes, 0 = no undo
+    uint32_t gallery_kb;   // SD space for cached flakes, 0 = no gallery
+    char export_format[4]; // pbm, bmp, png image, pgm, raw s field or gif growth (snowflake_export.h)
+    uint32_t export_scale; // Image pixels per screen pixel of exports
+} SnowflakeSettings;
+
+/** Load the settings, falling back to defaults for missing values.
+ * A missing file is created with the defaults.
+ */
+void snowflake_settings_load(SnowflakeSettings* settings);
+
+bool snowflake_settings_save(const SnowflakeSettings* settings);
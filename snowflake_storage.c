@@ -0,0 +1,129 @@
+// Includes
+#include "snowflake_storage.h"
+#include <furi.h>           // Furi OS core functionality
+#include <stdlib.h>         // malloc, free
+
+#define TAG "Snowflake"
+
+struct SnowflakeStorageFile {
+    Storage* storage;
+    File* file;
+};
+
+// ===================================================================
+// Function: Open a file in the app data folder
+// ===================================================================
+SnowflakeStorageFile* snowflake_storage_open(const char* path, bool write) {
+    SnowflakeStorageFile* file = malloc(sizeof(SnowflakeStorageFile));
+    file->storage = furi_record_open(RECORD_STORAGE);
+    file->file = storage_file_alloc(file->storage);
+    
+    bool ok = write ? storage_file_open(file->file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS) :
+                      storage_file_open(file->file, path, FSAM_READ, FSOM_OPEN_EXISTING);
+    if(!ok) {
+        if(write) FURI_LOG_E(TAG, "Failed to open %s", path);
+        snowflake_storage_close(file);
+        return NULL;
+    }
+    return file;
+}
+
+// ===================================================================
+// Function: Create a scratch file for reads and writes anywhere in it
+// ===================================================================
+SnowflakeStorageFile* snowflake_storage_open_scratch(const char* path) {
+    SnowflakeStorageFile* file = malloc(sizeof(SnowflakeStorageFile));
+    file->storage = furi_record_open(RECORD_STORAGE);
+    file->file = storage_file_alloc(file->storage);
+    
+    if(!storage_file_open(file->file, path, FSAM_READ_WRITE, FSOM_CREATE_ALWAYS)) {
+        FURI_LOG_E(TAG, "Failed to open %s", path);
+        snowflake_storage_close(file);
+        return NULL;
+    }
+    return file;
+}
+
+// ===================================================================
+// Function: Close a file and release the storage record
+// ===================================================================
+void snowflake_storage_close(SnowflakeStorageFile* file) {
+    if(!file) return;
+    storage_file_close(file->file);
+    storage_file_free(file->file);
+    furi_record_close(RECORD_STORAGE);
+    free(file);
+}
+
+// ===================================================================
+// Function: SnowflakeWriter / SnowflakeReader over a Storage File
+// ===================================================================
+static size_t storage_writer_write(void* context, const void* data, size_t size) {
+    return storage_file_write((File*)context, data, size);
+}
+
+static size_t storage_reader_read(void* context, void* data, size_t size) {
+    return storage_file_read((File*)context, data, size);
+}
+
+SnowflakeWriter snowflake_storage_writer(SnowflakeStorageFile* file) {
+    SnowflakeWriter writer = {.write = storage_writer_write, .context = file->file};
+    return writer;
+}
+
+SnowflakeReader snowflake_storage_reader(SnowflakeStorageFile* file) {
+    SnowflakeReader reader = {.read = storage_reader_read, .context = file->file};
+    return reader;
+}
+
+// ===================================================================
+// Function: SnowflakeBlockFile over a Storage File
+// Seeking past the end of a file opened for writing extends it.
+// ===================================================================
+static bool storage_block_read(void* context, uint64_t offset, void* data, size_t size) {
+    File* file = context;
+    return offset <= UINT32_MAX && storage_file_seek(file, (uint32_t)offset, true) &&
+           storage_file_read(file, data, size) == size;
+}
+
+static bool storage_block_write(void* context, uint64_t offset, const void* data, size_t size) {
+    File* file = context;
+    return offset <= UINT32_MAX && storage_file_seek(file, (uint32_t)offset, true) &&
+           storage_file_write(file, data, size) == size;
+}
+
+SnowflakeBlockFile snowflake_storage_block(SnowflakeStorageFile* file) {
+    SnowflakeBlockFile block = {.read = storage_block_read, .write = storage_block_write, .context = file->file};
+    return block;
+}
+
+// ===================================================================
+// Function: Create or replace a file and fill it
+// ===================================================================
+bool snowflake_storage_write_file(const char* path, SnowflakeStorageWriteCallback callback, void* context) {
+    SnowflakeStorageFile* file = snowflake_storage_open(path, true);
+    if(!file) return false;
+    
+    SnowflakeWriter writer = snowflake_storage_writer(file);
+    bool ok = callback(&writer, context);
+    if(!ok) FURI_LOG_E(TAG, "Failed to write %s", path);
+    
+    snowflake_storage_close(file);
+    return ok;
+}
+
+// ===================================================================
+// Function: Delete a file / create a folder
+// ===================================================================
+void snowflake_storage_remove(const char* path) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_common_remove(storage, path);
+    furi_record_close(RECORD_STORAGE);
+}
+
+bool snowflake_storage_mkdir(const char* path) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    bool ok = storage_simply_mkdir(storage, path);
+    furi_record_close(RECORD_STORAGE);
+    return ok;
+}
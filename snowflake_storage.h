@@ -0,0 +1,46 @@
+#pragma once
+
+// ===================================================================
+// SD card access for the app (device only)
+// Files live in the app data folder, /ext/apps_data/mitzi_snowflake.
+// ===================================================================
+#include <stdbool.h>
+#include <storage/storage.h> // APP_DATA_PATH
+#include "snowflake_io.h"
+
+typedef struct SnowflakeStorageFile SnowflakeStorageFile;
+
+/** Fills a file through the writer; return false to report a failure */
+typedef bool (*SnowflakeStorageWriteCallback)(const SnowflakeWriter* writer, void* context);
+
+/** Open a file for reading, or create / replace it for writing.
+ * Returns NULL if the file cannot be opened.
+ */
+SnowflakeStorageFile* snowflake_storage_open(const char* path, bool write);
+
+void snowflake_storage_close(SnowflakeStorageFile* file);
+
+/** Create or replace a scratch file to read and write at any offset,
+ * such as the tiles of an out-of-core lattice. Returns NULL if the file
+ * cannot be created.
+ */
+SnowflakeStorageFile* snowflake_storage_open_scratch(const char* path);
+
+/** Byte sink / source over an open file */
+SnowflakeWriter snowflake_storage_writer(SnowflakeStorageFile* file);
+
+SnowflakeReader snowflake_storage_reader(SnowflakeStorageFile* file);
+
+/** Block access over an open file; offsets past 4 GB, which FAT cannot
+ * hold, fail
+ */
+SnowflakeBlockFile snowflake_storage_block(SnowflakeStorageFile* file);
+
+/** Create or replace the file at path and fill it through the callback */
+bool snowflake_storage_write_file(const char* path, SnowflakeStorageWriteCallback callback, void* context);
+
+/** Delete a file; a missing one is not an error */
+void snowflake_storage_remove(const char* path);
+
+/** Create a folder unless it exists */
+bool snowflake_storage_mkdir(const char* path);
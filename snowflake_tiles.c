@@ -0,0 +1,256 @@
+// Includes
+#include "snowflake_tiles.h"
+#include "snowflake_model_i.h"
+#include <stdlib.h>         // malloc, free
+#include <string.h>         // memcpy, memcmp, memset
+
+#define TILE_CELLS (SNOWFLAKE_TILE * SNOWFLAKE_TILE)
+
+// s and the age map are tiled separately: where the vapor still moves
+// but nothing freezes, the age tiles stay shared
+typedef enum {
+    PLANE_S,    // float per cell
+    PLANE_AGE,  // uint16_t freeze step per cell
+    PLANE_COUNT
+} TilePlane;
+
+static const size_t plane_bytes[PLANE_COUNT] = {
+    TILE_CELLS * sizeof(float),
+    TILE_CELLS * sizeof(uint16_t),
+};
+
+// Cells past the lattice edge in the last tile row / column stay zero
+typedef struct {
+    uint32_t refs;  // Tile slots pointing here, across all forks and planes
+    uint8_t data[]; // plane_bytes of the plane
+} SnowflakeTile;
+
+struct SnowflakeTiles {
+    int size;
+    int tiles_x;  // Tiles per row and column
+    int step;
+    SnowflakeParams params;
+    SnowflakeStats stats;
+    SnowflakeTile** tiles[PLANE_COUNT];  // Row-major
+};
+
+// One tile of both planes, gathered from the model
+typedef struct {
+    float s[TILE_CELLS];
+    uint16_t freeze_step[TILE_CELLS];
+} TileScratch;
+
+// ===================================================================
+// Function: Allocate a state with no tiles yet
+// ===================================================================
+static SnowflakeTiles* tiles_alloc(int size) {
+    SnowflakeTiles* tiles = malloc(sizeof(SnowflakeTiles));
+    if(!tiles) return NULL;
+    
+    tiles->size = size;
+    tiles->tiles_x = (size + SNOWFLAKE_TILE - 1) / SNOWFLAKE_TILE;
+    size_t count = (size_t)tiles->tiles_x * tiles->tiles_x;
+    tiles->tiles[PLANE_S] = calloc(count * PLANE_COUNT, sizeof(SnowflakeTile*));
+    if(!tiles->tiles[PLANE_S]) {
+        free(tiles);
+        return NULL;
+    }
+    for(int plane = 1; plane < PLANE_COUNT; plane++) tiles->tiles[plane] = tiles->tiles[PLANE_S] + plane * count;
+    return tiles;
+}
+
+static void tile_release(SnowflakeTile* tile) {
+    if(tile && --tile->refs == 0) free(tile);
+}
+
+// ===================================================================
+// Function: Copy one tile of the model into the scratch planes
+// ===================================================================
+static void tile_gather(TileScratch* scratch, const SnowflakeModel* model, int tx, int ty) {
+    int size = model->size;
+    int x0 = tx * SNOWFLAKE_TILE, y0 = ty * SNOWFLAKE_TILE;
+    int width = size - x0 < SNOWFLAKE_TILE ? size - x0 : SNOWFLAKE_TILE;
+    int height = size - y0 < SNOWFLAKE_TILE ? size - y0 : SNOWFLAKE_TILE;
+    
+    memset(scratch, 0, sizeof(TileScratch));
+    for(int y = 0; y < height; y++) {
+        int idx = (y0 + y) * size + x0;
+        for(int x = 0; x < width; x++, idx++) {
+            int cell = y * SNOWFLAKE_TILE + x;
+            scratch->s[cell] = model->frozen[idx] ? 1.0f : model->s[idx];
+            scratch->freeze_step[cell] = model->freeze_step[idx];
+        }
+    }
+}
+
+// ===================================================================
+// Function: Check whether all values of a plane's tile are the same
+// ===================================================================
+static bool tile_uniform(const uint8_t* data, size_t bytes, size_t value_size) {
+    for(size_t offset = value_size; offset < bytes; offset += value_size) {
+        if(memcmp(data + offset, data, value_size) != 0) return false;
+    }
+    return true;
+}
+
+// ===================================================================
+// Function: Store one tile of a plane, copy-on-write
+// A uniform tile equal to the last uniform one of the pass (e.g. the
+// vapor at beta) shares it. Returns false if out of memory.
+// ===================================================================
+static bool tile_store(SnowflakeTile** slot, SnowflakeTile** uniform, TilePlane plane, const void* data) {
+    size_t bytes = plane_bytes[plane];
+    size_t value_size = plane == PLANE_S ? sizeof(float) : sizeof(uint16_t);
+    bool is_uniform = tile_uniform(data, bytes, value_size);
+    
+    if(*slot && memcmp((*slot)->data, data, bytes) == 0) {
+        if(is_uniform) *uniform = *slot;
+        return true;
+    }
+    
+    if(is_uniform && *uniform && memcmp((*uniform)->data, data, bytes) == 0) {
+        tile_release(*slot);
+        (*uniform)->refs++;
+        *slot = *uniform;
+        return true;
+    }
+    
+    // Written in place only if no one else sees this tile
+    if(!*slot || (*slot)->refs > 1) {
+        SnowflakeTile* tile = malloc(sizeof(SnowflakeTile) + bytes);
+        if(!tile) return false;
+        tile_release(*slot);
+        tile->refs = 1;
+        *slot = tile;
+    }
+    memcpy((*slot)->data, data, bytes);
+    if(is_uniform) *uniform = *slot;
+    return true;
+}
+
+// ===================================================================
+// Function: Capture / fork / free
+// ===================================================================
+SnowflakeTiles* snowflake_tiles_alloc(const SnowflakeModel* model) {
+    SnowflakeTiles* tiles = tiles_alloc(model->size);
+    if(!tiles) return NULL;
+    
+    if(!snowflake_tiles_store(tiles, model)) {
+        snowflake_tiles_free(tiles);
+        return NULL;
+    }
+    return tiles;
+}
+
+SnowflakeTiles* snowflake_tiles_fork(const SnowflakeTiles* tiles) {
+    SnowflakeTiles* fork = tiles_alloc(tiles->size);
+    if(!fork) return NULL;
+    
+    fork->step = tiles->step;
+    fork->params = tiles->params;
+    fork->stats = tiles->stats;
+    int count = tiles->tiles_x * tiles->tiles_x;
+    for(int plane = 0; plane < PLANE_COUNT; plane++) {
+        for(int t = 0; t < count; t++) {
+            fork->tiles[plane][t] = tiles->tiles[plane][t];
+            fork->tiles[plane][t]->refs++;
+        }
+    }
+    return fork;
+}
+
+void snowflake_tiles_free(SnowflakeTiles* tiles) {
+    if(!tiles) return;
+    int count = tiles->tiles_x * tiles->tiles_x;
+    for(int plane = 0; plane < PLANE_COUNT; plane++) {
+        for(int t = 0; t < count; t++) tile_release(tiles->tiles[plane][t]);
+    }
+    free(tiles->tiles[PLANE_S]);
+    free(tiles);
+}
+
+// ===================================================================
+// Function: Store the model's state, copy-on-write per tile
+// ===================================================================
+bool snowflake_tiles_store(SnowflakeTiles* tiles, const SnowflakeModel* model) {
+    TileScratch scratch;
+    SnowflakeTile* uniform[PLANE_COUNT] = {NULL};
+    
+    for(int ty = 0; ty < tiles->tiles_x; ty++) {
+        for(int tx = 0; tx < tiles->tiles_x; tx++) {
+            int t = ty * tiles->tiles_x + tx;
+            tile_gather(&scratch, model, tx, ty);
+            if(!tile_store(&tiles->tiles[PLANE_S][t], &uniform[PLANE_S], PLANE_S, scratch.s)) return false;
+            if(!tile_store(&tiles->tiles[PLANE_AGE][t], &uniform[PLANE_AGE], PLANE_AGE, scratch.freeze_step)) {
+                return false;
+            }
+        }
+    }
+    
+    tiles->step = model->step;
+    tiles->params = model->params;
+    tiles->stats = model->stats;
+    return true;
+}
+
+// ===================================================================
+// Function: Load the state into a model
+// ===================================================================
+void snowflake_tiles_load(const SnowflakeTiles* tiles, SnowflakeModel* model) {
+    int size = model->size;
+    for(int ty = 0; ty < tiles->tiles_x; ty++) {
+        for(int tx = 0; tx < tiles->tiles_x; tx++) {
+            int t = ty * tiles->tiles_x + tx;
+            const float* s = (const float*)tiles->tiles[PLANE_S][t]->data;
+            const uint16_t* freeze_step = (const uint16_t*)tiles->tiles[PLANE_AGE][t]->data;
+            int x0 = tx * SNOWFLAKE_TILE, y0 = ty * SNOWFLAKE_TILE;
+            int width = size - x0 < SNOWFLAKE_TILE ? size - x0 : SNOWFLAKE_TILE;
+            int height = size - y0 < SNOWFLAKE_TILE ? size - y0 : SNOWFLAKE_TILE;
+            
+            for(int y = 0; y < height; y++) {
+                int idx = (y0 + y) * size + x0;
+                int cell = y * SNOWFLAKE_TILE;
+                memcpy(&model->s[idx], &s[cell], (size_t)width * sizeof(float));
+                memcpy(&model->freeze_step[idx], &freeze_step[cell], (size_t)width * sizeof(uint16_t));
+                for(int x = 0; x < width; x++) {
+                    model->frozen[idx + x] = freeze_step[cell + x] != SNOWFLAKE_NOT_FROZEN;
+                    model->u[idx + x] = 0.0f;
+                }
+            }
+        }
+    }
+    
+    model->step = tiles->step;
+    model->params = tiles->params;
+    model->stats = tiles->stats;
+}
+
+// ===================================================================
+// Getters
+// ===================================================================
+int snowflake_tiles_get_step(const SnowflakeTiles* tiles) {
+    return tiles->step;
+}
+
+const SnowflakeParams* snowflake_tiles_get_params(const SnowflakeTiles* tiles) {
+    return &tiles->params;
+}
+
+void snowflake_tiles_get_usage(const SnowflakeTiles* tiles, SnowflakeTilesUsage* usage) {
+    int count = tiles->tiles_x * tiles->tiles_x;
+    size_t own = sizeof(SnowflakeTiles) + (size_t)count * PLANE_COUNT * sizeof(SnowflakeTile*);
+    
+    usage->tiles = count * PLANE_COUNT;
+    usage->shared = 0;
+    usage->bytes = own;
+    usage->unshared = own;
+    for(int plane = 0; plane < PLANE_COUNT; plane++) {
+        size_t bytes = sizeof(SnowflakeTile) + plane_bytes[plane];
+        usage->unshared += (size_t)count * bytes;
+        for(int t = 0; t < count; t++) {
+            const SnowflakeTile* tile = tiles->tiles[plane][t];
+            if(tile->refs > 1) usage->shared++;
+            usage->bytes += bytes / tile->refs;
+        }
+    }
+}
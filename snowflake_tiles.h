@@ -0,0 +1,72 @@
+#pragma once
+
+// ===================================================================
+// Copy-on-write tiled state: cheap forks of a flake for what-if runs
+//
+// A SnowflakeTiles holds the state the next step depends on (s, the
+// age map, step, parameters and statistics) as reference-counted tiles
+// of SNOWFLAKE_TILE x SNOWFLAKE_TILE cells. Forking copies the tile
+// pointers only; storing a model back writes just the tiles whose
+// cells changed, and duplicates a tile first if another fork still
+// shares it. Several parameter branches grown from one state thus
+// share the background and the crystal core they have in common, and
+// need only one working model between them.
+//
+// The model keeps its flat arrays, which the kernels address by fixed
+// neighbour offsets; tiles are only touched by store and load. Like
+// the undo history, s of frozen cells is not kept (it never feeds back
+// into growth), and the frozen mask follows from the age map. Tiles of
+// uniform liquid cells, e.g. the untouched vapor at beta, are shared
+// within a state as well.
+// ===================================================================
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "snowflake_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNOWFLAKE_TILE 8  // Tile edge in cells
+
+typedef struct SnowflakeTiles SnowflakeTiles;
+
+typedef struct {
+    int tiles;       // Tiles covering the lattice
+    int shared;      // Tiles also used by another fork or another place in this one
+    size_t bytes;    // This fork's share: every tile divided by its users, so forks add up
+    size_t unshared; // What the same state takes without sharing
+} SnowflakeTilesUsage;
+
+/** Capture the model's state. Returns NULL if out of memory. */
+SnowflakeTiles* snowflake_tiles_alloc(const SnowflakeModel* model);
+
+/** A second handle on the same state, sharing all tiles. O(tiles).
+ * Returns NULL if out of memory.
+ */
+SnowflakeTiles* snowflake_tiles_fork(const SnowflakeTiles* tiles);
+
+void snowflake_tiles_free(SnowflakeTiles* tiles);
+
+/** Replace the state with the model's, copying only the tiles that
+ * changed; other forks keep theirs. The model must have the lattice
+ * size the state was captured with. Returns false if out of memory,
+ * with the state half updated: store again or free it.
+ */
+bool snowflake_tiles_store(SnowflakeTiles* tiles, const SnowflakeModel* model);
+
+/** Load the state into a model of the same size. The model's frame,
+ * if any, must be reset afterwards.
+ */
+void snowflake_tiles_load(const SnowflakeTiles* tiles, SnowflakeModel* model);
+
+int snowflake_tiles_get_step(const SnowflakeTiles* tiles);
+
+const SnowflakeParams* snowflake_tiles_get_params(const SnowflakeTiles* tiles);
+
+void snowflake_tiles_get_usage(const SnowflakeTiles* tiles, SnowflakeTilesUsage* usage);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,108 @@
+// Includes
+#include "snowflake_trace.h"
+#include "snowflake_profile.h"
+#include <string.h>         // memset, memcpy
+
+#define TRACE_WRITE_BATCH 8 // Records encoded per write call
+
+// ===================================================================
+// Function: Drop all records
+// ===================================================================
+void snowflake_trace_reset(SnowflakeTrace* trace) {
+    memset(trace, 0, sizeof(SnowflakeTrace));
+}
+
+// ===================================================================
+// Function: Add a record, reserving its slot atomically
+// ===================================================================
+void snowflake_trace_add(SnowflakeTrace* trace, const SnowflakeTraceRecord* record) {
+    uint32_t slot = __atomic_fetch_add(&trace->written, 1, __ATOMIC_RELAXED);
+    trace->records[slot % SNOWFLAKE_TRACE_CAPACITY] = *record;
+}
+
+void snowflake_trace_step(
+    SnowflakeTrace* trace,
+    SnowflakeTraceSource source,
+    const SnowflakeModel* model,
+    int frozen_count,
+    uint32_t ticks) {
+    SnowflakeTraceRecord record = {
+        .type = SNOWFLAKE_TRACE_STEP,
+        .source = source,
+        .count = frozen_count > UINT16_MAX ? UINT16_MAX : (uint16_t)frozen_count,
+        .step = (uint32_t)snowflake_model_get_step(model),
+        .time = snowflake_profile_now(),
+        .value = {(uint32_t)snowflake_model_get_stats(model)->frozen_total, ticks, 0},
+    };
+    snowflake_trace_add(trace, &record);
+}
+
+void snowflake_trace_params(
+    SnowflakeTrace* trace,
+    SnowflakeTraceType type,
+    SnowflakeTraceSource source,
+    const SnowflakeModel* model,
+    const SnowflakeParams* params) {
+    SnowflakeTraceRecord record = {
+        .type = type,
+        .source = source,
+        .step = (uint32_t)snowflake_model_get_step(model),
+        .time = snowflake_profile_now(),
+    };
+    memcpy(&record.value[0], &params->alpha, sizeof(uint32_t));
+    memcpy(&record.value[1], &params->beta, sizeof(uint32_t));
+    memcpy(&record.value[2], &params->gamma, sizeof(uint32_t));
+    snowflake_trace_add(trace, &record);
+}
+
+uint32_t snowflake_trace_count(const SnowflakeTrace* trace) {
+    return trace->written < SNOWFLAKE_TRACE_CAPACITY ? trace->written : SNOWFLAKE_TRACE_CAPACITY;
+}
+
+// ===================================================================
+// Function: Encode a record little endian
+// ===================================================================
+static void trace_encode(uint8_t* dst, const SnowflakeTraceRecord* record) {
+    dst[0] = record->type;
+    dst[1] = record->source;
+    snowflake_put_u16(dst + 2, record->count);
+    snowflake_put_u32(dst + 4, record->step);
+    snowflake_put_u32(dst + 8, record->time);
+    for(int i = 0; i < 3; i++) snowflake_put_u32(dst + 12 + 4 * i, record->value[i]);
+}
+
+void snowflake_trace_decode(const uint8_t* data, SnowflakeTraceRecord* record) {
+    record->type = data[0];
+    record->source = data[1];
+    record->count = snowflake_get_u16(data + 2);
+    record->step = snowflake_get_u32(data + 4);
+    record->time = snowflake_get_u32(data + 8);
+    for(int i = 0; i < 3; i++) record->value[i] = snowflake_get_u32(data + 12 + 4 * i);
+}
+
+// ===================================================================
+// Function: Write the trace, oldest record first, in small batches
+// ===================================================================
+bool snowflake_trace_write(const SnowflakeTrace* trace, const SnowflakeWriter* writer, uint32_t ticks_per_us) {
+    uint32_t written = trace->written;
+    uint32_t count = written < SNOWFLAKE_TRACE_CAPACITY ? written : SNOWFLAKE_TRACE_CAPACITY;
+    
+    uint8_t header[SNOWFLAKE_TRACE_HEADER_SIZE];
+    memcpy(header, "SFTR", 4);
+    snowflake_put_u16(header + 4, SNOWFLAKE_TRACE_VERSION);
+    snowflake_put_u16(header + 6, SNOWFLAKE_TRACE_RECORD_SIZE);
+    snowflake_put_u32(header + 8, ticks_per_us);
+    snowflake_put_u32(header + 12, count);
+    if(!snowflake_write(writer, header, sizeof(header))) return false;
+    
+    uint8_t batch[TRACE_WRITE_BATCH * SNOWFLAKE_TRACE_RECORD_SIZE];
+    for(uint32_t i = 0; i < count; i += TRACE_WRITE_BATCH) {
+        uint32_t n = count - i < TRACE_WRITE_BATCH ? count - i : TRACE_WRITE_BATCH;
+        for(uint32_t j = 0; j < n; j++) {
+            uint32_t index = (written - count + i + j) % SNOWFLAKE_TRACE_CAPACITY;
+            trace_encode(batch + j * SNOWFLAKE_TRACE_RECORD_SIZE, &trace->records[index]);
+        }
+        if(!snowflake_write(writer, batch, n * SNOWFLAKE_TRACE_RECORD_SIZE)) return false;
+    }
+    return true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+// ===================================================================
+// Binary trace ring buffer
+//
+// Fixed-size records instead of formatted log lines: adding one is a
+// handful of stores, so the step can trace every iteration. The ring
+// keeps the last SNOWFLAKE_TRACE_CAPACITY records and is only written
+// out on demand.
+//
+// File format (little endian):
+//   header  "SFTR", u16 version, u16 record size, u32 ticks per us,
+//           u32 record count
+//   records oldest first, SNOWFLAKE_TRACE_RECORD_SIZE bytes each:
+//           u8 type, u8 source, u16 count, u32 step, u32 time,
+//           u32 value[3]
+// ===================================================================
+#include <stdint.h>
+#include "snowflake_io.h"
+#include "snowflake_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNOWFLAKE_TRACE_CAPACITY 128       // Records kept, oldest overwritten first
+#define SNOWFLAKE_TRACE_VERSION 1
+#define SNOWFLAKE_TRACE_HEADER_SIZE 16
+#define SNOWFLAKE_TRACE_RECORD_SIZE 24
+
+typedef enum {
+    SNOWFLAKE_TRACE_STEP = 1,  // count: cells frozen, value: frozen total, step ticks, -
+    SNOWFLAKE_TRACE_RESET,     // value: alpha, beta, gamma (float bits)
+    SNOWFLAKE_TRACE_PARAMS,    // value: alpha, beta, gamma (float bits)
+} SnowflakeTraceType;
+
+typedef enum {
+    SNOWFLAKE_TRACE_MANUAL,   // Main loop
+    SNOWFLAKE_TRACE_PREVIEW,  // Background preview worker
+} SnowflakeTraceSource;
+
+typedef struct {
+    uint8_t type;
+    uint8_t source;
+    uint16_t count;
+    uint32_t step;
+    uint32_t time;      // snowflake_profile_now() ticks
+    uint32_t value[3];
+} SnowflakeTraceRecord;
+
+typedef struct {
+    SnowflakeTraceRecord records[SNOWFLAKE_TRACE_CAPACITY];
+    uint32_t written;  // Records ever added; the ring index is written % capacity
+} SnowflakeTrace;
+
+void snowflake_trace_reset(SnowflakeTrace* trace);
+
+/** Add a record. Safe to call from several threads; a record being
+ * overwritten while the trace is written out may come out torn.
+ */
+void snowflake_trace_add(SnowflakeTrace* trace, const SnowflakeTraceRecord* record);
+
+/** Add a STEP record */
+void snowflake_trace_step(
+    SnowflakeTrace* trace,
+    SnowflakeTraceSource source,
+    const SnowflakeModel* model,
+    int frozen_count,
+    uint32_t ticks);
+
+/** Add a RESET or PARAMS record */
+void snowflake_trace_params(
+    SnowflakeTrace* trace,
+    SnowflakeTraceType type,
+    SnowflakeTraceSource source,
+    const SnowflakeModel* model,
+    const SnowflakeParams* params);
+
+/** Number of records currently held */
+uint32_t snowflake_trace_count(const SnowflakeTrace* trace);
+
+/** Write header and records, oldest first. Returns false on a short write. */
+bool snowflake_trace_write(const SnowflakeTrace* trace, const SnowflakeWriter* writer, uint32_t ticks_per_us);
+
+/** Decode one record from SNOWFLAKE_TRACE_RECORD_SIZE bytes */
+void snowflake_trace_decode(const uint8_t* data, SnowflakeTraceRecord* record);
+
+#ifdef __cplusplus
+}
+#endif